@@ -15,6 +15,7 @@
 #include "configs/configdialog.h"
 #include "core/richtext/richdocument.h"
 #include "core/subtitleiterator.h"
+#include "core/undo/editjournal.h"
 #include "core/undo/undostack.h"
 #include "gui/currentlinewidget.h"
 #include "gui/subtitlemeta/subtitlemetawidget.h"
@@ -143,6 +144,7 @@ Application::Application(int &argc, char **argv) :
 	m_speechProcessor(nullptr),
 	m_lastFoundLine(nullptr),
 	m_lastSubtitleUrl(QDir::homePath()),
+	m_editJournal(nullptr),
 	m_lastVideoUrl(QDir::homePath()),
 	m_linkCurrentLineToPosition(false)
 {
@@ -191,6 +193,9 @@ Application::createMainWindow()
 
 	AppGlobal::undoStack = new UndoStack(m_mainWindow);
 
+	m_editJournal = new EditJournal(this);
+	appUndoStack()->setJournal(m_editJournal);
+
 	UserActionManager *actionManager = UserActionManager::instance();
 	actionManager->setLinesWidget(m_mainWindow->m_linesWidget);
 	actionManager->setFullScreenMode(false);
@@ -56,6 +56,7 @@ class ErrorTracker;
 class ScriptsManager;
 
 class UndoStack;
+class EditJournal;
 
 class Application : public QApplication
 {
@@ -93,6 +94,12 @@ public:
 	static const QString & buildSubtitleFilesFilter(bool openFileFilter = true);
 	static const QString & buildMediaFilesFilter();
 
+	/**
+	 * @brief Offers to recover sessions of instances that did not exit properly
+	 * @return true if a session was recovered and opened
+	 */
+	bool recoverSession();
+
 public slots:
 	void newSubtitle();
 	void openSubtitle();
@@ -205,6 +212,7 @@ signals:
 private:
 	void processSubtitleOpened(QTextCodec *codec, const QString &subtitleFormat);
 	void processTranslationOpened(QTextCodec *codec, const QString &subtitleFormat);
+	void updateSessionInfo();
 
 	QTextCodec * codecForEncoding(const QString &encoding);
 
@@ -279,6 +287,8 @@ private:
 
 	ErrorTracker *m_errorTracker;
 
+	EditJournal *m_editJournal;
+
 	QLabel *m_labSubFormat = nullptr;
 	QLabel *m_labSubEncoding = nullptr;
 
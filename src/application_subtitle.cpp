@@ -10,6 +10,7 @@
 #include "actions/kcodecactionext.h"
 #include "actions/krecentfilesactionext.h"
 #include "actions/useractionnames.h"
+#include "core/undo/editjournal.h"
 #include "core/undo/undostack.h"
 #include "dialogs/joinsubtitlesdialog.h"
 #include "dialogs/splitsubtitledialog.h"
@@ -68,7 +69,8 @@ Application::buildSubtitleFilesFilter(bool openFileFilter)
 				extensions += $(" *.") % ext;
 			const QString formatLine = format->dialogFilter() % QChar::LineFeed;
 			filterOpen += formatLine;
-			if(format->isBinary()) {
+			// binary formats that can't be written are image subtitles
+			if(format->isBinary() && !FormatManager::instance().hasOutput(fmt)) {
 				imageExtensions += extensions;
 			} else {
 				textExtensions += extensions;
@@ -269,6 +271,15 @@ Application::processSubtitleOpened(QTextCodec *codec, const QString &subtitleFor
 
 	m_labSubFormat->setText(i18n("Format: %1", m_subtitleFormat));
 	m_labSubEncoding->setText(i18n("Encoding: %1", m_subtitleEncoding));
+
+	m_editJournal->open(EditJournal::newSessionPath(), appSubtitle());
+	updateSessionInfo();
+}
+
+void
+Application::updateSessionInfo()
+{
+	m_editJournal->setInfo(EditJournal::Info{m_subtitleUrl, m_subtitleFormat, m_translationMode, m_subtitleTrUrl, m_subtitleTrFormat});
 }
 
 void
@@ -318,6 +329,7 @@ Application::saveSubtitle(QTextCodec *codec)
 		m_labSubEncoding->setText(i18n("Encoding: %1", m_subtitleEncoding));
 
 		updateTitle();
+		updateSessionInfo();
 
 		return true;
 	} else {
@@ -360,6 +372,7 @@ Application::saveSubtitleAs(QTextCodec *codec)
 
 #if KWIDGETSADDONS_VERSION < QT_VERSION_CHECK(5, 100, 0)
 #define warningTwoActionsCancel warningYesNoCancel
+#define questionTwoActions questionYesNo
 #define PrimaryAction Yes
 #endif
 
@@ -401,6 +414,8 @@ Application::closeSubtitle()
 
 		emit subtitleClosed();
 
+		m_editJournal->close();
+
 		appUndoStack()->clear();
 
 		AppGlobal::subtitle.reset();
@@ -424,6 +439,71 @@ Application::closeSubtitle()
 	return true;
 }
 
+bool
+Application::recoverSession()
+{
+	auto sessionCodec = [this](const QUrl &url){
+		if(url.isEmpty())
+			return static_cast<QTextCodec *>(nullptr);
+		QTextCodec *codec = codecForEncoding(KRecentFilesActionExt::encodingForUrl(url));
+		return codec ? codec : QTextCodec::codecForName(SCConfig::defaultSubtitlesEncoding().toUtf8());
+	};
+
+	bool recovered = false;
+	const QStringList sessions = EditJournal::orphanedSessions();
+	for(const QString &session : sessions) {
+		// session of a subtitle that had nothing to save
+		if(!EditJournal::hasChanges(session)) {
+			EditJournal::removeSession(session);
+			continue;
+		}
+
+		if(KMessageBox::questionTwoActions(m_mainWindow,
+					i18n("Subtitle Composer did not exit properly and there are unsaved changes.\nDo you want to recover them?"),
+					i18n("Recover Session"),
+					KGuiItem(i18n("Recover")), KStandardGuiItem::discard()) != KMessageBox::PrimaryAction) {
+			EditJournal::removeSession(session);
+			continue;
+		}
+
+		Subtitle *subtitle = new Subtitle();
+		EditJournal::Info info{QUrl(), QString(), false, QUrl(), QString()};
+		bool changed = false;
+		if(!EditJournal::replay(session, subtitle, &info, &changed)) {
+			// session files are kept, recovery can be retried or discarded on next start
+			delete subtitle;
+			KMessageBox::error(m_mainWindow, i18n("Could not recover the unsaved changes."));
+			continue;
+		}
+		if(!closeSubtitle()) {
+			delete subtitle;
+			return false;
+		}
+
+		AppGlobal::subtitle = subtitle;
+		m_subtitleUrl = info.url;
+		processSubtitleOpened(sessionCodec(info.url), info.format);
+		if(changed)
+			appSubtitle()->markPrimaryDirty();
+
+		if(info.translationMode) {
+			m_subtitleTrUrl = info.translationUrl;
+			m_subtitleTrFormat = info.translationFormat;
+			processTranslationOpened(sessionCodec(info.translationUrl), info.translationFormat);
+			if(changed)
+				appSubtitle()->markSecondaryDirty();
+		}
+		// new session records recovered changes, they are not in its journal
+		updateSessionInfo();
+		EditJournal::removeSession(session);
+		recovered = true;
+		// other sessions are offered on next start
+		break;
+	}
+
+	return recovered;
+}
+
 void
 Application::newSubtitleTr()
 {
@@ -434,6 +514,7 @@ Application::newSubtitleTr()
 	emit translationModeChanged(true);
 
 	updateTitle();
+	updateSessionInfo();
 }
 
 void
@@ -540,6 +621,8 @@ Application::processTranslationOpened(QTextCodec *codec, const QString &subtitle
 		updateTitle();
 		emit translationModeChanged(true);
 	}
+
+	updateSessionInfo();
 }
 
 bool
@@ -564,6 +647,7 @@ Application::saveSubtitleTr(QTextCodec *codec)
 		m_subtitleTrEncoding = codec->name();
 
 		updateTitle();
+		updateSessionInfo();
 
 		return true;
 	} else {
@@ -636,6 +720,8 @@ Application::closeSubtitleTr()
 //		AppGlobal::undoStack = savedStack;
 
 		m_mainWindow->m_linesWidget->setUpdatesEnabled(true);
+
+		updateSessionInfo();
 	}
 
 	return true;
@@ -8,13 +8,23 @@
 #ifndef FORMATDATA_H
 #define FORMATDATA_H
 
+#include <QDataStream>
 #include <QString>
 #include <QMap>
 
+namespace SubtitleComposer {
+class FormatData;
+}
+
+QDataStream & operator<<(QDataStream &stream, const SubtitleComposer::FormatData &formatData);
+QDataStream & operator>>(QDataStream &stream, SubtitleComposer::FormatData &formatData);
+
 namespace SubtitleComposer {
 class FormatData
 {
 	friend class Format;
+	friend QDataStream & ::operator<<(QDataStream &stream, const FormatData &formatData);
+	friend QDataStream & ::operator>>(QDataStream &stream, FormatData &formatData);
 
 public:
 	FormatData(const FormatData &formatData) :
@@ -32,15 +42,16 @@ public:
 		return *this;
 	}
 
-	inline const QString & formatName()
+	inline const QString & formatName() const
 	{
 		return m_formatName;
 	}
 
-	inline const QString & value(const QString &key)
+	inline const QString & value(const QString &key) const
 	{
 		static const QString empty;
-		return m_data.contains(key) ? m_data[key] : empty;
+		auto it = m_data.constFind(key);
+		return it != m_data.cend() ? it.value() : empty;
 	}
 
 	inline void setValue(const QString &key, const QString &value)
@@ -61,4 +72,16 @@ private:
 };
 }
 
+inline QDataStream &
+operator<<(QDataStream &stream, const SubtitleComposer::FormatData &formatData)
+{
+	return stream << formatData.m_formatName << formatData.m_data;
+}
+
+inline QDataStream &
+operator>>(QDataStream &stream, SubtitleComposer::FormatData &formatData)
+{
+	return stream >> formatData.m_formatName >> formatData.m_data;
+}
+
 #endif
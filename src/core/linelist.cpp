@@ -0,0 +1,286 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "linelist.h"
+
+#include "core/subtitleline.h"
+
+#include <algorithm>
+
+using namespace SubtitleComposer;
+
+LineList::LineList()
+	: m_count(0),
+	  m_dirtyChunk(0),
+	  m_lastChunk(0)
+{
+}
+
+LineList::~LineList()
+{
+	clear();
+}
+
+void
+LineList::updateStarts() const
+{
+	const int n = m_chunks.size();
+	if(m_dirtyChunk >= n)
+		return;
+
+	int start = 0;
+	if(m_dirtyChunk > 0) {
+		const LineListChunk *prev = m_chunks.at(m_dirtyChunk - 1);
+		start = prev->start + prev->lines.size();
+	}
+	for(int i = m_dirtyChunk; i < n; i++) {
+		LineListChunk *chunk = m_chunks.at(i);
+		chunk->start = start;
+		start += chunk->lines.size();
+	}
+	m_dirtyChunk = n;
+}
+
+int
+LineList::chunkAt(int index) const
+{
+	Q_ASSERT(index >= 0 && index < m_count);
+
+	updateStarts();
+
+	// sequential access will mostly hit the same or next chunk
+	if(m_lastChunk < m_chunks.size()) {
+		const LineListChunk *chunk = m_chunks.at(m_lastChunk);
+		if(index >= chunk->start) {
+			if(index < chunk->start + chunk->lines.size())
+				return m_lastChunk;
+			if(m_lastChunk + 1 < m_chunks.size() && index < chunk->start + chunk->lines.size() + m_chunks.at(m_lastChunk + 1)->lines.size())
+				return ++m_lastChunk;
+		}
+	}
+
+	auto it = std::upper_bound(m_chunks.cbegin(), m_chunks.cend(), index,
+		[](int idx, const LineListChunk *chunk){ return idx < chunk->start; });
+	m_lastChunk = int(it - m_chunks.cbegin()) - 1;
+	return m_lastChunk;
+}
+
+void
+LineList::attachLines(LineListChunk *chunk, int offset) const
+{
+	for(int i = offset, n = chunk->lines.size(); i < n; i++) {
+		SubtitleLine *line = chunk->lines.at(i);
+		line->m_listChunk = chunk;
+		line->m_listOffset = i;
+	}
+}
+
+void
+LineList::renumberChunks(int pos)
+{
+	for(int i = pos, n = m_chunks.size(); i < n; i++)
+		m_chunks.at(i)->pos = i;
+	markDirty(pos);
+}
+
+int
+LineList::splitChunk(int index)
+{
+	// makes sure that line at index starts a chunk, returns position of that chunk
+	if(index == m_count)
+		return m_chunks.size();
+
+	const int pos = chunkAt(index);
+	LineListChunk *chunk = m_chunks.at(pos);
+	const int offset = index - chunk->start;
+	if(offset == 0)
+		return pos;
+
+	LineListChunk *tail = new LineListChunk();
+	tail->lines = chunk->lines.mid(offset);
+	chunk->lines.resize(offset);
+	m_chunks.insert(pos + 1, tail);
+	renumberChunks(pos + 1);
+	attachLines(tail, 0);
+	return pos + 1;
+}
+
+void
+LineList::mergeSmallChunks(int pos)
+{
+	// join chunk at pos with its previous chunk when one of them got too small
+	if(pos <= 0 || pos >= m_chunks.size())
+		return;
+
+	LineListChunk *prev = m_chunks.at(pos - 1);
+	LineListChunk *chunk = m_chunks.at(pos);
+	if(prev->lines.size() + chunk->lines.size() > ChunkSize)
+		return;
+	if(prev->lines.size() >= ChunkMergeSize && chunk->lines.size() >= ChunkMergeSize)
+		return;
+
+	const int offset = prev->lines.size();
+	prev->lines += chunk->lines;
+	attachLines(prev, offset);
+	m_chunks.remove(pos);
+	delete chunk;
+	renumberChunks(pos - 1);
+}
+
+SubtitleLine *
+LineList::at(int index) const
+{
+	const LineListChunk *chunk = m_chunks.at(chunkAt(index));
+	return chunk->lines.at(index - chunk->start);
+}
+
+int
+LineList::indexOf(const SubtitleLine *line) const
+{
+	const LineListChunk *chunk = line->m_listChunk;
+	if(!chunk || chunk->pos >= m_chunks.size() || m_chunks.at(chunk->pos) != chunk)
+		return -1;
+
+	updateStarts();
+	return chunk->start + line->m_listOffset;
+}
+
+void
+LineList::insert(int index, SubtitleLine *line)
+{
+	Q_ASSERT(index >= 0 && index <= m_count);
+
+	if(m_chunks.isEmpty()) {
+		LineListChunk *chunk = new LineListChunk();
+		chunk->start = 0;
+		m_chunks.append(chunk);
+		renumberChunks(0);
+	}
+
+	int pos, offset;
+	if(index == m_count) {
+		pos = m_chunks.size() - 1;
+		offset = m_chunks.last()->lines.size();
+	} else {
+		pos = chunkAt(index);
+		offset = index - m_chunks.at(pos)->start;
+	}
+
+	LineListChunk *chunk = m_chunks.at(pos);
+	chunk->lines.insert(offset, line);
+	attachLines(chunk, offset);
+	m_count++;
+	markDirty(pos + 1);
+
+	if(chunk->lines.size() > ChunkSize) {
+		updateStarts();
+		splitChunk(chunk->start + ChunkSize / 2);
+	}
+}
+
+void
+LineList::insert(int index, const QList<SubtitleLine *> &lines)
+{
+	Q_ASSERT(index >= 0 && index <= m_count);
+
+	if(lines.size() < ChunkMergeSize) {
+		for(SubtitleLine *line : lines)
+			insert(index++, line);
+		return;
+	}
+
+	// lines get their own chunks, so only the chunk at index has to be split
+	int pos = splitChunk(index);
+	const int firstPos = pos;
+	const int chunkSize = ChunkSize * 3 / 4;
+	for(int i = 0, n = lines.size(); i < n; i += chunkSize) {
+		LineListChunk *chunk = new LineListChunk();
+		chunk->lines.reserve(qMin(chunkSize, n - i));
+		for(int j = i, end = qMin(n, i + chunkSize); j < end; j++)
+			chunk->lines.append(lines.at(j));
+		m_chunks.insert(pos++, chunk);
+		attachLines(chunk, 0);
+	}
+	m_count += lines.size();
+	renumberChunks(firstPos);
+	mergeSmallChunks(pos);
+	mergeSmallChunks(firstPos);
+}
+
+SubtitleLine *
+LineList::takeAt(int index)
+{
+	SubtitleLine *line = at(index);
+	remove(index, 1);
+	return line;
+}
+
+void
+LineList::remove(int index, int count)
+{
+	Q_ASSERT(index >= 0 && count >= 0 && index + count <= m_count);
+
+	if(!count)
+		return;
+
+	const int firstPos = chunkAt(index);
+	int pos = firstPos;
+	int offset = index - m_chunks.at(pos)->start;
+	bool emptyChunks = false;
+	m_count -= count;
+	while(count > 0) {
+		LineListChunk *chunk = m_chunks.at(pos++);
+		const int n = qMin(count, chunk->lines.size() - offset);
+		for(int i = offset; i < offset + n; i++)
+			chunk->lines.at(i)->m_listChunk = nullptr;
+		chunk->lines.remove(offset, n);
+		attachLines(chunk, offset);
+		emptyChunks |= chunk->lines.isEmpty();
+		count -= n;
+		offset = 0;
+	}
+
+	if(emptyChunks) {
+		auto it = std::remove_if(m_chunks.begin() + firstPos, m_chunks.begin() + pos, [](LineListChunk *chunk){
+			if(!chunk->lines.isEmpty())
+				return false;
+			delete chunk;
+			return true;
+		});
+		m_chunks.erase(it, m_chunks.begin() + pos);
+	}
+	renumberChunks(firstPos);
+	mergeSmallChunks(firstPos + 1);
+	mergeSmallChunks(firstPos);
+}
+
+void
+LineList::replace(int index, SubtitleLine *line)
+{
+	LineListChunk *chunk = m_chunks.at(chunkAt(index));
+	const int offset = index - chunk->start;
+	SubtitleLine *&slot = chunk->lines[offset];
+	// replaced line could already be placed somewhere else (e.g. when permuting lines)
+	if(slot->m_listChunk == chunk && slot->m_listOffset == offset)
+		slot->m_listChunk = nullptr;
+	slot = line;
+	line->m_listChunk = chunk;
+	line->m_listOffset = offset;
+}
+
+void
+LineList::clear()
+{
+	for(LineListChunk *chunk : qAsConst(m_chunks)) {
+		for(SubtitleLine *line : qAsConst(chunk->lines))
+			line->m_listChunk = nullptr;
+		delete chunk;
+	}
+	m_chunks.clear();
+	m_count = 0;
+	m_dirtyChunk = 0;
+	m_lastChunk = 0;
+}
@@ -0,0 +1,72 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef LINELIST_H
+#define LINELIST_H
+
+#include <QList>
+#include <QVector>
+
+namespace SubtitleComposer {
+class SubtitleLine;
+
+struct LineListChunk
+{
+	QVector<SubtitleLine *> lines;
+	int start;      // index of the first line, valid only before LineList::m_dirtyChunk
+	int pos;        // position in LineList::m_chunks
+};
+
+// Ordered container of subtitle lines. Lines are kept in chunks of limited size and every line
+// knows its chunk and offset inside of it, so index lookup doesn't have to search. Insertion and
+// removal only shift lines of a single chunk, chunk start indexes are recalculated lazily and
+// line at index is found by binary search over chunk starts.
+class LineList
+{
+public:
+	LineList();
+	~LineList();
+
+	inline int count() const { return m_count; }
+	inline int size() const { return m_count; }
+	inline bool isEmpty() const { return m_count == 0; }
+	inline bool empty() const { return m_count == 0; }
+
+	SubtitleLine * at(int index) const;
+	inline SubtitleLine * first() const { return at(0); }
+	inline SubtitleLine * last() const { return at(m_count - 1); }
+
+	int indexOf(const SubtitleLine *line) const;
+
+	void insert(int index, SubtitleLine *line);
+	void insert(int index, const QList<SubtitleLine *> &lines);
+	SubtitleLine * takeAt(int index);
+	void remove(int index, int count = 1);
+	void replace(int index, SubtitleLine *line);
+	void clear();
+
+private:
+	enum { ChunkSize = 512, ChunkMergeSize = ChunkSize / 4 };
+
+	LineList(const LineList &) = delete;
+	LineList & operator=(const LineList &) = delete;
+
+	void updateStarts() const;
+	int chunkAt(int index) const;
+	int splitChunk(int index);
+	void attachLines(LineListChunk *chunk, int offset) const;
+	void renumberChunks(int pos);
+	void mergeSmallChunks(int pos);
+	inline void markDirty(int pos) { if(pos < m_dirtyChunk) m_dirtyChunk = pos; }
+
+	QVector<LineListChunk *> m_chunks;
+	int m_count;
+	mutable int m_dirtyChunk;
+	mutable int m_lastChunk;
+};
+}
+
+#endif // LINELIST_H
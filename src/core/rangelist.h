@@ -13,6 +13,8 @@
 #include <QList>
 #include <QStringList>
 
+#include <algorithm>
+
 #include <QDebug>
 
 namespace SubtitleComposer {
@@ -58,39 +60,80 @@ public:
 
 	RangeList complement() const
 	{
-		qDebug() << this->inspect();
-
 		if(m_ranges.empty())
 			return Range(0, Range::MaxIndex);
 
 		RangeList ret;
+		ret.m_ranges.reserve(m_ranges.count() + 1);
 
 		QList<Range>::ConstIterator it = m_ranges.begin();
 
 		if(it->m_start > 0)
-			ret << Range(0, it->m_start - 1);
+			ret.m_ranges.append(Range(0, it->m_start - 1));
 
 		int lastEnd = it->m_end;
 		++it;
 		for(QList<Range>::ConstIterator end = m_ranges.end(); it != end; ++it) {
-			ret << Range(lastEnd + 1, it->m_start - 1);
+			ret.m_ranges.append(Range(lastEnd + 1, it->m_start - 1));
 			lastEnd = it->m_end;
 		}
 		if(lastEnd < Range::MaxIndex)
-			ret << Range(lastEnd + 1, Range::MaxIndex);
+			ret.m_ranges.append(Range(lastEnd + 1, Range::MaxIndex));
+
+		return ret;
+	}
 
-		qDebug() << ret.inspect();
+	RangeList united(const RangeList &ranges) const
+	{
+		RangeList ret;
+		ret.m_ranges.reserve(m_ranges.count() + ranges.m_ranges.count());
+
+		// merge both sorted lists, joining overlapping and adjacent ranges
+		QList<Range>::ConstIterator it1 = m_ranges.begin(), end1 = m_ranges.end();
+		QList<Range>::ConstIterator it2 = ranges.m_ranges.begin(), end2 = ranges.m_ranges.end();
+		while(it1 != end1 || it2 != end2) {
+			const Range &range = it2 == end2 || (it1 != end1 && it1->m_start <= it2->m_start) ? *it1++ : *it2++;
+			if(!ret.m_ranges.empty() && ret.m_ranges.last().m_end >= range.m_start - 1) {
+				Range &last = ret.m_ranges.last();
+				if(range.m_end > last.m_end)
+					last.m_end = range.m_end;
+			} else {
+				ret.m_ranges.append(range);
+			}
+		}
 
 		return ret;
 	}
 
-	bool contains(int index) const
+	RangeList intersected(const RangeList &ranges) const
 	{
-		for(QList<Range>::ConstIterator it = m_ranges.begin(), end2 = m_ranges.end(); it != end2; ++it)
-			if(it->contains(index))
-				return true;
+		RangeList ret;
+
+		QList<Range>::ConstIterator it1 = m_ranges.begin(), end1 = m_ranges.end();
+		QList<Range>::ConstIterator it2 = ranges.m_ranges.begin(), end2 = ranges.m_ranges.end();
+		while(it1 != end1 && it2 != end2) {
+			const int start = qMax(it1->m_start, it2->m_start);
+			const int end = qMin(it1->m_end, it2->m_end);
+			if(start <= end)
+				ret.m_ranges.append(Range(start, end));
+			if(it1->m_end < it2->m_end)
+				++it1;
+			else
+				++it2;
+		}
 
-		return false;
+		return ret;
+	}
+
+	bool contains(int index) const
+	{
+		// first range that starts after index, the one before it is the only candidate
+		QList<Range>::ConstIterator it = std::upper_bound(m_ranges.begin(), m_ranges.end(), index,
+			[](int idx, const Range &range){ return idx < range.start(); });
+		if(it == m_ranges.begin())
+			return false;
+		--it;
+		return index <= it->m_end;
 	}
 
 	Range range(int rangeIndex) const
@@ -164,71 +207,38 @@ public:
 		if(m_ranges.empty())
 			return;
 
-		// GENERAL ALGORITHM FOLLOWS
-		// - we search the lower and the upper items affected.
-		//   - update lower item start and end values
-		//   - remove all items below lower up and above upper (lower and upper excluded)
+		// - lower is the first item ending at or after range start
+		// - upper is the first item starting after range end
+		// - items outside [lower, upper) are removed and the remaining edges are clipped
 
 		//       0         1         2
-		//     XXXXX     XXXXX     XXXXX           [L, U]
-		//  [    ]                                 [0, 0]
-		//  []                                     [0, 4]
-		//  [         ]                            [0, 0]
-		//  [            ]                         [0, 1]
-		//      [               ]                  [0, 1]
-		//           []                            [1, 3]
-		//           [     ]                       [1, 1]
-		//                [     ]                  [1, 1]
-		//  [                              ]       [0, 2]
-		//                            [    ]       [2, 2]
-		//                                 [  ]    [3, 2]
-		//  [                         ]            [0, 2]
-
-		const int SIZE = m_ranges.count();
-		const int LAST_INDEX = SIZE - 1;
-
-		int lowerIndex = SIZE;
-		int upperIndex = LAST_INDEX;
-
-		for(int index = 0; index <= LAST_INDEX; ++index) {
-			Range &currentRange = m_ranges[index];
-
-			if(lowerIndex == SIZE) {
-				if(range.m_start <= currentRange.m_end) {
-					lowerIndex = index;
-					if(range.m_end < currentRange.m_start) {
-						// special case, we must remove all items
-						upperIndex = LAST_INDEX + 1;
-						break;
-					}
-				}
-			} else {
-				if(range.m_end < currentRange.m_start) {
-					upperIndex = index - 1;
-					break;
-				}
-			}
-		}
-
-		if(lowerIndex > LAST_INDEX || upperIndex > LAST_INDEX) {
+		//     XXXXX     XXXXX     XXXXX           [L, U)
+		//  [    ]                                 [0, 1)
+		//  []                                     [0, 0)
+		//  [            ]                         [0, 2)
+		//           []                            [1, 1)
+		//                [     ]                  [1, 2)
+		//                                 [  ]    [3, 3)
+		//  [                         ]            [0, 3)
+
+		QList<Range>::Iterator lower = std::lower_bound(m_ranges.begin(), m_ranges.end(), range.m_start,
+			[](const Range &r, int start){ return r.end() < start; });
+		QList<Range>::Iterator upper = std::upper_bound(lower, m_ranges.end(), range.m_end,
+			[](int end, const Range &r){ return end < r.start(); });
+
+		if(lower == upper) {
 			m_ranges.clear();
-		} else {
-			Range &lowerRange = m_ranges[lowerIndex];
-			Range &upperRange = m_ranges[upperIndex];
-
-			if(range.m_start > lowerRange.m_start)
-				lowerRange.m_start = range.m_start;
-			if(range.m_end < upperRange.m_end)
-				upperRange.m_end = range.m_end;
+			return;
+		}
 
-			// remove all items after upperRange
-			for(int index = upperIndex + 1; index < SIZE; ++index)
-				m_ranges.removeAt(upperIndex + 1);
+		if(range.m_start > lower->m_start)
+			lower->m_start = range.m_start;
+		if(range.m_end < (upper - 1)->m_end)
+			(upper - 1)->m_end = range.m_end;
 
-			// remove all items before lowerRange
-			for(int index = 0; index < lowerIndex; ++index)
-				m_ranges.removeAt(0);
-		}
+		const int lowerIndex = lower - m_ranges.begin();
+		m_ranges.erase(upper, m_ranges.end());
+		m_ranges.erase(m_ranges.begin(), m_ranges.begin() + lowerIndex);
 	}
 
 	void operator<<(const Range &range)
@@ -251,72 +261,31 @@ public:
 					if(range.m_end + 1 == firstRange.m_start) // range is absorbed by firstRange
 						firstRange.m_start = range.m_start;
 					else
-						m_ranges.append(range);
+						m_ranges.prepend(range);
 					return;
 				}
 			}
 		}
 
 		// GENERAL ALGORITHM FOLLOWS
-		// - we search the lower and the upper items affected.
-		//   - update lower item start and end values
-		//   - remove all items following lower up to upper (lower excluded)
-
-		//       0         1         2
-		//     XXXXX     XXXXX     XXXXX           [L, U]
-		//  [    ]                                 [0, 0]
-		//  [         ]                            [0, 0]
-		//  [            ]                         [0, 1]
-		//  [                   ]                  [0, 1]
-		//          [ ]                            [0, 0]
-		//          [      ]                       [0, 1]
-		//  [                              ]       [0, 2]
-		//                            [    ]       [2, 2]
-		//                                  [ ]    [2, 2] this case isn't correctly handled below but was caught before
-		//           []                            [1, 3]
-
-		const int LAST_INDEX = m_ranges.count() - 1;
-
-		int lowerIndex = LAST_INDEX;
-		int upperIndex = LAST_INDEX;
-
-		for(int index = 0; index < LAST_INDEX; ++index) {
-			Range &currentRange = m_ranges[index];
-
-			if(lowerIndex == LAST_INDEX) {
-				if(range.m_start <= currentRange.m_end + 1) {
-					lowerIndex = index;
-					if(range.m_end < currentRange.m_start - 1) {
-						// special case, we must insert a new Range at lowerIndex
-						upperIndex = LAST_INDEX + 1;
-						break;
-					}
-				}
-			} else {
-				if(range.m_end < currentRange.m_start - 1) {
-					upperIndex = index - 1;
-					break;
-				}
-			}
-		}
+		// - lower is the first item ending at or after range start (adjacent included)
+		// - upper is the first item starting after range end (adjacent excluded)
+		// - items in [lower, upper) are joined with range, if there are none range is inserted at lower
 
-		if(upperIndex > LAST_INDEX) {
-			// insert new range at lowerIndex
-			m_ranges.insert(m_ranges.begin() + lowerIndex, range);
-		} else {
-			Range &lowerRange = m_ranges[lowerIndex];
-			Range &upperRange = m_ranges[upperIndex];
-
-			if(range.m_start < lowerRange.m_start)
-				lowerRange.m_start = range.m_start;
-			if(range.m_end > upperRange.m_end)
-				lowerRange.m_end = range.m_end;
-			else
-				lowerRange.m_end = upperRange.m_end;
+		QList<Range>::Iterator lower = std::lower_bound(m_ranges.begin(), m_ranges.end(), range.m_start,
+			[](const Range &r, int start){ return r.end() < start - 1; });
+		QList<Range>::Iterator upper = std::upper_bound(lower, m_ranges.end(), range.m_end,
+			[](int end, const Range &r){ return end < r.start() - 1; });
 
-			for(int index = lowerIndex + 1; index <= upperIndex; ++index)
-				m_ranges.removeAt(lowerIndex + 1);
+		if(lower == upper) {
+			m_ranges.insert(lower, range);
+			return;
 		}
+
+		if(range.m_start < lower->m_start)
+			lower->m_start = range.m_start;
+		lower->m_end = qMax(range.m_end, (upper - 1)->m_end);
+		m_ranges.erase(lower + 1, upper);
 	}
 
 	void shiftIndexesForwards(int fromIndex, int delta, bool fillSplitGap)
@@ -74,6 +74,7 @@ const RichStyle RichStyle::s_null(0, 0, 0, -1);
 class RichStringStyle {
 	friend QDataStream & ::operator<<(QDataStream &stream, const SubtitleComposer::RichString &string);
 	friend QDataStream & ::operator>>(QDataStream &stream, SubtitleComposer::RichString &string);
+	friend class RichString;
 
 public:
 	RichStringStyle(int len);
@@ -575,6 +576,80 @@ operator>>(QDataStream &stream, RichString &string)
 	return stream;
 }
 
+void
+RichString::writeStyled(QDataStream &stream) const
+{
+	stream << static_cast<const QString &>(*this);
+	stream << m_style->m_classList;
+	stream << m_style->m_voiceList;
+
+	const int len = length();
+	const auto runEnd = [&](int start){
+		const RichStyle &style = m_style->at(start);
+		int end = start + 1;
+		while(end < len && m_style->at(end) == style)
+			end++;
+		return end;
+	};
+
+	quint32 runCount = 0;
+	for(int i = 0; i < len; i = runEnd(i))
+		runCount++;
+	stream << runCount;
+	for(int i = 0; i < len; ) {
+		const RichStyle &style = m_style->at(i);
+		const int end = runEnd(i);
+		stream << quint32(end - i) << quint8(style.flags()) << quint32(style.color()) << quint64(style.klass()) << qint32(style.voice());
+		i = end;
+	}
+}
+
+bool
+RichString::readStyled(QDataStream &stream)
+{
+	QString text;
+	QVector<QString> classList;
+	QVector<QString> voiceList;
+	quint32 runCount = 0;
+	stream >> text >> classList >> voiceList >> runCount;
+
+	// class set is a 64 bit mask
+	bool valid = stream.status() == QDataStream::Ok && classList.size() <= 64 && runCount <= quint32(text.length());
+	if(valid) {
+		*this = text;
+		m_style->m_classList = classList;
+		m_style->m_voiceList = voiceList;
+	}
+
+	const quint64 classMask = classList.size() >= 64 ? ~quint64(0) : (quint64(1) << classList.size()) - 1;
+	int index = 0;
+	for(quint32 i = 0; valid && i < runCount; i++) {
+		quint32 len;
+		quint8 flags;
+		quint32 color;
+		quint64 klass;
+		qint32 voice;
+		stream >> len >> flags >> color >> klass >> voice;
+		valid = stream.status() == QDataStream::Ok
+			&& len > 0 && len <= quint32(text.length() - index)
+			&& !(flags & ~AllStyles)
+			&& !(klass & ~classMask)
+			&& voice >= -1 && voice < voiceList.size();
+		if(valid) {
+			m_style->fill(index, len, RichStyle(flags, color, klass, voice));
+			index += len;
+		}
+	}
+
+	if(!valid || index != text.length()) {
+		clear();
+		if(stream.status() == QDataStream::Ok)
+			stream.setStatus(QDataStream::ReadCorruptData);
+		return false;
+	}
+	return true;
+}
+
 inline void
 RichStringStyle::richText(QString &out, int prevIndex, int curIndex, bool opening)
 {
@@ -81,6 +81,12 @@ public:
 
 	static RichString fromRichString(const QString &richstring);
 	QString richString() const;
+
+	// Portable serialization, styles are written as runs of equal style field by field in stream's
+	// byte order. Unlike operator<<() it doesn't depend on host memory layout.
+	void writeStyled(QDataStream &stream) const;
+	// returns false and sets stream status to ReadCorruptData when style data is invalid
+	bool readStyled(QDataStream &stream);
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
 	RichString & setRichString(const QStringRef &string);
 	inline RichString & setRichString(const QString &string) { return setRichString(QStringRef(&string)); }
@@ -76,6 +76,17 @@ public:
 
 	inline QTextCursor *undoableCursor() { return &m_undoableCursor; }
 
+	/**
+	 * @brief Register a widget that is displaying or editing this document.
+	 *        Documents with attached views are never released by their SubtitleLine.
+	 */
+	inline void attachView() const { m_viewCount++; }
+	inline void detachView() const { Q_ASSERT(m_viewCount > 0); m_viewCount--; }
+	inline bool hasViews() const { return m_viewCount > 0; }
+
+	// changes every time undo history is discarded
+	inline quint32 historyGeneration() const { return m_historyGeneration; }
+
 	void setStylesheet(const RichCSS *css);
 	inline const RichCSS *stylesheet() const { return m_stylesheet; }
 
@@ -92,7 +103,11 @@ public slots:
 	inline void redo() { QTextDocument::redo(&m_undoableCursor); }
 
 private:
-	inline void setUndoRedoEnabled(bool enable) { QTextDocument::setUndoRedoEnabled(enable); }
+	inline void setUndoRedoEnabled(bool enable) {
+		if(!enable)
+			m_historyGeneration++;
+		QTextDocument::setUndoRedoEnabled(enable);
+	}
 	inline int length(int index, int len) const { const int dl = length(); return len < 0 || (index + len) > dl ? dl - index : len; }
 	void linesToBlocks();
 
@@ -103,6 +118,8 @@ private:
 	const RichCSS *m_stylesheet;
 	bool m_domDirty;
 	RichDOM *m_dom;
+	mutable int m_viewCount = 0;
+	quint32 m_historyGeneration = 0;
 
 	void applyChanges(const void *changeList);
 
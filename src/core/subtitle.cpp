@@ -12,10 +12,10 @@
 #include "core/richtext/richdocument.h"
 #include "core/subtitleline.h"
 #include "core/subtitleiterator.h"
+#include "core/subtitlesnapshot.h"
 #include "core/undo/subtitleactions.h"
 #include "core/undo/subtitlelineactions.h"
 #include "core/undo/undostack.h"
-#include "helpers/objectref.h"
 #include "gui/treeview/lineswidget.h"
 
 #include <QTextDocumentFragment>
@@ -23,6 +23,8 @@
 
 #include <KLocalizedString>
 
+#include <algorithm>
+
 using namespace SubtitleComposer;
 
 double Subtitle::s_defaultFramesPerSecond(23.976);
@@ -47,11 +49,44 @@ Subtitle::Subtitle(double framesPerSecond)
 	  m_framesPerSecond(framesPerSecond),
 	  m_stylesheet(new RichCSS()),
 	  m_formatData(nullptr)
-{}
+{
+	connect(this, &Subtitle::linesInserted, this, [this](){ m_timeIndexDirty = true; });
+	connect(this, &Subtitle::linesRemoved, this, [this](){ m_timeIndexDirty = true; });
+	connect(this, &Subtitle::linesReordered, this, [this](){ m_timeIndexDirty = true; });
+	connect(this, &Subtitle::linesAboutToBeRemoved, this, [this](int firstIndex, int lastIndex){
+		if(m_pendingLineChanges.isEmpty())
+			return;
+		for(int i = firstIndex; i <= lastIndex; i++) {
+			const SubtitleLine *line = m_lines.at(i);
+			auto it = m_pendingLineChanges.find(line);
+			if(it == m_pendingLineChanges.end())
+				continue;
+			m_pendingRemovedLineChanges[line] = it.value();
+			m_pendingLineChanges.erase(it);
+		}
+	});
+	connect(this, &Subtitle::linesInserted, this, [this](int firstIndex, int lastIndex){
+		if(m_pendingRemovedLineChanges.isEmpty())
+			return;
+		for(int i = firstIndex; i <= lastIndex; i++) {
+			const SubtitleLine *line = m_lines.at(i);
+			auto it = m_pendingRemovedLineChanges.find(line);
+			if(it == m_pendingRemovedLineChanges.end())
+				continue;
+			m_pendingLineChanges[line] = it.value();
+			m_pendingRemovedLineChanges.erase(it);
+		}
+	});
+}
 
 Subtitle::~Subtitle()
 {
-	qDeleteAll(m_lines);
+	QVector<SubtitleLine *> lines;
+	lines.reserve(m_lines.count());
+	for(int i = 0, n = m_lines.count(); i < n; i++)
+		lines.append(m_lines.at(i));
+	m_lines.clear();
+	qDeleteAll(lines);
 
 	delete m_stylesheet;
 	delete m_formatData;
@@ -81,7 +116,7 @@ Subtitle::setPrimaryData(const Subtitle &from, bool usePrimaryData)
 	const int thisErrors = SubtitleLine::SecondaryOnlyErrors;
 
 	for(SubtitleLine *fromLine = fromIt.current(), *thisLine = thisIt.current(); fromLine && thisLine; ++fromIt, ++thisIt, fromLine = fromIt.current(), thisLine = thisIt.current()) {
-		thisLine->setPrimaryDoc(usePrimaryData ? fromLine->primaryDoc() : fromLine->secondaryDoc());
+		thisLine->resetText(true, fromLine->text(usePrimaryData));
 		thisLine->setTimes(fromLine->showTime(), fromLine->hideTime());
 		thisLine->setErrorFlags((fromLine->errorFlags() & fromErrors) | (thisLine->errorFlags() & thisErrors));
 		thisLine->setFormatData(fromLine->formatData());
@@ -94,7 +129,7 @@ Subtitle::setPrimaryData(const Subtitle &from, bool usePrimaryData)
 		for(; fromIt.current(); ++fromIt) {
 			const SubtitleLine *cur = fromIt.current();
 			SubtitleLine *thisLine = new SubtitleLine(cur->showTime(), cur->hideTime());
-			thisLine->setPrimaryDoc(usePrimaryData ? cur->primaryDoc() : cur->secondaryDoc());
+			thisLine->resetText(true, cur->text(usePrimaryData));
 			thisLine->setErrorFlags(SubtitleLine::SecondaryOnlyErrors, false);
 			thisLine->setFormatData(cur->formatData());
 			thisLine->m_metaData = cur->m_metaData;
@@ -112,6 +147,15 @@ Subtitle::setPrimaryData(const Subtitle &from, bool usePrimaryData)
 		}
 	}
 
+	if(from.hasAnchors()) {
+		removeAllAnchors();
+		for(const SubtitleLine *fromLine : qAsConst(from.m_anchoredLines)) {
+			const int index = fromLine->index();
+			if(index >= 0 && index < m_lines.count())
+				toggleLineAnchor(m_lines.at(index));
+		}
+	}
+
 	endCompositeAction();
 }
 
@@ -137,15 +181,15 @@ Subtitle::setSecondaryData(const Subtitle &from, bool usePrimaryData)
 	const int dstErrors = SubtitleLine::PrimaryOnlyErrors | SubtitleLine::SharedErrors;
 
 	for(int i = 0, n = qMin(m_lines.size(), from.m_lines.size()); i < n; i++) {
-		const SubtitleLine *srcLine = from.m_lines.at(i).obj();
-		SubtitleLine *dstLine = m_lines.at(i).obj();
-		dstLine->setSecondaryDoc(usePrimaryData ? srcLine->primaryDoc() : srcLine->secondaryDoc());
+		const SubtitleLine *srcLine = from.m_lines.at(i);
+		SubtitleLine *dstLine = m_lines.at(i);
+		dstLine->resetText(false, srcLine->text(usePrimaryData));
 		dstLine->setErrorFlags((dstLine->errorFlags() & dstErrors) | (srcLine->errorFlags() & srcErrors));
 	}
 
 	// clear remaining local translations
 	for(int i = from.m_lines.size(), n = m_lines.size(); i < n; i++) {
-		SubtitleLine *dstLine = m_lines.at(i).obj();
+		SubtitleLine *dstLine = m_lines.at(i);
 		dstLine->secondaryDoc()->clear();
 		dstLine->setErrorFlags(SubtitleLine::SecondaryOnlyErrors, false);
 	}
@@ -153,9 +197,9 @@ Subtitle::setSecondaryData(const Subtitle &from, bool usePrimaryData)
 	// insert remaining source translations
 	QList<SubtitleLine *> newLines;
 	for(int i = m_lines.size(), n = from.m_lines.size(); i < n; i++) {
-		const SubtitleLine *srcLine = from.m_lines.at(i).obj();
+		const SubtitleLine *srcLine = from.m_lines.at(i);
 		SubtitleLine *dstLine = new SubtitleLine(srcLine->showTime(), srcLine->hideTime());
-		dstLine->setSecondaryDoc(usePrimaryData ? srcLine->primaryDoc() : srcLine->secondaryDoc());
+		dstLine->resetText(false, srcLine->text(usePrimaryData));
 		dstLine->setErrorFlags(SubtitleLine::PrimaryOnlyErrors, false);
 		newLines.append(dstLine);
 	}
@@ -200,6 +244,29 @@ Subtitle::clearSecondaryDirty()
 	emit secondaryDirtyStateChanged(false);
 }
 
+void
+Subtitle::markPrimaryDirty()
+{
+	// nothing on undo stack leads back to the clean state
+	m_primaryCleanIndex = -1;
+	if(m_primaryDirtyState)
+		return;
+
+	m_primaryDirtyState = true;
+	emit primaryDirtyStateChanged(true);
+}
+
+void
+Subtitle::markSecondaryDirty()
+{
+	m_secondaryCleanIndex = -1;
+	if(m_secondaryDirtyState)
+		return;
+
+	m_secondaryDirtyState = true;
+	emit secondaryDirtyStateChanged(true);
+}
+
 FormatData *
 Subtitle::formatData() const
 {
@@ -242,17 +309,8 @@ Subtitle::changeFramesPerSecond(double toFramesPerSecond, double fromFramesPerSe
 
 	double scaleFactor = fromFramesPerSecond / toFramesPerSecond;
 
-	if(scaleFactor != 1.0) {
-		for(SubtitleIterator it(*this, Range::full()); it.current(); ++it) {
-			Time showTime = it.current()->showTime();
-			showTime *= scaleFactor;
-
-			Time hideTime = it.current()->hideTime();
-			hideTime *= scaleFactor;
-
-			processAction(new SetLineTimesAction(it, showTime, hideTime));
-		}
-	}
+	if(scaleFactor != 1.0 && !m_lines.isEmpty())
+		processAction(new AdjustLinesTimesAction(this, Range::full(), 0., scaleFactor, i18n("Change Frame Rate")));
 
 	endCompositeAction();
 }
@@ -260,13 +318,13 @@ Subtitle::changeFramesPerSecond(double toFramesPerSecond, double fromFramesPerSe
 SubtitleLine *
 Subtitle::line(int index)
 {
-	return index < 0 || index >= m_lines.count() ? nullptr : m_lines.at(index).obj();
+	return index < 0 || index >= m_lines.count() ? nullptr : m_lines.at(index);
 }
 
 const SubtitleLine *
 Subtitle::line(int index) const
 {
-	return index < 0 || index >= m_lines.count() ? nullptr : m_lines.at(index).obj();
+	return index < 0 || index >= m_lines.count() ? nullptr : m_lines.at(index);
 }
 bool
 Subtitle::hasAnchors() const
@@ -280,7 +338,7 @@ Subtitle::isLineAnchored(int index) const
 	if(index < 0 || index >= m_lines.count())
 		return false;
 
-	return isLineAnchored(m_lines[index]);
+	return isLineAnchored(m_lines.at(index));
 }
 
 bool
@@ -298,7 +356,7 @@ Subtitle::toggleLineAnchor(int index)
 	if(index < 0 || index >= m_lines.count())
 		return;
 
-	toggleLineAnchor(m_lines[index]);
+	toggleLineAnchor(m_lines.at(index));
 }
 
 void
@@ -343,6 +401,89 @@ Subtitle::insertIndex(const Time &showTime, int start, int end) const
 	return showTime < m_lines.at(end)->showTime() ? end : end + 1;
 }
 
+void
+Subtitle::timeIndexRebuild() const
+{
+	const int n = m_lines.size();
+	int leaves = 1;
+	while(leaves < n)
+		leaves <<= 1;
+
+	m_timeIndexLeaves = leaves;
+	m_timeIndex.fill(-1., 2 * leaves);
+	for(int i = 0; i < n; i++)
+		m_timeIndex[leaves + i] = m_lines.at(i)->hideTime().toMillis();
+	for(int i = leaves - 1; i > 0; i--)
+		m_timeIndex[i] = qMax(m_timeIndex.at(2 * i), m_timeIndex.at(2 * i + 1));
+
+	m_timeIndexDirty = false;
+}
+
+void
+Subtitle::timeIndexUpdate(const SubtitleLine *line) const
+{
+	if(m_timeIndexDirty)
+		return;
+
+	const int index = line->index();
+	if(index < 0 || index >= m_lines.size()) {
+		m_timeIndexDirty = true;
+		return;
+	}
+
+	int node = m_timeIndexLeaves + index;
+	m_timeIndex[node] = line->hideTime().toMillis();
+	for(node /= 2; node > 0; node /= 2)
+		m_timeIndex[node] = qMax(m_timeIndex.at(2 * node), m_timeIndex.at(2 * node + 1));
+}
+
+void
+Subtitle::timeIndexCollect(QVector<SubtitleLine *> *lines, int node, int nodeStart, int nodeSize, int end, double minHideTime) const
+{
+	if(nodeStart >= end || m_timeIndex.at(node) < minHideTime)
+		return;
+	if(nodeSize == 1) {
+		lines->push_back(m_lines.at(nodeStart));
+		return;
+	}
+	const int half = nodeSize / 2;
+	timeIndexCollect(lines, 2 * node, nodeStart, half, end, minHideTime);
+	timeIndexCollect(lines, 2 * node + 1, nodeStart + half, half, end, minHideTime);
+}
+
+QVector<SubtitleLine *>
+Subtitle::linesInRange(const Time &start, const Time &end) const
+{
+	QVector<SubtitleLine *> lines;
+	if(m_lines.isEmpty() || end < start)
+		return lines;
+
+	if(m_timeIndexDirty)
+		timeIndexRebuild();
+
+	// lines are sorted by show time, so only lines before insertIndex(end) can start before end,
+	// the tree is then used to skip the ones that end before start
+	timeIndexCollect(&lines, 1, 0, m_timeIndexLeaves, insertIndex(end), start.toMillis());
+	return lines;
+}
+
+SubtitleSnapshot
+Subtitle::snapshot() const
+{
+	SubtitleSnapshotData *data = new SubtitleSnapshotData();
+	data->framesPerSecond = m_framesPerSecond;
+	data->metaData = m_metaData;
+	data->formatData = m_formatData ? new FormatData(*m_formatData) : nullptr;
+	const int n = m_lines.count();
+	data->lines.reserve(n);
+	for(int i = 0; i < n; i++)
+		data->lines.append(m_lines.at(i)->snapshot());
+
+	SubtitleSnapshot snapshot;
+	snapshot.d = data;
+	return snapshot;
+}
+
 void
 Subtitle::insertLine(SubtitleLine *line)
 {
@@ -351,6 +492,45 @@ Subtitle::insertLine(SubtitleLine *line)
 	processAction(new InsertLinesAction(this, lines, insertIndex(line->showTime())));
 }
 
+void
+Subtitle::insertLines(QList<SubtitleLine *> lines)
+{
+	if(lines.isEmpty())
+		return;
+
+	// stable sort keeps the order of lines with same show time, same as calling insertLine() on each
+	std::stable_sort(lines.begin(), lines.end(), [](const SubtitleLine *a, const SubtitleLine *b){
+		return a->showTime() < b->showTime();
+	});
+
+	if(m_lines.isEmpty() || !(lines.first()->showTime() < m_lines.last()->showTime())) {
+		// all lines go to the end - this is what parsers of sorted files end up doing
+		processAction(new InsertLinesAction(this, lines));
+		return;
+	}
+
+	beginCompositeAction(i18n("Insert Lines"));
+
+	int pos = 0;
+	for(int i = 0, n = lines.count(); i < n;) {
+		const int index = pos < m_lines.count() ? insertIndex(lines.at(i)->showTime(), pos, m_lines.count() - 1) : m_lines.count();
+		// collect all lines that go into the same place
+		int j = i + 1;
+		if(index == m_lines.count()) {
+			j = n;
+		} else {
+			const Time &nextShowTime = m_lines.at(index)->showTime();
+			while(j < n && lines.at(j)->showTime() < nextShowTime)
+				j++;
+		}
+		processAction(new InsertLinesAction(this, lines.mid(i, j - i), index));
+		pos = index + j - i;
+		i = j;
+	}
+
+	endCompositeAction();
+}
+
 void
 Subtitle::insertLine(SubtitleLine *line, int index)
 {
@@ -405,7 +585,7 @@ Subtitle::insertNewLine(int index, bool insertAfter, SubtitleTarget target)
 		SubtitleLine *line = newLine;
 		SubtitleIterator it(*this, Range::full(), false);
 		for(it.toIndex(newLineIndex + 1); it.current(); ++it) {
-			line->secondaryDoc()->setRichText(it.current()->secondaryDoc()->toRichText());
+			line->setSecondaryText(it.current()->secondaryText());
 			line = it.current();
 		}
 		line->secondaryDoc()->clear();
@@ -419,7 +599,7 @@ Subtitle::insertNewLine(int index, bool insertAfter, SubtitleTarget target)
 		SubtitleIterator it(*this, Range::full(), true);
 		SubtitleLine *line = it.current();
 		for(--it; it.index() >= index; --it) {
-			line->secondaryDoc()->setRichText(it.current()->secondaryDoc()->toRichText());
+			line->setSecondaryText(it.current()->secondaryText());
 			line = it.current();
 		}
 		line->secondaryDoc()->clear();
@@ -464,7 +644,7 @@ Subtitle::removeLines(const RangeList &r, SubtitleTarget target)
 		SubtitleIterator srcIt(*this, rangesComplement);
 		SubtitleIterator dstIt(*this, Range::upper(ranges.firstIndex()));
 		for(; srcIt.current() && dstIt.current(); ++srcIt, ++dstIt)
-			dstIt.current()->secondaryDoc()->setRichText(srcIt.current()->secondaryDoc()->toRichText());
+			dstIt.current()->setSecondaryText(srcIt.current()->secondaryText());
 
 		// the remaining lines secondary text must be cleared
 		for(; dstIt.current(); ++dstIt)
@@ -503,7 +683,7 @@ Subtitle::removeLines(const RangeList &r, SubtitleTarget target)
 		SubtitleIterator srcIt(*this, Range(ranges.firstIndex(), m_lines.count() - lines.count() - 1), true);
 		SubtitleIterator dstIt(*this, rangesComplement, true);
 		for(; srcIt.current() && dstIt.current(); --srcIt, --dstIt)
-			dstIt.current()->secondaryDoc()->setRichText(srcIt.current()->secondaryDoc()->toRichText());
+			dstIt.current()->setSecondaryText(srcIt.current()->secondaryText());
 
 		// finally, we can remove the specified lines
 		RangeList::ConstIterator rangesIt = ranges.end(), begin = ranges.begin();
@@ -694,9 +874,9 @@ Subtitle::shiftAnchoredLine(SubtitleLine *anchoredLine, const Time &newShowTime)
 		return;
 
 	if(!prevAnchor && !nextAnchor) {
-		double shift = newShowTime.toMillis() - anchoredLine->m_showTime.toMillis();
-		for(int i = 0, n = count(); i < n; i++)
-			at(i)->shiftTimes(shift);
+		const double shift = newShowTime.toMillis() - anchoredLine->m_showTime.toMillis();
+		if(shift != 0.)
+			processAction(new AdjustLinesTimesAction(this, Range::full(), shift, 1., i18n("Shift Lines")));
 	} else {
 		// save times as adjustLines() will modify them, and processing nextAnchor will modify them again
 		Time savedShowTime(anchoredLine->m_showTime);
@@ -726,6 +906,7 @@ Subtitle::shiftAnchoredLine(SubtitleLine *anchoredLine, const Time &newShowTime)
 		if(newShowTime.toMillis() < lastShowTime && anchoredLine != last) {
 			anchoredLine->m_showTime = savedShowTime;
 			anchoredLine->m_hideTime = savedHideTime;
+			timeIndexUpdate(anchoredLine);
 			adjustLines(Range(anchoredLine->index(), last->index()), newShowTime.toMillis(), lastShowTime);
 		}
 	}
@@ -748,8 +929,7 @@ Subtitle::shiftLines(const RangeList &ranges, long msecs)
 			}
 		}
 	} else {
-		for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-			it.current()->shiftTimes(msecs);
+		processAction(new AdjustLinesTimesAction(this, ranges, msecs, 1., i18n("Shift Lines")));
 	}
 
 	endCompositeAction();
@@ -793,41 +973,31 @@ Subtitle::adjustLines(const Range &range, long newFirstTime, long newLastTime)
 	if(shiftMseconds == 0 && scaleFactor == 1.0)
 		return;
 
-	beginCompositeAction(i18n("Adjust Lines"));
-
-	for(SubtitleIterator it(*this, range); it.current(); ++it)
-		it.current()->adjustTimes(shiftMseconds, scaleFactor);
-
-	endCompositeAction();
+	processAction(new AdjustLinesTimesAction(this, range, shiftMseconds, scaleFactor, i18n("Adjust Lines")));
 }
 
 void
 Subtitle::sortLines(const Range &range)
 {
-	beginCompositeAction(i18n("Sort"));
-
-	SubtitleIterator it(*this, range);
-	SubtitleLine *line = it.current();
-	SubtitleLine *nextLine = (++it).current();
-	for(; nextLine; ++it, line = nextLine, nextLine = it.current()) {
-		if(line->showTime() <= nextLine->showTime()) // already sorted
-			continue;
-
-		// TODO: could be improved by using insertIndex()
-		SubtitleIterator tmp(it);
-		int fromIndex = tmp.index();
-		int toIndex = -1;
-		while((--tmp).current() && tmp.current()->showTime() > nextLine->showTime())
-			toIndex = tmp.index();
-
-		Q_ASSERT(toIndex != -1);
+	const int firstIndex = range.start();
+	const int lastIndex = normalizeRangeIndex(range.end());
+	if(firstIndex >= lastIndex)
+		return;
 
-		processAction(new MoveLineAction(this, fromIndex, toIndex));
+	int i = firstIndex;
+	while(i < lastIndex && m_lines.at(i)->m_showTime <= m_lines.at(i + 1)->m_showTime)
+		i++;
+	if(i == lastIndex) // already sorted
+		return;
 
-		--it;
-	}
+	QVector<int> permutation(lastIndex - firstIndex + 1);
+	for(int j = 0, n = permutation.size(); j < n; j++)
+		permutation[j] = j;
+	std::stable_sort(permutation.begin(), permutation.end(), [&](int a, int b){
+		return m_lines.at(firstIndex + a)->m_showTime < m_lines.at(firstIndex + b)->m_showTime;
+	});
 
-	endCompositeAction();
+	processAction(new PermuteLinesAction(this, firstIndex, permutation));
 }
 
 void
@@ -836,7 +1006,10 @@ Subtitle::applyDurationLimits(const RangeList &ranges, const Time &minDuration,
 	if(m_lines.isEmpty() || minDuration > maxDuration)
 		return;
 
-	beginCompositeAction(i18n("Enforce Duration Limits"));
+	// new hide times are collected and applied by a single action
+	QVector<int> indexes;
+	QVector<Time> showTimes, hideTimes;
+	QVector<QPair<SubtitleLine *, Time>> swappedLines;
 
 	for(RangeList::ConstIterator rangesIt = ranges.begin(), end = ranges.end(); rangesIt != end; ++rangesIt) {
 		Time lineDuration;
@@ -848,24 +1021,46 @@ Subtitle::applyDurationLimits(const RangeList &ranges, const Time &minDuration,
 		for(; line; ++it, line = nextLine, nextLine = it.current()) {
 			lineDuration = line->durationTime();
 
+			Time hideTime = line->hideTime();
 			if(lineDuration > maxDuration)
-				line->setDurationTime(maxDuration);
+				hideTime = line->showTime() + maxDuration;
 			else if(lineDuration < minDuration) {
 				if(!nextLine) // the last line doesn't have risk of overlapping
-					line->setDurationTime(minDuration);
+					hideTime = line->showTime() + minDuration;
 				else {
 					if(canOverlap || line->showTime() + minDuration < nextLine->showTime())
-						line->setDurationTime(minDuration);
+						hideTime = line->showTime() + minDuration;
 					else {          // setting the duration to minDuration will cause an unwanted overlap
 						if(line->hideTime() < nextLine->showTime()) // make duration as big as possible without overlap
-							line->setHideTime(nextLine->showTime() - 1);
+							hideTime = nextLine->showTime() - 1;
 						// else line is already at the maximum duration without overlap (or overlapping) so we don't change it
 					}
 				}
 			}
+
+			if(hideTime == line->hideTime())
+				continue;
+			if(hideTime < line->showTime()) {
+				// setHideTime() will swap show/hide times and move the line
+				swappedLines.push_back(qMakePair(line, hideTime));
+				continue;
+			}
+			indexes.push_back(line->index());
+			showTimes.push_back(line->showTime());
+			hideTimes.push_back(hideTime);
 		}
 	}
 
+	if(indexes.isEmpty() && swappedLines.isEmpty())
+		return;
+
+	beginCompositeAction(i18n("Enforce Duration Limits"));
+
+	if(!indexes.isEmpty())
+		processAction(new SetLinesTimesAction(this, indexes, showTimes, hideTimes, i18n("Enforce Duration Limits")));
+	for(const auto &swapped : qAsConst(swappedLines))
+		swapped.first->setHideTime(swapped.second);
+
 	endCompositeAction();
 }
 
@@ -1170,8 +1365,15 @@ Subtitle::syncWithSubtitle(const Subtitle &refSubtitle)
 {
 	beginCompositeAction(i18n("Synchronize Subtitles"));
 
-	for(SubtitleIterator it(*this, Range::full()), refIt(refSubtitle, Range::full()); it.current() && refIt.current(); ++it, ++refIt)
-		processAction(new SetLineTimesAction(it.current(), refIt.current()->showTime(), refIt.current()->hideTime()));
+	QVector<int> indexes;
+	QVector<Time> showTimes, hideTimes;
+	for(SubtitleIterator it(*this, Range::full()), refIt(refSubtitle, Range::full()); it.current() && refIt.current(); ++it, ++refIt) {
+		indexes.push_back(it.index());
+		showTimes.push_back(refIt.current()->showTime());
+		hideTimes.push_back(refIt.current()->hideTime());
+	}
+	if(!indexes.isEmpty())
+		processAction(new SetLinesTimesAction(this, indexes, showTimes, hideTimes, i18n("Synchronize Subtitles")));
 
 	sortLines(Range::full());
 
@@ -1188,8 +1390,8 @@ Subtitle::appendSubtitle(const Subtitle &srcSubtitle, double shiftMsecsBeforeApp
 	for(SubtitleIterator it(srcSubtitle); it.current(); ++it) {
 		SubtitleLine *ln = it.current();
 		SubtitleLine *newLine = new SubtitleLine(ln->showTime() + shiftMsecsBeforeAppend, ln->hideTime() + shiftMsecsBeforeAppend);
-		newLine->primaryDoc()->setDocument(ln->primaryDoc());
-		newLine->secondaryDoc()->setDocument(ln->secondaryDoc());
+		newLine->setPrimaryText(ln->primaryText());
+		newLine->setSecondaryText(ln->secondaryText());
 		lines.append(newLine);
 	}
 
@@ -1225,8 +1427,8 @@ Subtitle::splitSubtitle(Subtitle &dstSubtitle, const Time &splitTime, bool shift
 			}
 
 			SubtitleLine *newLine = new SubtitleLine(newShowTime, ln->hideTime() + shiftTime);
-			newLine->primaryDoc()->setDocument(ln->primaryDoc());
-			newLine->secondaryDoc()->setDocument(ln->secondaryDoc());
+			newLine->setPrimaryText(ln->primaryText());
+			newLine->setSecondaryText(ln->secondaryText());
 			if(ln->m_formatData)
 				newLine->m_formatData = new FormatData(*ln->m_formatData);
 
@@ -1398,23 +1600,109 @@ Subtitle::beginCompositeAction(const QString &title) const
 {
 	if(appSubtitle() == this)
 		appUndoStack()->beginMacro(title);
+	if(m_compositeActionDepth++ == 0)
+		emit const_cast<Subtitle *>(this)->compositeActionStart();
 }
 
 void
 Subtitle::endCompositeAction(UndoStack::DirtyMode dirtyOverride) const
 {
+	Q_ASSERT(m_compositeActionDepth > 0);
+	if(--m_compositeActionDepth == 0) {
+		// listeners can still make changes (e.g. error flags) that belong to this action
+		Subtitle *self = const_cast<Subtitle *>(this);
+		self->emitPendingLineChanges();
+		emit self->compositeActionEnd();
+	}
 	if(appSubtitle() == this)
 		appUndoStack()->endMacro(dirtyOverride);
 }
 
+void
+Subtitle::notifyLineChanged(SubtitleLine *line, LineChange change)
+{
+	if(change == HideTimeChange)
+		timeIndexUpdate(line);
+
+	if(m_compositeActionDepth) {
+		m_pendingLineChanges[line] |= change;
+		return;
+	}
+
+	switch(change) {
+	case PrimaryTextChange: emit linePrimaryTextChanged(line); break;
+	case SecondaryTextChange: emit lineSecondaryTextChanged(line); break;
+	case ShowTimeChange: emit lineShowTimeChanged(line); break;
+	case HideTimeChange: emit lineHideTimeChanged(line); break;
+	}
+}
+
+static RangeList
+indexesToRanges(QVector<int> &indexes)
+{
+	RangeList ranges;
+	if(indexes.isEmpty())
+		return ranges;
+	std::sort(indexes.begin(), indexes.end());
+	int start = indexes.first();
+	int end = start;
+	for(int i = 1, n = indexes.size(); i < n; i++) {
+		const int idx = indexes.at(i);
+		if(idx > end + 1) {
+			ranges << Range(start, end);
+			start = idx;
+		}
+		end = idx;
+	}
+	ranges << Range(start, end);
+	return ranges;
+}
+
+void
+Subtitle::emitPendingLineChanges()
+{
+	m_pendingRemovedLineChanges.clear();
+	while(!m_pendingLineChanges.isEmpty()) {
+		QVector<int> primaryText, secondaryText, showTime, hideTime, times;
+		for(auto it = m_pendingLineChanges.cbegin(); it != m_pendingLineChanges.cend(); ++it) {
+			const int idx = it.key()->index();
+			if(it.value() & PrimaryTextChange)
+				primaryText.push_back(idx);
+			if(it.value() & SecondaryTextChange)
+				secondaryText.push_back(idx);
+			if(it.value() & ShowTimeChange)
+				showTime.push_back(idx);
+			if(it.value() & HideTimeChange)
+				hideTime.push_back(idx);
+			if(it.value() & (ShowTimeChange | HideTimeChange))
+				times.push_back(idx);
+		}
+		m_pendingLineChanges.clear();
+
+		// listeners making more changes will be treated as part of the composite action
+		m_compositeActionDepth++;
+		if(!primaryText.isEmpty())
+			emit linesPrimaryTextChanged(indexesToRanges(primaryText));
+		if(!secondaryText.isEmpty())
+			emit linesSecondaryTextChanged(indexesToRanges(secondaryText));
+		if(!showTime.isEmpty())
+			emit linesShowTimeChanged(indexesToRanges(showTime));
+		if(!hideTime.isEmpty())
+			emit linesHideTimeChanged(indexesToRanges(hideTime));
+		if(!times.isEmpty())
+			emit linesTimesChanged(indexesToRanges(times));
+		m_compositeActionDepth--;
+	}
+}
+
 bool
 Subtitle::isPrimaryDirty(int index) const
 {
 	int i = m_primaryCleanIndex;
 	const int d = i > index ? -1 : 1;
 	for(;;) {
-		if(i < 0)
-			return m_primaryCleanIndex >= 0;
+		if(i < 0) // clean state is not reachable
+			return true;
 		const UndoStack::DirtyMode dirtyMode = i > 0 ? appUndoStack()->dirtyMode(i - 1) : UndoStack::None;
 		if(i != m_primaryCleanIndex && (dirtyMode & UndoStack::Primary))
 			return true;
@@ -1430,8 +1718,8 @@ Subtitle::isSecondaryDirty(int index) const
 	int i = m_secondaryCleanIndex;
 	const int d = i > index ? -1 : 1;
 	for(;;) {
-		if(i < 0)
-			return m_secondaryCleanIndex >= 0;
+		if(i < 0) // clean state is not reachable
+			return true;
 		const UndoStack::DirtyMode dirtyMode = i > 0 ? appUndoStack()->dirtyMode(i - 1) : UndoStack::None;
 		if(i != m_secondaryCleanIndex && (dirtyMode & UndoStack::Secondary))
 			return true;
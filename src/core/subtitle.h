@@ -14,7 +14,7 @@
 #include "core/richstring.h"
 #include "core/subtitletarget.h"
 #include "core/undo/undostack.h"
-#include "helpers/objectref.h"
+#include "core/linelist.h"
 #include "formatdata.h"
 
 #include <QObject>
@@ -22,6 +22,7 @@
 #include <QStringList>
 #include <QList>
 #include <QMap>
+#include <QHash>
 
 QT_FORWARD_DECLARE_CLASS(QUndoCommand)
 QT_FORWARD_DECLARE_CLASS(QTextEdit)
@@ -31,6 +32,7 @@ class RichDocument;
 class SubtitleLine;
 class UndoAction;
 class RichCSS;
+class SubtitleSnapshot;
 
 class Subtitle : public QObject, public QSharedData
 {
@@ -48,6 +50,7 @@ class Subtitle : public QObject, public QSharedData
 	friend class InsertLinesAction;
 	friend class RemoveLinesAction;
 	friend class MoveLineAction;
+	friend class PermuteLinesAction;
 	friend class EditStylesheetAction;
 
 	friend class SubtitleLineAction;
@@ -82,9 +85,11 @@ public:
 
 	inline bool isPrimaryDirty() const { return m_primaryDirtyState; }
 	void clearPrimaryDirty();
+	void markPrimaryDirty();
 
 	inline bool isSecondaryDirty() const { return m_secondaryDirtyState; }
 	void clearSecondaryDirty();
+	void markSecondaryDirty();
 
 	double framesPerSecond() const;
 	void setFramesPerSecond(double framesPerSecond);
@@ -97,19 +102,32 @@ public:
 	SubtitleLine * line(int index);
 	const SubtitleLine * line(int index) const;
 
-	inline SubtitleLine * firstLine() { return m_lines.isEmpty() ? nullptr : m_lines.first().obj(); }
-	inline const SubtitleLine * firstLine() const { return m_lines.isEmpty() ? nullptr : m_lines.first().obj(); }
+	inline SubtitleLine * firstLine() { return m_lines.isEmpty() ? nullptr : m_lines.first(); }
+	inline const SubtitleLine * firstLine() const { return m_lines.isEmpty() ? nullptr : m_lines.first(); }
 
-	inline SubtitleLine * lastLine() { return m_lines.isEmpty() ? nullptr : m_lines.last().obj(); }
-	inline const SubtitleLine * lastLine() const { return m_lines.isEmpty() ? nullptr : m_lines.last().obj(); }
+	inline SubtitleLine * lastLine() { return m_lines.isEmpty() ? nullptr : m_lines.last(); }
+	inline const SubtitleLine * lastLine() const { return m_lines.isEmpty() ? nullptr : m_lines.last(); }
 
 	inline int count() const { return m_lines.size(); }
-	inline const SubtitleLine * at(const int i) const { return m_lines.at(i).obj(); }
-	inline SubtitleLine * at(const int i) { return m_lines.at(i).obj(); }
-	inline const SubtitleLine * operator[](const int i) const { return m_lines.at(i).obj(); }
-	inline SubtitleLine * operator[](const int i) { return m_lines.at(i).obj(); }
+	inline const SubtitleLine * at(const int i) const { return m_lines.at(i); }
+	inline SubtitleLine * at(const int i) { return m_lines.at(i); }
+	inline const SubtitleLine * operator[](const int i) const { return m_lines.at(i); }
+	inline SubtitleLine * operator[](const int i) { return m_lines.at(i); }
+
+	/**
+	 * @brief Lines that intersect [start, end] timespan in index order, overlapping lines included.
+	 *        Cost is O(log n + k), index is updated incrementally when line times change.
+	 */
+	QVector<SubtitleLine *> linesInRange(const Time &start, const Time &end) const;
+	inline QVector<SubtitleLine *> linesAt(const Time &time) const { return linesInRange(time, time); }
+
+	/**
+	 * @brief Immutable copy of subtitle that can be read from other threads while subtitle is being edited.
+	 *        Must be called from the thread owning the subtitle, line data that didn't change since
+	 *        previous snapshot is shared instead of copied.
+	 */
+	SubtitleSnapshot snapshot() const;
 
-//	inline const QVector<ObjectRef<SubtitleLine>> & allLines() const { return m_lines; }
 
 //	inline const QList<const SubtitleLine *> & anchoredLines() const { return m_anchoredLines; }
 
@@ -121,6 +139,11 @@ public:
 	void removeAllAnchors();
 
 	void insertLine(SubtitleLine *line);
+	/**
+	 * @brief Insert many lines at once - lines don't need to be sorted, they will be ordered
+	 *        by show time and inserted with as few actions and signals as possible.
+	 */
+	void insertLines(QList<SubtitleLine *> lines);
 	SubtitleLine * insertNewLine(int index, bool timeAfter, SubtitleTarget target);
 	void removeLines(const RangeList &ranges, SubtitleTarget target);
 
@@ -188,6 +211,8 @@ signals:
 	void linesInserted(int firstIndex, int lastIndex);
 	void linesAboutToBeRemoved(int firstIndex, int lastIndex);
 	void linesRemoved(int firstIndex, int lastIndex);
+	void linesAboutToBeReordered(int firstIndex, int lastIndex);
+	void linesReordered(int firstIndex, int lastIndex);
 
 	void compositeActionStart();
 	void compositeActionEnd();
@@ -200,13 +225,27 @@ signals:
 	void lineShowTimeChanged(SubtitleLine *line);
 	void lineHideTimeChanged(SubtitleLine *line);
 	void lineErrorFlagsChanged(SubtitleLine *line);
+	void linePositionChanged(SubtitleLine *line);
+	void lineMetaChanged(SubtitleLine *line);
 	void lineMarkChanged(SubtitleLine *line);
 
+/// line changes made inside of a composite action are reported once it ends
+	void linesPrimaryTextChanged(const RangeList &ranges);
+	void linesSecondaryTextChanged(const RangeList &ranges);
+	void linesShowTimeChanged(const RangeList &ranges);
+	void linesHideTimeChanged(const RangeList &ranges);
+	// lines whose show or hide time changed
+	void linesTimesChanged(const RangeList &ranges);
+
 private:
 	inline int insertIndex(const Time &showTime) const { return insertIndex(showTime, 0, m_lines.isEmpty() ? 0 : m_lines.count() - 1); }
 	int insertIndex(const Time &showTime, int start, int end) const;
 	void insertLine(SubtitleLine *line, int index);
 
+	void timeIndexRebuild() const;
+	void timeIndexUpdate(const SubtitleLine *line) const;
+	void timeIndexCollect(QVector<SubtitleLine *> *lines, int node, int nodeStart, int nodeSize, int end, double minHideTime) const;
+
 	FormatData * formatData() const;
 	void setFormatData(const FormatData *formatData);
 
@@ -214,13 +253,22 @@ private:
 	void endCompositeAction(UndoStack::DirtyMode dirtyOverride = UndoStack::Invalid) const;
 	void processAction(UndoAction *action) const;
 
+	enum LineChange {
+		PrimaryTextChange = 0x1,
+		SecondaryTextChange = 0x2,
+		ShowTimeChange = 0x4,
+		HideTimeChange = 0x8,
+	};
+	void notifyLineChanged(SubtitleLine *line, LineChange change);
+	void emitPendingLineChanges();
+
 	bool isPrimaryDirty(int index) const;
 	bool isSecondaryDirty(int index) const;
 	void updateState();
 
 	inline int normalizeRangeIndex(int index) const { return index >= m_lines.count() ? m_lines.count() - 1 : index; }
 
-	inline SubtitleLine * takeAt(const int i) { SubtitleLine *s = m_lines.at(i).obj(); m_lines.remove(i); return s; }
+	inline SubtitleLine * takeAt(const int i) { return m_lines.takeAt(i); }
 
 	inline bool ignoreDocChanges(bool ignore) {
 		bool r = m_ignoreDocChanges;
@@ -237,7 +285,19 @@ private:
 	bool m_ignoreDocChanges = false;
 
 	double m_framesPerSecond;
-	mutable QVector<ObjectRef<SubtitleLine>> m_lines;
+	mutable LineList m_lines;
+
+	// segment tree with max hide time of lines in m_lines order, rebuilt lazily when lines
+	// are inserted/removed and updated in place when hide time changes
+	mutable QVector<double> m_timeIndex;
+	mutable int m_timeIndexLeaves = 0;
+	mutable bool m_timeIndexDirty = true;
+
+	mutable int m_compositeActionDepth = 0;
+	// LineChange flags of lines changed inside of current composite action, lines that
+	// are taken out are kept aside in case they get inserted back (e.g. MoveLineAction)
+	QHash<const SubtitleLine *, int> m_pendingLineChanges;
+	QHash<const SubtitleLine *, int> m_pendingRemovedLineChanges;
 	QList<const SubtitleLine *> m_anchoredLines;
 
 	QMap<QByteArray, QString> m_metaData;
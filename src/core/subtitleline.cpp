@@ -5,14 +5,18 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 
+#include "appglobal.h"
 #include "core/richtext/richdocument.h"
 #include "core/subtitleline.h"
+#include "core/subtitlesnapshot.h"
 #include "core/undo/subtitlelineactions.h"
 #include "core/undo/subtitleactions.h"
 #include "helpers/common.h"
 #include "scconfig.h"
 
+#include <QCoreApplication>
 #include <QRegularExpression>
+#include <QThread>
 
 #include <KLocalizedString>
 
@@ -20,6 +24,17 @@
 
 using namespace SubtitleComposer;
 
+static bool
+containsInAnyLine(const QString &text, const QRegularExpression &re)
+{
+	// RichDocument::indexOf() matches each block separately, do the same
+	const QStringList lines = text.split(QChar::LineFeed);
+	for(const QString &line: lines) {
+		if(line.contains(re))
+			return true;
+	}
+	return false;
+}
 
 SubtitleLine::ErrorFlag
 SubtitleLine::errorFlag(SubtitleLine::ErrorID id)
@@ -120,31 +135,42 @@ SubtitleLine::fullErrorText(SubtitleLine::ErrorID errorID) const
 	}
 }
 
+const SubtitleLine *SubtitleLine::s_docCacheHead = nullptr;
+const SubtitleLine *SubtitleLine::s_docCacheTail = nullptr;
+int SubtitleLine::s_docCacheCount = 0;
+int SubtitleLine::s_docCacheSize = 500;
+
 void
 SubtitleLine::setupSignals()
 {
-	connect(m_primaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::primaryDocumentChanged);
-	connect(m_secondaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::secondaryDocumentChanged);
-
 	QObject::connect(this, &SubtitleLine::primaryTextChanged, [this](){
-		if(subtitle()) emit subtitle()->linePrimaryTextChanged(this);
+		if(subtitle()) subtitle()->notifyLineChanged(this, Subtitle::PrimaryTextChange);
 	});
 	QObject::connect(this, &SubtitleLine::secondaryTextChanged, [this](){
-		if(subtitle()) emit subtitle()->lineSecondaryTextChanged(this);
+		if(subtitle()) subtitle()->notifyLineChanged(this, Subtitle::SecondaryTextChange);
 	});
 	QObject::connect(this, &SubtitleLine::showTimeChanged, [this](){
-		if(subtitle()) emit subtitle()->lineShowTimeChanged(this);
+		if(subtitle()) subtitle()->notifyLineChanged(this, Subtitle::ShowTimeChange);
 	});
 	QObject::connect(this, &SubtitleLine::hideTimeChanged, [this](){
-		if(subtitle()) emit subtitle()->lineHideTimeChanged(this);
+		if(subtitle()) subtitle()->notifyLineChanged(this, Subtitle::HideTimeChange);
+	});
+	QObject::connect(this, &SubtitleLine::errorFlagsChanged, [this](){
+		if(subtitle()) emit subtitle()->lineErrorFlagsChanged(this);
+	});
+	QObject::connect(this, &SubtitleLine::positionChanged, [this](){
+		if(subtitle()) emit subtitle()->linePositionChanged(this);
+	});
+	QObject::connect(this, &SubtitleLine::metaChanged, [this](){
+		if(subtitle()) emit subtitle()->lineMetaChanged(this);
 	});
 }
 
 SubtitleLine::SubtitleLine()
 	: QObject(),
 	  m_subtitle(nullptr),
-	  m_primaryDoc(new RichDocument(this)),
-	  m_secondaryDoc(new RichDocument(this)),
+	  m_primaryDoc(nullptr),
+	  m_secondaryDoc(nullptr),
 	  m_showTime(0.0),
 	  m_hideTime(0.0),
 	  m_errorFlags(0),
@@ -156,8 +182,8 @@ SubtitleLine::SubtitleLine()
 SubtitleLine::SubtitleLine(const Time &showTime, const Time &hideTime)
 	: QObject(),
 	  m_subtitle(nullptr),
-	  m_primaryDoc(new RichDocument(this)),
-	  m_secondaryDoc(new RichDocument(this)),
+	  m_primaryDoc(nullptr),
+	  m_secondaryDoc(nullptr),
 	  m_showTime(showTime),
 	  m_hideTime(hideTime),
 	  m_errorFlags(0),
@@ -194,6 +220,7 @@ SubtitleLine::SubtitleLine(const Time &showTime, const Time &hideTime)
 
 SubtitleLine::~SubtitleLine()
 {
+	docCacheUnlink();
 	delete m_formatData;
 }
 
@@ -209,6 +236,7 @@ SubtitleLine::setFormatData(const FormatData *formatData)
 	delete m_formatData;
 
 	m_formatData = formatData ? new FormatData(*formatData) : NULL;
+	invalidateSnapshot();
 }
 
 int
@@ -220,82 +248,270 @@ SubtitleLine::number() const
 int
 SubtitleLine::index() const
 {
-	if(!m_subtitle)
-		return -1;
+	return m_subtitle ? m_subtitle->m_lines.indexOf(this) : -1;
+}
 
-	Q_ASSERT(m_ref != nullptr);
-	Q_ASSERT(m_ref->m_obj == this);
+RichDocument *
+SubtitleLine::doc(bool primary) const
+{
+	RichDocument *&doc = primary ? m_primaryDoc : m_secondaryDoc;
+	if(!doc) {
+		SubtitleLine *self = const_cast<SubtitleLine *>(this);
+		doc = new RichDocument(self);
+		doc->setRichText(primary ? m_primaryText : m_secondaryText, true);
+		doc->setStylesheet(m_subtitle ? m_subtitle->m_stylesheet : nullptr);
+		self->connectDoc(primary);
+	}
+	docCacheTouch();
+	return doc;
+}
 
-	const int index = m_ref - m_subtitle->m_lines.constData();
+RichString
+SubtitleLine::text(bool primary) const
+{
+	return storedText(primary);
+}
 
-	if(index < 0 || index >= m_subtitle->count()) {
-		// this should never happen... unless ObjectRef is declared as Q_MOVABLE_TYPE or QVector
-		// decides to stop calling constructors
-		qWarning() << "SubtitleLine::index() WARNING: m_ref doesn't not belong to cotainer.";
-		for(int i = 0, n = m_subtitle->count(); i < n; i++) {
-			if(this == m_subtitle->at(i)) {
-				m_ref = &m_subtitle->m_lines[i];
-				return i;
-			}
-		}
-		qWarning() << "SubtitleLine::index() WARNING: container doesn't contain the line.";
-		return -1;
+QString
+SubtitleLine::plainText(bool primary) const
+{
+	return storedText(primary);
+}
+
+const SubtitleLine::TextStats &
+SubtitleLine::textStats(bool primary) const
+{
+	TextStats &stats = primary ? m_primaryStats : m_secondaryStats;
+	if(stats.valid)
+		return stats;
+
+	const QString text = plainText(primary);
+	stats.hash = qHash(text);
+
+	const QString simplified = text.simplified();
+	stats.characters = simplified.length();
+	stats.words = simplified.isEmpty() ? 0 : simplified.count(QChar::Space) + 1;
+
+	QString lines = text;
+	RichString::simplifyWhiteSpace(lines);
+	if(lines.isEmpty()) {
+		stats.lines = stats.durationCharacters = stats.durationWords = 0;
+	} else {
+		stats.lines = lines.count(QChar::LineFeed) + 1;
+		stats.durationCharacters = lines.length();
+		stats.durationWords = lines.count(QChar::Space) + stats.lines;
 	}
 
-	return index;
+	stats.valid = true;
+	return stats;
 }
 
 void
-SubtitleLine::primaryDocumentChanged()
+SubtitleLine::setText(bool primary, const RichString &text)
 {
-	if(m_ignoreDocChanges || (m_subtitle && m_subtitle->m_ignoreDocChanges))
+	if(RichDocument *doc = primary ? m_primaryDoc : m_secondaryDoc) {
+		// document change will create the undo action
+		doc->setRichText(text);
+		return;
+	}
+	if(m_subtitle && m_subtitle == appSubtitle()) {
+		if(primary)
+			processAction(new SetLinePrimaryTextAction(this, m_primaryText, text, nullptr));
+		else
+			processAction(new SetLineSecondaryTextAction(this, m_secondaryText, text, nullptr));
 		return;
-	processAction(new SetLinePrimaryTextAction(this, m_primaryDoc));
+	}
+	// changes outside of app subtitle are not undoable - just store the text
+	applyText(primary, text);
+	if(primary)
+		emit primaryTextChanged();
+	else
+		emit secondaryTextChanged();
 }
 
 void
-SubtitleLine::secondaryDocumentChanged()
+SubtitleLine::applyText(bool primary, const RichString &text)
 {
-	if(m_ignoreDocChanges || (m_subtitle && m_subtitle->m_ignoreDocChanges))
+	if(RichDocument *doc = primary ? m_primaryDoc : m_secondaryDoc) {
+		// history of the document doesn't match the text anymore, store is synced by document change
+		const bool prev = ignoreDocChanges(true);
+		doc->setRichText(text, true);
+		ignoreDocChanges(prev);
 		return;
-	processAction(new SetLineSecondaryTextAction(this, m_secondaryDoc));
+	}
+	(primary ? m_primaryText : m_secondaryText) = text;
+	invalidateTextStats(primary);
+	invalidateSnapshot();
 }
 
 void
-SubtitleLine::setPrimaryDoc(RichDocument *doc)
+SubtitleLine::resetText(bool primary, const RichString &text)
 {
-	if(m_primaryDoc == doc)
-		return;
-	if(m_primaryDoc) {
-		disconnect(m_primaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::primaryDocumentChanged);
-		m_primaryDoc->setStylesheet(nullptr);
+	RichDocument *&doc = primary ? m_primaryDoc : m_secondaryDoc;
+	if(doc && !releaseDoc(primary)) {
+		// document is still shown by some view, leave it to it
+		disconnectDoc(primary);
+		doc = nullptr;
 	}
-	m_primaryDoc = doc;
-	m_primaryDoc->setParent(this);
-	m_primaryDoc->setStylesheet(m_subtitle ? m_subtitle->m_stylesheet : nullptr);
-	connect(m_primaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::primaryDocumentChanged);
+	(primary ? m_primaryText : m_secondaryText) = text;
+	invalidateTextStats(primary);
+	invalidateSnapshot();
+	if(!m_primaryDoc && !m_secondaryDoc)
+		docCacheUnlink();
+}
+
+void
+SubtitleLine::swapTexts()
+{
+	disconnectDoc(true);
+	disconnectDoc(false);
+	qSwap(m_primaryDoc, m_secondaryDoc);
+	qSwap(m_primaryText, m_secondaryText);
+	qSwap(m_primaryStats, m_secondaryStats);
+	invalidateSnapshot();
+	connectDoc(true);
+	connectDoc(false);
+}
+
+void
+SubtitleLine::connectDoc(bool primary)
+{
+	if(primary) {
+		if(m_primaryDoc)
+			connect(m_primaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::primaryDocumentChanged);
+	} else {
+		if(m_secondaryDoc)
+			connect(m_secondaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::secondaryDocumentChanged);
+	}
+}
+
+void
+SubtitleLine::disconnectDoc(bool primary)
+{
+	if(primary) {
+		if(m_primaryDoc)
+			disconnect(m_primaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::primaryDocumentChanged);
+	} else {
+		if(m_secondaryDoc)
+			disconnect(m_secondaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::secondaryDocumentChanged);
+	}
+}
+
+bool
+SubtitleLine::releaseDoc(bool primary) const
+{
+	RichDocument *&doc = primary ? m_primaryDoc : m_secondaryDoc;
+	if(!doc)
+		return true;
+	// undo actions that used the document fall back to stored texts
+	if(doc->hasViews())
+		return false;
+	delete doc;
+	doc = nullptr;
+	return true;
+}
+
+/// DOCUMENT CACHE
+/// ==============
+/// Recently used lines that have RichDocument created are kept in a LRU list. When the list
+/// grows over s_docCacheSize, documents of least recently used lines are released. Documents
+/// are created only for views, so the cache is used from the main thread only.
+
+int
+SubtitleLine::documentCacheSize()
+{
+	return s_docCacheSize;
+}
+
+void
+SubtitleLine::setDocumentCacheSize(int lineCount)
+{
+	s_docCacheSize = qMax(1, lineCount);
+	docCacheEvict(nullptr);
 }
 
 void
-SubtitleLine::setSecondaryDoc(RichDocument *doc)
+SubtitleLine::docCacheUnlink() const
 {
-	if(m_secondaryDoc == doc)
+	if(!m_docCached)
 		return;
-	if(m_secondaryDoc) {
-		disconnect(m_secondaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::secondaryDocumentChanged);
-		m_secondaryDoc->setStylesheet(nullptr);
+	Q_ASSERT(QThread::currentThread() == qApp->thread());
+
+	if(m_docCachePrev)
+		m_docCachePrev->m_docCacheNext = m_docCacheNext;
+	else
+		s_docCacheHead = m_docCacheNext;
+	if(m_docCacheNext)
+		m_docCacheNext->m_docCachePrev = m_docCachePrev;
+	else
+		s_docCacheTail = m_docCachePrev;
+
+	m_docCachePrev = nullptr;
+	m_docCacheNext = nullptr;
+	m_docCached = false;
+	s_docCacheCount--;
+}
+
+void
+SubtitleLine::docCacheTouch() const
+{
+	Q_ASSERT(QThread::currentThread() == qApp->thread());
+	if(s_docCacheHead == this)
+		return;
+
+	docCacheUnlink();
+
+	m_docCacheNext = s_docCacheHead;
+	if(s_docCacheHead)
+		s_docCacheHead->m_docCachePrev = this;
+	else
+		s_docCacheTail = this;
+	s_docCacheHead = this;
+	m_docCached = true;
+
+	if(++s_docCacheCount > s_docCacheSize)
+		docCacheEvict(this);
+}
+
+void
+SubtitleLine::docCacheEvict(const SubtitleLine *keep)
+{
+	const SubtitleLine *line = s_docCacheTail;
+	while(line && s_docCacheCount > s_docCacheSize) {
+		const SubtitleLine *prev = line->m_docCachePrev;
+		if(line != keep) {
+			// documents shown in some view are kept, they are released once they fall out again
+			const bool primaryReleased = line->releaseDoc(true);
+			const bool secondaryReleased = line->releaseDoc(false);
+			if(primaryReleased && secondaryReleased)
+				line->docCacheUnlink();
+		}
+		line = prev;
 	}
-	m_secondaryDoc = doc;
-	m_secondaryDoc->setParent(this);
-	m_secondaryDoc->setStylesheet(m_subtitle ? m_subtitle->m_stylesheet : nullptr);
-	connect(m_secondaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::secondaryDocumentChanged);
 }
 
 void
-SubtitleLine::setTexts(RichDocument *pText, RichDocument *sText)
+SubtitleLine::primaryDocumentChanged()
+{
+	const RichString prevText = m_primaryText;
+	m_primaryText = m_primaryDoc->toRichText();
+	invalidateTextStats(true);
+	invalidateSnapshot();
+	if(m_ignoreDocChanges || (m_subtitle && m_subtitle->m_ignoreDocChanges))
+		return;
+	processAction(new SetLinePrimaryTextAction(this, prevText, m_primaryText, m_primaryDoc));
+}
+
+void
+SubtitleLine::secondaryDocumentChanged()
 {
-	setPrimaryDoc(pText);
-	setSecondaryDoc(sText);
+	const RichString prevText = m_secondaryText;
+	m_secondaryText = m_secondaryDoc->toRichText();
+	invalidateTextStats(false);
+	invalidateSnapshot();
+	if(m_ignoreDocChanges || (m_subtitle && m_subtitle->m_ignoreDocChanges))
+		return;
+	processAction(new SetLineSecondaryTextAction(this, prevText, m_secondaryText, m_secondaryDoc));
 }
 
 void
@@ -303,14 +519,14 @@ SubtitleLine::breakText(int minBreakLength, SubtitleTarget target)
 {
 	switch(target) {
 	case Primary:
-		m_primaryDoc->breakText(minBreakLength);
+		primaryDoc()->breakText(minBreakLength);
 		break;
 	case Secondary:
-		m_secondaryDoc->breakText(minBreakLength);
+		secondaryDoc()->breakText(minBreakLength);
 		break;
 	case Both:
-		m_primaryDoc->breakText(minBreakLength);
-		m_secondaryDoc->breakText(minBreakLength);
+		primaryDoc()->breakText(minBreakLength);
+		secondaryDoc()->breakText(minBreakLength);
 		break;
 	default:
 		break;
@@ -322,14 +538,14 @@ SubtitleLine::unbreakText(SubtitleTarget target)
 {
 	switch(target) {
 	case Primary:
-		m_primaryDoc->joinLines();
+		primaryDoc()->joinLines();
 		break;
 	case Secondary:
-		m_secondaryDoc->joinLines();
+		secondaryDoc()->joinLines();
 		break;
 	case Both:
-		m_primaryDoc->joinLines();
-		m_secondaryDoc->joinLines();
+		primaryDoc()->joinLines();
+		secondaryDoc()->joinLines();
 		break;
 	default:
 		break;
@@ -341,14 +557,14 @@ SubtitleLine::simplifyTextWhiteSpace(SubtitleTarget target)
 {
 	switch(target) {
 	case Primary:
-		m_primaryDoc->cleanupSpaces();
+		primaryDoc()->cleanupSpaces();
 		break;
 	case Secondary:
-		m_secondaryDoc->cleanupSpaces();
+		secondaryDoc()->cleanupSpaces();
 		break;
 	case Both:
-		m_primaryDoc->cleanupSpaces();
-		m_secondaryDoc->cleanupSpaces();
+		primaryDoc()->cleanupSpaces();
+		secondaryDoc()->cleanupSpaces();
 		break;
 	default:
 		break;
@@ -414,7 +630,7 @@ SubtitleLine::setHideTime(const Time &hideTime)
 QColor
 SubtitleLine::durationColor(const QColor &textColor, bool usePrimary)
 {
-	const int textLen = (usePrimary ? primaryDoc() : secondaryDoc())->length();
+	const int textLen = storedText(usePrimary).length();
 	const int minD = textLen * SCConfig::minDurationPerCharacter();
 	const int maxD = textLen * SCConfig::maxDurationPerCharacter();
 	const int avgD = textLen * SCConfig::idealDurationPerCharacter();
@@ -463,43 +679,37 @@ SubtitleLine::setTimes(const Time &showTime, const Time &hideTime)
 int
 SubtitleLine::primaryCharacters() const
 {
-	return m_primaryDoc->toPlainText().simplified().length();
+	return textStats(true).characters;
 }
 
 int
 SubtitleLine::primaryWords() const
 {
-	QString text(m_primaryDoc->toPlainText().simplified());
-	return text.length() ? text.count(' ') + 1 : 0;
+	return textStats(true).words;
 }
 
 int
 SubtitleLine::primaryLines() const
 {
-	RichString text(m_primaryDoc->toPlainText());
-	text.simplifyWhiteSpace();
-	return text.isEmpty() ? 0 : text.count('\n') + 1;
+	return textStats(true).lines;
 }
 
 int
 SubtitleLine::secondaryCharacters() const
 {
-	return m_secondaryDoc->toPlainText().simplified().length();
+	return textStats(false).characters;
 }
 
 int
 SubtitleLine::secondaryWords() const
 {
-	QString text(m_secondaryDoc->toPlainText().simplified());
-	return text.length() ? text.count(' ') + 1 : 0;
+	return textStats(false).words;
 }
 
 int
 SubtitleLine::secondaryLines() const
 {
-	RichString text(m_secondaryDoc->toPlainText());
-	text.simplifyWhiteSpace();
-	return text.isEmpty() ? 0 : text.count('\n') + 1;
+	return textStats(false).lines;
 }
 
 Time
@@ -524,17 +734,26 @@ SubtitleLine::autoDuration(const QString &t, int msecsPerChar, int msecsPerWord,
 Time
 SubtitleLine::autoDuration(int msecsPerChar, int msecsPerWord, int msecsPerLine, SubtitleTarget calculationTarget)
 {
+	Q_ASSERT(msecsPerChar >= 0);
+	Q_ASSERT(msecsPerWord >= 0);
+	Q_ASSERT(msecsPerLine >= 0);
+
+	const auto duration = [&](bool primary){
+		const TextStats &stats = textStats(primary);
+		return Time(stats.durationCharacters * msecsPerChar + stats.durationWords * msecsPerWord + stats.lines * msecsPerLine);
+	};
+
 	switch(calculationTarget) {
 	case Secondary:
-		return autoDuration(m_secondaryDoc->toPlainText(), msecsPerChar, msecsPerWord, msecsPerLine);
+		return duration(false);
 	case Both: {
-		Time primary = autoDuration(m_primaryDoc->toPlainText(), msecsPerChar, msecsPerWord, msecsPerLine);
-		Time secondary = autoDuration(m_secondaryDoc->toPlainText(), msecsPerChar, msecsPerWord, msecsPerLine);
+		Time primary = duration(true);
+		Time secondary = duration(false);
 		return primary > secondary ? primary : secondary;
 	}
 	case Primary:
 	default:
-		return autoDuration(m_primaryDoc->toPlainText(), msecsPerChar, msecsPerWord, msecsPerLine);
+		return duration(true);
 	}
 }
 
@@ -564,6 +783,34 @@ SubtitleLine::setPosition(const SubtitleRect &pos)
 	emit positionChanged();
 }
 
+void
+SubtitleLine::invalidateSnapshot() const
+{
+	m_snapshot.reset();
+}
+
+LineSnapshot
+SubtitleLine::snapshot() const
+{
+	// texts and format data reset the snapshot when they change, the rest is cheap to compare
+	if(m_snapshot && m_snapshot->showTime == m_showTime && m_snapshot->hideTime == m_hideTime
+			&& m_snapshot->errorFlags == m_errorFlags && m_snapshot->position == m_position
+			&& m_snapshot->metaData.isSharedWith(m_metaData))
+		return LineSnapshot(m_snapshot.data());
+
+	LineSnapshotData *data = new LineSnapshotData();
+	data->showTime = m_showTime;
+	data->hideTime = m_hideTime;
+	data->primaryText = storedText(true);
+	data->secondaryText = storedText(false);
+	data->errorFlags = m_errorFlags;
+	data->position = m_position;
+	data->metaData = m_metaData;
+	data->formatData = m_formatData ? new FormatData(*m_formatData) : nullptr;
+	m_snapshot = data;
+	return LineSnapshot(data);
+}
+
 /// ERRORS
 
 int
@@ -594,7 +841,7 @@ SubtitleLine::setErrorFlags(int errorFlags, bool value)
 bool
 SubtitleLine::checkEmptyPrimaryText(bool update)
 {
-	bool error = m_primaryDoc->isEmpty() || m_primaryDoc->toPlainText().trimmed().isEmpty();
+	bool error = plainText(true).trimmed().isEmpty();
 
 	if(update)
 		setErrorFlags(EmptyPrimaryText, error);
@@ -605,7 +852,7 @@ SubtitleLine::checkEmptyPrimaryText(bool update)
 bool
 SubtitleLine::checkEmptySecondaryText(bool update)
 {
-	bool error = m_secondaryDoc->isEmpty() || m_secondaryDoc->toPlainText().trimmed().isEmpty();
+	bool error = plainText(false).trimmed().isEmpty();
 
 	if(update)
 		setErrorFlags(EmptySecondaryText, error);
@@ -616,7 +863,7 @@ SubtitleLine::checkEmptySecondaryText(bool update)
 bool
 SubtitleLine::checkUntranslatedText(bool update)
 {
-	bool error = m_primaryDoc->toPlainText() == m_secondaryDoc->toPlainText();
+	bool error = textStats(true).hash == textStats(false).hash && plainText(true) == plainText(false);
 
 	if(update)
 		setErrorFlags(UntranslatedText, error);
@@ -775,7 +1022,7 @@ SubtitleLine::checkPrimaryUnneededSpaces(bool update)
 {
 	static const QRegularExpression unneededSpaceRegExp("(^\\s|\\s$|¿\\s|¡\\s|\\s\\s|\\s!|\\s\\?|\\s:|\\s;|\\s,|\\s\\.)");
 
-	bool error = m_primaryDoc->indexOf(unneededSpaceRegExp) != -1;
+	bool error = containsInAnyLine(plainText(true), unneededSpaceRegExp);
 
 	if(update)
 		setErrorFlags(PrimaryUnneededSpaces, error);
@@ -788,7 +1035,7 @@ SubtitleLine::checkSecondaryUnneededSpaces(bool update)
 {
 	static const QRegularExpression unneededSpaceRegExp("(^\\s|\\s$|¿\\s|¡\\s|\\s\\s|\\s!|\\s\\?|\\s:|\\s;|\\s,|\\s\\.)");
 
-	bool error = m_secondaryDoc->indexOf(unneededSpaceRegExp) != -1;
+	bool error = containsInAnyLine(plainText(false), unneededSpaceRegExp);
 
 	if(update)
 		setErrorFlags(SecondaryUnneededSpaces, error);
@@ -801,7 +1048,7 @@ SubtitleLine::checkPrimaryCapitalAfterEllipsis(bool update)
 {
 	staticRE$(capitalAfterEllipsisRegExp, "^\\s*\\.\\.\\.[¡¿\\.,;\\(\\[\\{\"'\\s]*", REu);
 
-	const QString text = m_primaryDoc->toPlainText();
+	const QString text = plainText(true);
 	QRegularExpressionMatchIterator it = capitalAfterEllipsisRegExp.globalMatch(text);
 	bool success = it.hasNext();
 	if(success) {
@@ -820,7 +1067,7 @@ SubtitleLine::checkSecondaryCapitalAfterEllipsis(bool update)
 {
 	staticRE$(capitalAfterEllipsisRegExp, "^\\s*\\.\\.\\.[¡¿\\.,;\\(\\[\\{\"'\\s]*", REu);
 
-	const QString text = m_secondaryDoc->toPlainText();
+	const QString text = plainText(false);
 	QRegularExpressionMatchIterator it = capitalAfterEllipsisRegExp.globalMatch(text);
 	bool success = it.hasNext();
 	if(success) {
@@ -839,7 +1086,7 @@ SubtitleLine::checkPrimaryUnneededDash(bool update)
 {
 	staticRE$(unneededDashRegExp, "(^|\n)\\s*-[^-]", REu);
 
-	bool success = m_primaryDoc->toPlainText().count(unneededDashRegExp) == 1;
+	bool success = plainText(true).count(unneededDashRegExp) == 1;
 
 	if(update)
 		setErrorFlags(PrimaryUnneededDash, success);
@@ -852,7 +1099,7 @@ SubtitleLine::checkSecondaryUnneededDash(bool update)
 {
 	staticRE$(unneededDashRegExp, "(^|\n)\\s*-[^-]", REu);
 
-	bool success = m_secondaryDoc->toPlainText().count(unneededDashRegExp) == 1;
+	bool success = plainText(false).count(unneededDashRegExp) == 1;
 
 	if(update)
 		setErrorFlags(SecondaryUnneededDash, success);
@@ -961,9 +1208,3 @@ SubtitleLine::processAction(UndoAction *action)
 		delete action;
 	}
 }
-
-const QVector<ObjectRef<SubtitleLine>> *
-SubtitleLine::refContainer()
-{
-	return m_subtitle ? &m_subtitle->m_lines : nullptr;
-}
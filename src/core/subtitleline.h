@@ -10,8 +10,8 @@
 
 #include "core/time.h"
 #include "core/formatdata.h"
+#include "core/richstring.h"
 #include "core/subtitletarget.h"
-#include "helpers/objectref.h"
 
 #include <QExplicitlySharedDataPointer>
 #include <QObject>
@@ -24,6 +24,9 @@ class Subtitle;
 class RichString;
 class RichDocument;
 class UndoAction;
+struct LineListChunk;
+struct LineSnapshotData;
+class LineSnapshot;
 
 struct SubtitleRect {
 	// percentages from 0-100 relative to video frame, values are not bounded
@@ -35,6 +38,12 @@ struct SubtitleRect {
 	bool vertical = false;
 	enum { CENTER, START, END } hAlign = CENTER;
 	enum { BOTTOM, TOP } vAlign = BOTTOM;
+
+	inline bool operator==(const SubtitleRect &other) const {
+		return top == other.top && left == other.left && right == other.right && bottom == other.bottom
+			&& vertical == other.vertical && hAlign == other.hAlign && vAlign == other.vAlign;
+	}
+	inline bool operator!=(const SubtitleRect &other) const { return !operator==(other); }
 };
 
 class SubtitleLine : public QObject
@@ -51,11 +60,13 @@ class SubtitleLine : public QObject
 	friend class SetLineShowTimeAction;
 	friend class SetLineHideTimeAction;
 	friend class SetLineTimesAction;
+	friend class AdjustLinesTimesAction;
+	friend class SetLinesTimesAction;
 	friend class SetLineStyleFlagsAction;
 	friend class SetLineErrorsAction;
 	friend class ToggleLineMarkedAction;
 	friend class Format;
-	friend class ObjectRef<SubtitleLine>;
+	friend class LineList;
 
 public:
 	typedef enum {
@@ -144,9 +155,19 @@ public:
 	inline SubtitleLine * prevLine() const;
 	inline SubtitleLine * nextLine() const;
 
-	inline RichDocument * doc(bool primary) const { return primary ? m_primaryDoc : m_secondaryDoc; }
-	inline RichDocument * primaryDoc() const { return m_primaryDoc; }
-	inline RichDocument * secondaryDoc() const { return m_secondaryDoc; }
+	RichDocument * doc(bool primary) const;
+	inline RichDocument * primaryDoc() const { return doc(true); }
+	inline RichDocument * secondaryDoc() const { return doc(false); }
+
+	RichString text(bool primary) const;
+	inline RichString primaryText() const { return text(true); }
+	inline RichString secondaryText() const { return text(false); }
+	void setText(bool primary, const RichString &text);
+	inline void setPrimaryText(const RichString &text) { setText(true, text); }
+	inline void setSecondaryText(const RichString &text) { setText(false, text); }
+
+	static int documentCacheSize();
+	static void setDocumentCacheSize(int lineCount);
 
 	void breakText(int minBreakLength, SubtitleTarget target);
 	void unbreakText(SubtitleTarget target);
@@ -217,13 +238,15 @@ public:
 	int check(int errorFlagsToCheck, bool update = true);
 
 	inline bool metaExists(const QByteArray &key) const { return m_metaData.contains(key); }
-	inline int metaRemove(const QByteArray &key) { return m_metaData.remove(key); }
+	inline int metaRemove(const QByteArray &key) { const int n = m_metaData.remove(key); if(n) emit metaChanged(); return n; }
 	inline const QString meta(const QByteArray &key) const { return m_metaData.value(key); }
-	inline void meta(const QByteArray &key, const QString &value) { m_metaData.insert(key, value); }
+	inline void meta(const QByteArray &key, const QString &value) { m_metaData.insert(key, value); emit metaChanged(); }
 
 	inline const SubtitleRect & pos() const { return m_position; }
 	void setPosition(const SubtitleRect &pos);
 
+	LineSnapshot snapshot() const;
+
 signals:
 	void primaryTextChanged();
 	void secondaryTextChanged();
@@ -231,6 +254,7 @@ signals:
 	void hideTimeChanged(const Time &hideTime);
 	void errorFlagsChanged(int errorFlags);
 	void positionChanged();
+	void metaChanged();
 
 private:
 	FormatData * formatData() const;
@@ -239,12 +263,34 @@ private:
 	void processAction(UndoAction *action);
 	void processShowTimeSort(const Time &showTime);
 
-	void setPrimaryDoc(RichDocument *doc);
-	void setSecondaryDoc(RichDocument *doc);
-	void setTexts(RichDocument *pText, RichDocument *sText);
+	void applyText(bool primary, const RichString &text);
+	void resetText(bool primary, const RichString &text);
+	void swapTexts();
 	void primaryDocumentChanged();
 	void secondaryDocumentChanged();
 
+	inline const RichString & storedText(bool primary) const { return primary ? m_primaryText : m_secondaryText; }
+	QString plainText(bool primary) const;
+
+	struct TextStats {
+		int characters;         // length of simplified text
+		int words;
+		int lines;
+		int durationCharacters; // counts used by autoDuration()
+		int durationWords;
+		uint hash;              // hash of plain text
+		bool valid = false;
+	};
+	const TextStats & textStats(bool primary) const;
+	inline void invalidateTextStats(bool primary) const { (primary ? m_primaryStats : m_secondaryStats).valid = false; }
+	void invalidateSnapshot() const;
+	bool releaseDoc(bool primary) const;
+	void connectDoc(bool primary);
+	void disconnectDoc(bool primary);
+	void docCacheTouch() const;
+	void docCacheUnlink() const;
+	static void docCacheEvict(const SubtitleLine *keep);
+
 	void setupSignals();
 
 	inline bool ignoreDocChanges(bool ignore) {
@@ -255,8 +301,24 @@ private:
 
 private:
 	QExplicitlySharedDataPointer<Subtitle> m_subtitle;
-	RichDocument *m_primaryDoc;
-	RichDocument *m_secondaryDoc;
+
+	// texts are kept in RichString form, RichDocument is created only when something
+	// asks for it and is released again when it falls out of the document cache
+	RichString m_primaryText;
+	RichString m_secondaryText;
+	mutable RichDocument *m_primaryDoc;
+	mutable RichDocument *m_secondaryDoc;
+	mutable const SubtitleLine *m_docCachePrev = nullptr;
+	mutable const SubtitleLine *m_docCacheNext = nullptr;
+	mutable bool m_docCached = false;
+	mutable TextStats m_primaryStats;
+	mutable TextStats m_secondaryStats;
+
+	static const SubtitleLine *s_docCacheHead;
+	static const SubtitleLine *s_docCacheTail;
+	static int s_docCacheCount;
+	static int s_docCacheSize;
+
 	Time m_showTime;
 	Time m_hideTime;
 	int m_errorFlags;
@@ -268,8 +330,11 @@ private:
 
 	FormatData *m_formatData;
 
-	mutable ObjectRef<SubtitleLine> *m_ref = nullptr;
-	const QVector<ObjectRef<SubtitleLine>> * refContainer();
+	mutable LineListChunk *m_listChunk = nullptr;
+	mutable int m_listOffset = 0;
+
+	// last snapshot, reused while line data doesn't change
+	mutable QExplicitlySharedDataPointer<const LineSnapshotData> m_snapshot;
 };
 }
 
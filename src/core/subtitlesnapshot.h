@@ -0,0 +1,108 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SUBTITLESNAPSHOT_H
+#define SUBTITLESNAPSHOT_H
+
+#include "core/formatdata.h"
+#include "core/richstring.h"
+#include "core/subtitleline.h"
+#include "core/time.h"
+
+#include <QExplicitlySharedDataPointer>
+#include <QMap>
+#include <QMetaType>
+#include <QSharedData>
+#include <QVector>
+
+namespace SubtitleComposer {
+
+struct LineSnapshotData : public QSharedData
+{
+	~LineSnapshotData() { delete formatData; }
+
+	Time showTime;
+	Time hideTime;
+	RichString primaryText;
+	RichString secondaryText;
+	int errorFlags = 0;
+	SubtitleRect position;
+	QMap<QByteArray, QString> metaData;
+	const FormatData *formatData = nullptr;
+};
+
+// Immutable copy of subtitle line data. Snapshots are implicitly shared and never change
+// once created, so they can be passed to and read from other threads.
+class LineSnapshot
+{
+	friend class SubtitleLine;
+
+public:
+	LineSnapshot() {}
+
+	inline bool isNull() const { return !d; }
+	inline bool isSharedWith(const LineSnapshot &other) const { return d == other.d; }
+
+	inline const Time & showTime() const { return d->showTime; }
+	inline const Time & hideTime() const { return d->hideTime; }
+	inline Time durationTime() const { return d->hideTime - d->showTime; }
+
+	inline const RichString & primaryText() const { return d->primaryText; }
+	inline const RichString & secondaryText() const { return d->secondaryText; }
+	inline const RichString & text(bool primary) const { return primary ? d->primaryText : d->secondaryText; }
+
+	inline int errorFlags() const { return d->errorFlags; }
+	inline const SubtitleRect & pos() const { return d->position; }
+	inline const QString meta(const QByteArray &key) const { return d->metaData.value(key); }
+	inline const QMap<QByteArray, QString> & metaData() const { return d->metaData; }
+	inline const FormatData * formatData() const { return d->formatData; }
+
+private:
+	LineSnapshot(const LineSnapshotData *data) : d(data) {}
+
+	QExplicitlySharedDataPointer<const LineSnapshotData> d;
+};
+
+struct SubtitleSnapshotData : public QSharedData
+{
+	~SubtitleSnapshotData() { delete formatData; }
+
+	QVector<LineSnapshot> lines;
+	double framesPerSecond = 0.;
+	QMap<QByteArray, QString> metaData;
+	const FormatData *formatData = nullptr;
+};
+
+// Immutable copy of the whole subtitle. Taking a snapshot only copies line data that changed
+// since the previous snapshot, unchanged lines share data with earlier snapshots.
+class SubtitleSnapshot
+{
+	friend class Subtitle;
+
+public:
+	SubtitleSnapshot() {}
+
+	inline bool isNull() const { return !d; }
+
+	inline int count() const { return d ? d->lines.size() : 0; }
+	inline bool isEmpty() const { return count() == 0; }
+	inline const LineSnapshot & at(int index) const { return d->lines.at(index); }
+	inline const QVector<LineSnapshot> & lines() const { return d->lines; }
+
+	inline double framesPerSecond() const { return d->framesPerSecond; }
+	inline const QString meta(const QByteArray &key) const { return d->metaData.value(key); }
+	inline const QMap<QByteArray, QString> & metaData() const { return d->metaData; }
+	inline const FormatData * formatData() const { return d->formatData; }
+
+private:
+	QExplicitlySharedDataPointer<const SubtitleSnapshotData> d;
+};
+}
+
+Q_DECLARE_TYPEINFO(SubtitleComposer::LineSnapshot, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(SubtitleComposer::SubtitleSnapshot)
+
+#endif // SUBTITLESNAPSHOT_H
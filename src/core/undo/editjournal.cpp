@@ -0,0 +1,588 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "editjournal.h"
+
+#include "core/rangelist.h"
+#include "core/richtext/richcss.h"
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+#include "core/subtitlesnapshot.h"
+#include "core/undo/subtitleactions.h"
+#include "core/undo/subtitlelineactions.h"
+#include "formats/formatmanager.h"
+#include "formats/project/projectfile.h"
+#include "formats/project/projectinputformat.h"
+#include "helpers/common.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace SubtitleComposer;
+
+static const char s_magic[8] = { 'S', 'C', 'J', 'R', 'N', 'L', '\r', '\n' };
+
+enum { HeaderSize = 16, RecordHeaderSize = 5 };
+
+static QString
+sessionDirectory()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + $("/sessions");
+}
+
+static inline QString
+journalPath(const QString &path)
+{
+	return path + $(".journal");
+}
+
+static inline QString
+snapshotPath(const QString &path, quint32 generation)
+{
+	return path + QChar('.') + QString::number(generation) + $(".scproj");
+}
+
+static inline QString
+lockPath(const QString &path)
+{
+	return path + $(".lock");
+}
+
+static void
+initStream(QDataStream &stream)
+{
+	stream.setVersion(QDataStream::Qt_5_6);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+// same thing processAction() does for subtitles that are not undoable
+static inline void
+runAction(UndoAction *action)
+{
+	action->redo();
+	delete action;
+}
+
+EditJournal::EditJournal(QObject *parent)
+	: QObject(parent),
+	  m_lock(nullptr),
+	  m_generation(0),
+	  m_info{QUrl(), QString(), false, QUrl(), QString()},
+	  m_buffer(&m_pending),
+	  m_recordStart(0),
+	  m_framesPerSecondDirty(false),
+	  m_stylesheetDirty(false),
+	  m_dirtyStateDirty(false)
+{
+	m_buffer.open(QIODevice::WriteOnly);
+	m_stream.setDevice(&m_buffer);
+	initStream(m_stream);
+}
+
+EditJournal::~EditJournal()
+{
+	close(false);
+}
+
+QString
+EditJournal::newSessionPath()
+{
+	return sessionDirectory() + QChar('/')
+		+ QString::number(QDateTime::currentMSecsSinceEpoch(), 16) + QChar('-')
+		+ QString::number(QCoreApplication::applicationPid());
+}
+
+QStringList
+EditJournal::orphanedSessions()
+{
+	QStringList sessions;
+	const QDir dir(sessionDirectory());
+	const QStringList journals = dir.entryList(QStringList($("*.journal")), QDir::Files, QDir::Name);
+	for(const QString &journal : journals) {
+		const QString path = dir.filePath(journal.left(journal.size() - 8));
+		// lock of a crashed instance is stale and can be taken over, age of the lock file doesn't
+		// matter - locks of running instances are as old as their sessions
+		QLockFile lock(lockPath(path));
+		lock.setStaleLockTime(0);
+		if(lock.tryLock(0)) {
+			lock.unlock();
+			sessions.append(path);
+		}
+	}
+	return sessions;
+}
+
+void
+EditJournal::removeSession(const QString &path)
+{
+	const QFileInfo fi(path);
+	const QStringList files = fi.dir().entryList(QStringList(fi.fileName() + $(".*")), QDir::Files);
+	for(const QString &file : files) {
+		if(file != fi.fileName() + $(".lock"))
+			QFile::remove(fi.dir().filePath(file));
+	}
+}
+
+bool
+EditJournal::open(const QString &path, Subtitle *subtitle)
+{
+	close();
+
+	QDir().mkpath(QFileInfo(path).absolutePath());
+	m_lock = new QLockFile(lockPath(path));
+	m_lock->setStaleLockTime(0);
+	if(!m_lock->tryLock(0)) {
+		qWarning() << "EditJournal: session" << path << "is locked";
+		delete m_lock;
+		m_lock = nullptr;
+		return false;
+	}
+
+	m_path = path;
+	m_subtitle = subtitle;
+	m_generation = 0;
+	if(!compact())
+		return false;
+
+	connect(subtitle, &Subtitle::linesInserted, this, [this](int firstIndex, int lastIndex){
+		writeRange(RecordInsertLines, firstIndex, lastIndex);
+		markLines(firstIndex, lastIndex);
+	});
+	connect(subtitle, &Subtitle::linesAboutToBeRemoved, this, [this](int firstIndex, int lastIndex){
+		for(int i = firstIndex; i <= lastIndex; i++)
+			m_dirtyLines.remove(m_subtitle->at(i));
+		writeRange(RecordRemoveLines, firstIndex, lastIndex);
+	});
+	connect(subtitle, &Subtitle::linesReordered, this, QOverload<int, int>::of(&EditJournal::markLines));
+	connect(subtitle, &Subtitle::framesPerSecondChanged, this, [this](){ m_framesPerSecondDirty = true; });
+	connect(subtitle->stylesheet(), &RichCSS::changed, this, [this](){ m_stylesheetDirty = true; });
+	connect(subtitle, &Subtitle::primaryDirtyStateChanged, this, [this](){ m_dirtyStateDirty = true; });
+	connect(subtitle, &Subtitle::secondaryDirtyStateChanged, this, [this](){ m_dirtyStateDirty = true; });
+	connect(subtitle, &Subtitle::lineAnchorChanged, this, &EditJournal::markLine);
+
+	connect(subtitle, &Subtitle::linePrimaryTextChanged, this, &EditJournal::markLine);
+	connect(subtitle, &Subtitle::lineSecondaryTextChanged, this, &EditJournal::markLine);
+	connect(subtitle, &Subtitle::lineShowTimeChanged, this, &EditJournal::markLine);
+	connect(subtitle, &Subtitle::lineHideTimeChanged, this, &EditJournal::markLine);
+	connect(subtitle, &Subtitle::lineErrorFlagsChanged, this, &EditJournal::markLine);
+	connect(subtitle, &Subtitle::linePositionChanged, this, &EditJournal::markLine);
+	connect(subtitle, &Subtitle::lineMetaChanged, this, &EditJournal::markLine);
+	connect(subtitle, &Subtitle::linesPrimaryTextChanged, this, QOverload<const RangeList &>::of(&EditJournal::markLines));
+	connect(subtitle, &Subtitle::linesSecondaryTextChanged, this, QOverload<const RangeList &>::of(&EditJournal::markLines));
+	connect(subtitle, &Subtitle::linesTimesChanged, this, QOverload<const RangeList &>::of(&EditJournal::markLines));
+
+	return true;
+}
+
+void
+EditJournal::close(bool removeFiles)
+{
+	if(m_subtitle) {
+		disconnect(m_subtitle.data(), nullptr, this, nullptr);
+		disconnect(m_subtitle->stylesheet(), nullptr, this, nullptr);
+	}
+	m_subtitle = nullptr;
+	m_file.close();
+
+	if(removeFiles && !m_path.isEmpty())
+		removeSession(m_path);
+	m_path.clear();
+
+	delete m_lock;
+	m_lock = nullptr;
+
+	resetPending();
+}
+
+void
+EditJournal::setInfo(const Info &info)
+{
+	m_info = info;
+	if(!isOpen())
+		return;
+	writeInfo();
+	commit();
+}
+
+void
+EditJournal::beginRecord(RecordType type)
+{
+	m_recordStart = m_pending.size();
+	m_stream << quint32(0) << quint8(type);
+}
+
+void
+EditJournal::endRecord()
+{
+	const quint32 size = m_pending.size() - m_recordStart - RecordHeaderSize;
+	qToLittleEndian<quint32>(size, reinterpret_cast<uchar *>(m_pending.data() + m_recordStart));
+}
+
+void
+EditJournal::writeRange(RecordType type, int firstIndex, int lastIndex)
+{
+	beginRecord(type);
+	m_stream << qint32(firstIndex) << qint32(lastIndex);
+	endRecord();
+}
+
+void
+EditJournal::writeInfo()
+{
+	beginRecord(RecordInfo);
+	m_stream << m_info.url << m_info.format << m_info.translationMode << m_info.translationUrl << m_info.translationFormat;
+	endRecord();
+}
+
+void
+EditJournal::writeDirty()
+{
+	beginRecord(RecordDirty);
+	m_stream << quint8(m_subtitle->isPrimaryDirty()) << quint8(m_subtitle->isSecondaryDirty());
+	endRecord();
+}
+
+void
+EditJournal::writeLine(const SubtitleLine *line, int index)
+{
+	const LineSnapshot snapshot = line->snapshot();
+	const SubtitleRect &pos = snapshot.pos();
+	beginRecord(RecordLine);
+	m_stream << qint32(index) << line->showTime().toMillis() << line->hideTime().toMillis()
+		<< quint32(line->errorFlags()) << quint8(m_subtitle->isLineAnchored(line))
+		<< double(pos.top) << double(pos.left) << double(pos.right) << double(pos.bottom)
+		<< quint8(pos.vertical) << quint8(pos.hAlign) << quint8(pos.vAlign);
+	line->primaryText().writeStyled(m_stream);
+	line->secondaryText().writeStyled(m_stream);
+	ProjectFile::writeLineData(m_stream, snapshot);
+	endRecord();
+}
+
+bool
+EditJournal::writePending(QIODevice *device)
+{
+	const bool res = device->write(m_pending) == m_pending.size();
+	resetPending();
+	return res;
+}
+
+void
+EditJournal::resetPending()
+{
+	m_pending.resize(0);
+	m_buffer.seek(0);
+	m_dirtyLines.clear();
+	m_framesPerSecondDirty = false;
+	m_stylesheetDirty = false;
+	m_dirtyStateDirty = false;
+}
+
+void
+EditJournal::markLines(const RangeList &ranges)
+{
+	for(int i = 0, n = ranges.rangesCount(); i < n; i++) {
+		const Range range = ranges.range(i);
+		markLines(range.start(), range.end());
+	}
+}
+
+void
+EditJournal::markLines(int firstIndex, int lastIndex)
+{
+	lastIndex = qMin(lastIndex, m_subtitle->lastIndex());
+	for(int i = firstIndex; i <= lastIndex; i++)
+		m_dirtyLines.insert(m_subtitle->at(i));
+}
+
+void
+EditJournal::markLine(const SubtitleLine *line)
+{
+	// anchor signals are emitted also for lines that were removed from subtitle
+	if(line->subtitle() == m_subtitle)
+		m_dirtyLines.insert(line);
+}
+
+void
+EditJournal::fail(const QString &reason)
+{
+	qWarning() << "EditJournal:" << reason << m_path;
+	// keep files of the last good state, they can still be recovered
+	close(false);
+}
+
+void
+EditJournal::commit()
+{
+	if(!isOpen())
+		return;
+
+	if(m_framesPerSecondDirty) {
+		beginRecord(RecordFramesPerSecond);
+		m_stream << m_subtitle->framesPerSecond();
+		endRecord();
+	}
+	if(m_stylesheetDirty) {
+		beginRecord(RecordStylesheet);
+		m_stream << m_subtitle->stylesheet()->unformattedCSS();
+		endRecord();
+	}
+	if(!m_dirtyLines.isEmpty()) {
+		QVector<std::pair<int, const SubtitleLine *>> lines;
+		lines.reserve(m_dirtyLines.size());
+		for(const SubtitleLine *line : qAsConst(m_dirtyLines)) {
+			const int index = line->index();
+			if(index >= 0)
+				lines.append(std::make_pair(index, line));
+		}
+		std::sort(lines.begin(), lines.end());
+		for(const auto &it : qAsConst(lines))
+			writeLine(it.second, it.first);
+	}
+	if(m_dirtyStateDirty)
+		writeDirty();
+	if(m_pending.isEmpty())
+		return;
+
+	beginRecord(RecordCommit);
+	endRecord();
+	// data is handed to the OS, it survives the crash of application
+	if(!writePending(&m_file) || !m_file.flush()) {
+		fail($("writing journal failed"));
+		return;
+	}
+
+	if(m_file.size() > CompactSize)
+		compact();
+}
+
+bool
+EditJournal::compact()
+{
+	if(m_path.isEmpty() || !m_subtitle)
+		return false;
+
+	// old snapshot and journal stay valid until new ones are in place
+	const quint32 generation = m_generation + 1;
+	QSaveFile snapshot(snapshotPath(m_path, generation));
+	if(!snapshot.open(QIODevice::WriteOnly) || !ProjectFile::writeSnapshot(&snapshot, *m_subtitle) || !snapshot.commit()) {
+		fail($("writing snapshot failed"));
+		return false;
+	}
+
+	m_file.close();
+	resetPending();
+	m_stream.writeRawData(s_magic, sizeof(s_magic));
+	m_stream << quint32(Version) << quint32(generation);
+	writeInfo();
+	// snapshot of a subtitle that was never saved, changes it holds are not in the journal
+	if(m_subtitle->isPrimaryDirty() || m_subtitle->isSecondaryDirty())
+		writeDirty();
+	beginRecord(RecordCommit);
+	endRecord();
+
+	QSaveFile journal(journalPath(m_path));
+	if(!journal.open(QIODevice::WriteOnly) || !writePending(&journal) || !journal.commit()) {
+		QFile::remove(snapshotPath(m_path, generation));
+		fail($("writing journal failed"));
+		return false;
+	}
+
+	if(m_generation)
+		QFile::remove(snapshotPath(m_path, m_generation));
+	m_generation = generation;
+
+	m_file.setFileName(journalPath(m_path));
+	if(!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+		fail($("opening journal failed"));
+		return false;
+	}
+	return true;
+}
+
+int
+EditJournal::readJournal(const QString &path, QByteArray *journal)
+{
+	QFile journalFile(journalPath(path));
+	if(!journalFile.open(QIODevice::ReadOnly))
+		return 0;
+	*journal = journalFile.readAll();
+	journalFile.close();
+
+	const uchar *p = reinterpret_cast<const uchar *>(journal->constData());
+	if(journal->size() < HeaderSize || memcmp(p, s_magic, sizeof(s_magic)) != 0 || qFromLittleEndian<quint32>(p + 8) != Version)
+		return 0;
+
+	// records after the last commit were being written when application died
+	int end = HeaderSize;
+	for(int pos = HeaderSize; pos + RecordHeaderSize <= journal->size();) {
+		const quint32 size = qFromLittleEndian<quint32>(p + pos);
+		if(size > quint32(journal->size() - pos - RecordHeaderSize))
+			break;
+		const quint8 type = p[pos + 4];
+		pos += RecordHeaderSize + size;
+		if(type == RecordCommit)
+			end = pos;
+	}
+	return end;
+}
+
+bool
+EditJournal::hasChanges(const QString &path)
+{
+	QByteArray journal;
+	const int end = readJournal(path, &journal);
+	// damaged journal is left to the user to recover or discard
+	if(!end)
+		return true;
+	const uchar *p = reinterpret_cast<const uchar *>(journal.constData());
+	bool changed = false;
+	for(int pos = HeaderSize; pos < end;) {
+		const quint32 size = qFromLittleEndian<quint32>(p + pos);
+		const quint8 type = p[pos + 4];
+		if(type == RecordDirty)
+			changed = size >= 2 && (p[pos + RecordHeaderSize] || p[pos + RecordHeaderSize + 1]);
+		else if(type != RecordInfo && type != RecordCommit)
+			changed = true;
+		pos += RecordHeaderSize + size;
+	}
+	return changed;
+}
+
+bool
+EditJournal::replay(const QString &path, Subtitle *subtitle, Info *info, bool *changed)
+{
+	QByteArray journal;
+	const int end = readJournal(path, &journal);
+	if(!end)
+		return false;
+	const uchar *p = reinterpret_cast<const uchar *>(journal.constData());
+
+	QFile snapshotFile(snapshotPath(path, qFromLittleEndian<quint32>(p + 12)));
+	if(!snapshotFile.open(QIODevice::ReadOnly))
+		return false;
+	const ProjectFile project(snapshotFile.readAll());
+	snapshotFile.close();
+
+	const ProjectInputFormat *projectFormat = dynamic_cast<const ProjectInputFormat *>(FormatManager::instance().input($("Subtitle Composer Project")));
+	if(!projectFormat || !projectFormat->readProject(*subtitle, project))
+		return false;
+	const QVector<RichString> secondaryTexts = project.secondaryTexts();
+	for(int i = 0, n = qMin(secondaryTexts.size(), subtitle->count()); i < n; i++)
+		subtitle->at(i)->setSecondaryText(secondaryTexts.at(i));
+
+	bool hasChanged = false;
+	for(int pos = HeaderSize; pos < end;) {
+		const quint32 size = qFromLittleEndian<quint32>(p + pos);
+		const quint8 type = p[pos + 4];
+		QDataStream stream(QByteArray::fromRawData(journal.constData() + pos + RecordHeaderSize, int(size)));
+		initStream(stream);
+		pos += RecordHeaderSize + size;
+
+		switch(type) {
+		case RecordInfo: {
+			Info recordInfo;
+			stream >> recordInfo.url >> recordInfo.format >> recordInfo.translationMode >> recordInfo.translationUrl >> recordInfo.translationFormat;
+			if(info && stream.status() == QDataStream::Ok)
+				*info = recordInfo;
+			break;
+		}
+		case RecordDirty: {
+			quint8 primaryDirty, secondaryDirty;
+			stream >> primaryDirty >> secondaryDirty;
+			hasChanged = stream.status() == QDataStream::Ok && (primaryDirty || secondaryDirty);
+			break;
+		}
+		case RecordInsertLines:
+		case RecordRemoveLines: {
+			hasChanged = true;
+			qint32 firstIndex, lastIndex;
+			stream >> firstIndex >> lastIndex;
+			if(type == RecordInsertLines) {
+				if(firstIndex < 0 || firstIndex > subtitle->count() || lastIndex < firstIndex)
+					return false;
+				QList<SubtitleLine *> lines;
+				for(int i = firstIndex; i <= lastIndex; i++)
+					lines.append(new SubtitleLine());
+				runAction(new InsertLinesAction(subtitle, lines, firstIndex));
+			} else {
+				if(firstIndex < 0 || lastIndex < firstIndex || lastIndex >= subtitle->count())
+					return false;
+				runAction(new RemoveLinesAction(subtitle, firstIndex, lastIndex));
+			}
+			break;
+		}
+		case RecordFramesPerSecond: {
+			hasChanged = true;
+			double framesPerSecond;
+			stream >> framesPerSecond;
+			subtitle->setFramesPerSecond(framesPerSecond);
+			break;
+		}
+		case RecordStylesheet: {
+			hasChanged = true;
+			QString stylesheet;
+			stream >> stylesheet;
+			subtitle->stylesheetClear();
+			subtitle->stylesheetAppend(stylesheet);
+			break;
+		}
+		case RecordLine: {
+			hasChanged = true;
+			qint32 index;
+			double showTime, hideTime;
+			quint32 errorFlags;
+			quint8 anchored;
+			double top, left, right, bottom;
+			quint8 vertical, hAlign, vAlign;
+			RichString primaryText, secondaryText;
+			stream >> index >> showTime >> hideTime >> errorFlags >> anchored
+				>> top >> left >> right >> bottom >> vertical >> hAlign >> vAlign;
+			if(!primaryText.readStyled(stream) || !secondaryText.readStyled(stream))
+				return false;
+			if(stream.status() != QDataStream::Ok || index < 0 || index >= subtitle->count()
+					|| hAlign > SubtitleRect::END || vAlign > SubtitleRect::TOP)
+				return false;
+			// times are set directly, line order is already given by the journal
+			SubtitleLine *line = subtitle->at(index);
+			if(!projectFormat->readLineData(line, stream))
+				return false;
+			runAction(new SetLineTimesAction(line, Time(showTime), Time(hideTime)));
+			runAction(new SetLineErrorsAction(line, int(errorFlags)));
+			line->setPrimaryText(primaryText);
+			line->setSecondaryText(secondaryText);
+			SubtitleRect pos;
+			pos.top = top;
+			pos.left = left;
+			pos.right = right;
+			pos.bottom = bottom;
+			pos.vertical = vertical != 0;
+			pos.hAlign = decltype(pos.hAlign)(hAlign);
+			pos.vAlign = decltype(pos.vAlign)(vAlign);
+			line->setPosition(pos);
+			if(subtitle->isLineAnchored(index) != bool(anchored))
+				subtitle->toggleLineAnchor(index);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	if(changed)
+		*changed = hasChanged;
+	return true;
+}
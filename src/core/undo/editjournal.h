@@ -0,0 +1,134 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QStringList>
+#include <QUrl>
+
+QT_FORWARD_DECLARE_CLASS(QLockFile)
+
+namespace SubtitleComposer {
+class RangeList;
+class Subtitle;
+class SubtitleLine;
+
+/**
+ * @brief Append-only journal of subtitle edits used for crash recovery.
+ *
+ * Session is stored as a snapshot (native project file with secondary texts) and a journal of
+ * changes made after it. Changes are collected from subtitle signals and appended as one
+ * transaction every time undo stack finishes an action, undo or redo - lines are written by
+ * their complete final state, so cost of an edit depends only on lines it touched and reordered
+ * lines carry their position, meta data and format data along. Once journal grows
+ * over CompactSize, a new snapshot is written and journal starts over.
+ *
+ * Journal: magic[8], u32 version, u32 snapshot generation, records
+ * Record:  u32 payload size, u8 type, QDataStream payload
+ *
+ * Records following the last Commit record are incomplete and ignored when replaying.
+ * Session has unsaved changes if it has edit records or the last recorded dirty state is set.
+ */
+class EditJournal : public QObject
+{
+	Q_OBJECT
+
+public:
+	enum { Version = 2 };
+	enum { CompactSize = 8 << 20 };
+
+	struct Info {
+		QUrl url;
+		QString format;
+		bool translationMode;
+		QUrl translationUrl;
+		QString translationFormat;
+	};
+
+	explicit EditJournal(QObject *parent = nullptr);
+	virtual ~EditJournal();
+
+	static QString newSessionPath();
+	// sessions that are not locked by a running instance
+	static QStringList orphanedSessions();
+	static void removeSession(const QString &path);
+
+	// writes snapshot of subtitle and starts journaling its changes
+	bool open(const QString &path, Subtitle *subtitle);
+	void close(bool removeFiles = true);
+	inline bool isOpen() const { return m_file.isOpen(); }
+	inline const QString & path() const { return m_path; }
+
+	void setInfo(const Info &info);
+
+	// appends changes made since last commit as one transaction
+	void commit();
+	// writes new snapshot and starts empty journal
+	bool compact();
+
+	// true if complete transactions of the session hold unsaved changes
+	static bool hasChanges(const QString &path);
+	// loads snapshot into empty subtitle and replays all complete transactions
+	static bool replay(const QString &path, Subtitle *subtitle, Info *info = nullptr, bool *changed = nullptr);
+
+private:
+	enum RecordType {
+		RecordInfo = 1,             // url, format, translation mode, translation url, translation format
+		RecordCommit,               // end of transaction
+		RecordInsertLines,          // i32 first index, i32 last index
+		RecordRemoveLines,          // i32 first index, i32 last index
+		RecordFramesPerSecond,      // f64 fps
+		RecordStylesheet,           // QString unformatted stylesheet
+		RecordLine,                 // i32 index, f64 show time, f64 hide time, u32 error flags, u8 anchored,
+		                            // f64 top, f64 left, f64 right, f64 bottom, u8 vertical, u8 h-align, u8 v-align,
+		                            // styled primary text, styled secondary text, line meta data and format data
+		RecordDirty,                // u8 primary dirty, u8 secondary dirty
+	};
+
+	// reads journal with valid header, returns end of its last complete transaction or zero
+	static int readJournal(const QString &path, QByteArray *journal);
+
+	void beginRecord(RecordType type);
+	void endRecord();
+	void writeRange(RecordType type, int firstIndex, int lastIndex);
+	void writeInfo();
+	void writeDirty();
+	void writeLine(const SubtitleLine *line, int index);
+	bool writePending(QIODevice *device);
+	void resetPending();
+	void markLines(const RangeList &ranges);
+	void markLines(int firstIndex, int lastIndex);
+	void markLine(const SubtitleLine *line);
+	void fail(const QString &reason);
+
+	QString m_path;
+	QPointer<Subtitle> m_subtitle;
+	QLockFile *m_lock;
+	QFile m_file;
+	quint32 m_generation;
+	Info m_info;
+
+	QByteArray m_pending;
+	QBuffer m_buffer;
+	QDataStream m_stream;
+	int m_recordStart;
+
+	QSet<const SubtitleLine *> m_dirtyLines;
+	bool m_framesPerSecondDirty;
+	bool m_stylesheetDirty;
+	bool m_dirtyStateDirty;
+};
+}
+
+#endif // EDITJOURNAL_H
@@ -16,6 +16,8 @@
 
 #include <KLocalizedString>
 
+#include <cmath>
+
 using namespace SubtitleComposer;
 
 // *** SubtitleAction
@@ -88,16 +90,10 @@ InsertLinesAction::redo()
 {
 	emit m_subtitle->linesAboutToBeInserted(m_insertIndex, m_lastIndex);
 
-	SubtitleLine *line;
-	int insertOffset = 0;
-	int lineIndex = -1;
-
-	while(!m_lines.isEmpty()) {
-		line = m_lines.takeFirst();
-		lineIndex = m_insertIndex + insertOffset++;
+	for(SubtitleLine *line: qAsConst(m_lines))
 		setLineSubtitle(line);
-		m_subtitle->m_lines.insert(lineIndex, line);
-	}
+	m_subtitle->m_lines.insert(m_insertIndex, m_lines);
+	m_lines.clear();
 
 	emit m_subtitle->linesInserted(m_insertIndex, m_lastIndex);
 }
@@ -107,11 +103,13 @@ InsertLinesAction::undo()
 {
 	emit m_subtitle->linesAboutToBeRemoved(m_insertIndex, m_lastIndex);
 
-	for(int index = m_insertIndex; index <= m_lastIndex; ++index) {
-		SubtitleLine *line = m_subtitle->takeAt(m_insertIndex);
+	LineList &lines = m_subtitle->m_lines;
+	m_lines.reserve(m_lastIndex - m_insertIndex + 1);
+	for(int index = m_insertIndex; index <= m_lastIndex; ++index)
+		m_lines.append(lines.at(index));
+	lines.remove(m_insertIndex, m_lastIndex - m_insertIndex + 1);
+	for(SubtitleLine *line: qAsConst(m_lines))
 		clearLineSubtitle(line);
-		m_lines.append(line);
-	}
 
 	emit m_subtitle->linesRemoved(m_insertIndex, m_lastIndex);
 }
@@ -167,11 +165,13 @@ RemoveLinesAction::redo()
 {
 	emit m_subtitle->linesAboutToBeRemoved(m_firstIndex, m_lastIndex);
 
-	for(int index = m_firstIndex; index <= m_lastIndex; ++index) {
-		SubtitleLine *line = m_subtitle->takeAt(m_firstIndex);
+	LineList &lines = m_subtitle->m_lines;
+	m_lines.reserve(m_lastIndex - m_firstIndex + 1);
+	for(int index = m_firstIndex; index <= m_lastIndex; ++index)
+		m_lines.append(lines.at(index));
+	lines.remove(m_firstIndex, m_lastIndex - m_firstIndex + 1);
+	for(SubtitleLine *line: qAsConst(m_lines))
 		clearLineSubtitle(line);
-		m_lines.append(line);
-	}
 
 	emit m_subtitle->linesRemoved(m_firstIndex, m_lastIndex);
 }
@@ -181,15 +181,10 @@ RemoveLinesAction::undo()
 {
 	emit m_subtitle->linesAboutToBeInserted(m_firstIndex, m_lastIndex);
 
-	int insertOffset = 0;
-	int lineIndex = -1;
-
-	while(!m_lines.isEmpty()) {
-		SubtitleLine *line = m_lines.takeFirst();
-		lineIndex = m_firstIndex + insertOffset++;
+	for(SubtitleLine *line: qAsConst(m_lines))
 		setLineSubtitle(line);
-		m_subtitle->m_lines.insert(lineIndex, line);
-	}
+	m_subtitle->m_lines.insert(m_firstIndex, m_lines);
+	m_lines.clear();
 
 	emit m_subtitle->linesInserted(m_firstIndex, m_lastIndex);
 }
@@ -280,6 +275,52 @@ MoveLineAction::undo()
 }
 
 
+// *** PermuteLinesAction
+PermuteLinesAction::PermuteLinesAction(Subtitle *subtitle, int firstIndex, const QVector<int> &permutation)
+	: SubtitleAction(subtitle, UndoStack::Both, i18n("Sort")),
+	  m_firstIndex(firstIndex),
+	  m_permutation(permutation)
+{
+	Q_ASSERT(m_firstIndex >= 0);
+	Q_ASSERT(m_firstIndex + m_permutation.size() <= m_subtitle->linesCount());
+}
+
+PermuteLinesAction::~PermuteLinesAction()
+{}
+
+void
+PermuteLinesAction::permute(const QVector<int> &permutation)
+{
+	const int n = permutation.size();
+	const int lastIndex = m_firstIndex + n - 1;
+
+	emit m_subtitle->linesAboutToBeReordered(m_firstIndex, lastIndex);
+
+	QVector<SubtitleLine *> lines(n);
+	for(int i = 0; i < n; i++)
+		lines[i] = m_subtitle->m_lines.at(m_firstIndex + permutation.at(i));
+	for(int i = 0; i < n; i++)
+		m_subtitle->m_lines.replace(m_firstIndex + i, lines.at(i));
+
+	emit m_subtitle->linesReordered(m_firstIndex, lastIndex);
+}
+
+void
+PermuteLinesAction::redo()
+{
+	permute(m_permutation);
+}
+
+void
+PermuteLinesAction::undo()
+{
+	QVector<int> inverse(m_permutation.size());
+	for(int i = 0, n = m_permutation.size(); i < n; i++)
+		inverse[m_permutation.at(i)] = i;
+	permute(inverse);
+}
+
+
 // *** SwapLinesTextsAction
 SwapLinesTextsAction::SwapLinesTextsAction(Subtitle *subtitle, const RangeList &ranges) :
 	SubtitleAction(subtitle, UndoStack::Both, i18n("Swap Texts")),
@@ -294,15 +335,126 @@ SwapLinesTextsAction::redo()
 {
 	for(SubtitleIterator it(*m_subtitle, m_ranges); it.current(); ++it) {
 		SubtitleLine *line = it.current();
-		RichDocument *tmp = line->m_primaryDoc;
-		line->m_primaryDoc = line->m_secondaryDoc;
-		line->m_secondaryDoc = tmp;
+		line->swapTexts();
 		emit line->primaryTextChanged();
 		emit line->secondaryTextChanged();
 	}
 }
 
 
+// *** AdjustLinesTimesAction
+// inverse transform, results within floating point error of whole milliseconds are snapped to them
+static inline Time
+inverseTime(const Time &time, double shiftMseconds, double scaleFactor)
+{
+	const double millis = (time.toMillis() - shiftMseconds) / scaleFactor;
+	const double wholeMillis = std::round(millis);
+	return Time(qAbs(millis - wholeMillis) < 1e-6 ? wholeMillis : millis);
+}
+
+AdjustLinesTimesAction::AdjustLinesTimesAction(Subtitle *subtitle, const RangeList &ranges, double shiftMseconds, double scaleFactor, const QString &description)
+	: SubtitleAction(subtitle, UndoStack::Both, description),
+	  m_ranges(ranges),
+	  m_shiftMseconds(shiftMseconds),
+	  m_scaleFactor(scaleFactor)
+{
+	Q_ASSERT(m_scaleFactor != 0.);
+}
+
+AdjustLinesTimesAction::~AdjustLinesTimesAction()
+{}
+
+void
+AdjustLinesTimesAction::redo()
+{
+	// first run will remember times that inverse transform couldn't restore exactly
+	const bool saveTimes = !m_savedTimesValid;
+
+	int pos = 0;
+	for(SubtitleIterator it(*m_subtitle, m_ranges); it.current(); ++it, ++pos) {
+		SubtitleLine *line = it.current();
+		const Time showTime(line->m_showTime.toMillis() * m_scaleFactor + m_shiftMseconds);
+		const Time hideTime(line->m_hideTime.toMillis() * m_scaleFactor + m_shiftMseconds);
+
+		if(saveTimes && (inverseTime(showTime, m_shiftMseconds, m_scaleFactor) != line->m_showTime
+				|| inverseTime(hideTime, m_shiftMseconds, m_scaleFactor) != line->m_hideTime))
+			m_savedTimes.push_back(SavedTimes{pos, line->m_showTime, line->m_hideTime});
+
+		if(line->m_showTime != showTime) {
+			line->m_showTime = showTime;
+			emit line->showTimeChanged(showTime);
+		}
+		if(line->m_hideTime != hideTime) {
+			line->m_hideTime = hideTime;
+			emit line->hideTimeChanged(hideTime);
+		}
+	}
+
+	m_savedTimesValid = true;
+}
+
+void
+AdjustLinesTimesAction::undo()
+{
+	auto saved = m_savedTimes.cbegin();
+	int pos = 0;
+	for(SubtitleIterator it(*m_subtitle, m_ranges); it.current(); ++it, ++pos) {
+		SubtitleLine *line = it.current();
+		Time showTime, hideTime;
+		if(saved != m_savedTimes.cend() && saved->pos == pos) {
+			showTime = saved->showTime;
+			hideTime = saved->hideTime;
+			++saved;
+		} else {
+			showTime = inverseTime(line->m_showTime, m_shiftMseconds, m_scaleFactor);
+			hideTime = inverseTime(line->m_hideTime, m_shiftMseconds, m_scaleFactor);
+		}
+
+		if(line->m_showTime != showTime) {
+			line->m_showTime = showTime;
+			emit line->showTimeChanged(showTime);
+		}
+		if(line->m_hideTime != hideTime) {
+			line->m_hideTime = hideTime;
+			emit line->hideTimeChanged(hideTime);
+		}
+	}
+}
+
+
+// *** SetLinesTimesAction
+SetLinesTimesAction::SetLinesTimesAction(Subtitle *subtitle, const QVector<int> &indexes, const QVector<Time> &showTimes, const QVector<Time> &hideTimes, const QString &description)
+	: SubtitleAction(subtitle, UndoStack::Both, description),
+	  m_indexes(indexes),
+	  m_showTimes(showTimes),
+	  m_hideTimes(hideTimes)
+{
+	Q_ASSERT(m_indexes.size() == m_showTimes.size());
+	Q_ASSERT(m_indexes.size() == m_hideTimes.size());
+}
+
+SetLinesTimesAction::~SetLinesTimesAction()
+{}
+
+void
+SetLinesTimesAction::redo()
+{
+	// undo is the same as redo - we just swap line times with the ones we hold
+	for(int i = 0, n = m_indexes.size(); i < n; i++) {
+		SubtitleLine *line = m_subtitle->at(m_indexes.at(i));
+
+		if(line->m_showTime != m_showTimes.at(i)) {
+			qSwap(line->m_showTime, m_showTimes[i]);
+			emit line->showTimeChanged(line->m_showTime);
+		}
+		if(line->m_hideTime != m_hideTimes.at(i)) {
+			qSwap(line->m_hideTime, m_hideTimes[i]);
+			emit line->hideTimeChanged(line->m_hideTime);
+		}
+	}
+}
+
+
 // *** ChangeStylesheetAction
 EditStylesheetAction::EditStylesheetAction(Subtitle *subtitle, QTextEdit *textEdit)
 	: SubtitleAction(subtitle, UndoStack::Primary, i18n("Change stylesheet")),
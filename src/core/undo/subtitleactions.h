@@ -16,6 +16,7 @@
 
 #include <QString>
 #include <QList>
+#include <QVector>
 
 QT_FORWARD_DECLARE_CLASS(QTextEdit)
 
@@ -29,16 +30,20 @@ public:
 
 	inline void setLineSubtitle(SubtitleLine *line)
 	{
-		line->m_primaryDoc->setStylesheet(m_subtitle->stylesheet());
-		line->m_secondaryDoc->setStylesheet(m_subtitle->stylesheet());
+		if(line->m_primaryDoc)
+			line->m_primaryDoc->setStylesheet(m_subtitle->stylesheet());
+		if(line->m_secondaryDoc)
+			line->m_secondaryDoc->setStylesheet(m_subtitle->stylesheet());
 		line->m_subtitle = m_subtitle;
 	}
 
 	inline void clearLineSubtitle(SubtitleLine *line)
 	{
 		line->m_subtitle = nullptr;
-		line->m_primaryDoc->setStylesheet(nullptr);
-		line->m_secondaryDoc->setStylesheet(nullptr);
+		if(line->m_primaryDoc)
+			line->m_primaryDoc->setStylesheet(nullptr);
+		if(line->m_secondaryDoc)
+			line->m_secondaryDoc->setStylesheet(nullptr);
 	}
 };
 
@@ -113,6 +118,26 @@ private:
 	int m_toIndex;
 };
 
+class PermuteLinesAction : public SubtitleAction
+{
+public:
+	// line at firstIndex + permutation[i] is moved to firstIndex + i
+	PermuteLinesAction(Subtitle *subtitle, int firstIndex, const QVector<int> &permutation);
+	virtual ~PermuteLinesAction();
+
+	inline int id() const override { return UndoAction::PermuteLines; }
+
+protected:
+	void redo() override;
+	void undo() override;
+
+private:
+	void permute(const QVector<int> &permutation);
+
+	const int m_firstIndex;
+	QVector<int> m_permutation;
+};
+
 class SwapLinesTextsAction : public SubtitleAction
 {
 public:
@@ -128,6 +153,51 @@ private:
 	const RangeList m_ranges;
 };
 
+class AdjustLinesTimesAction : public SubtitleAction
+{
+public:
+	// times of lines in ranges are changed to time * scaleFactor + shiftMseconds
+	AdjustLinesTimesAction(Subtitle *subtitle, const RangeList &ranges, double shiftMseconds, double scaleFactor, const QString &description);
+	virtual ~AdjustLinesTimesAction();
+
+	inline int id() const override { return UndoAction::AdjustLinesTimes; }
+
+protected:
+	void redo() override;
+	void undo() override;
+
+private:
+	struct SavedTimes {
+		int pos;
+		Time showTime;
+		Time hideTime;
+	};
+
+	const RangeList m_ranges;
+	const double m_shiftMseconds;
+	const double m_scaleFactor;
+	// times that inverse transform can't restore exactly (clamped or lost to rounding)
+	QVector<SavedTimes> m_savedTimes;
+	bool m_savedTimesValid = false;
+};
+
+class SetLinesTimesAction : public SubtitleAction
+{
+public:
+	SetLinesTimesAction(Subtitle *subtitle, const QVector<int> &indexes, const QVector<Time> &showTimes, const QVector<Time> &hideTimes, const QString &description);
+	virtual ~SetLinesTimesAction();
+
+	inline int id() const override { return UndoAction::SetLinesTimes; }
+
+protected:
+	void redo() override;
+
+private:
+	const QVector<int> m_indexes;
+	QVector<Time> m_showTimes;
+	QVector<Time> m_hideTimes;
+};
+
 class EditStylesheetAction : public SubtitleAction
 {
 public:
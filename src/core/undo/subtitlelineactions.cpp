@@ -24,11 +24,17 @@ SubtitleLineAction::~SubtitleLineAction()
 
 
 // *** SetLinePrimaryTextAction
-SetLinePrimaryTextAction::SetLinePrimaryTextAction(SubtitleLine *line, RichDocument *primaryDoc)
+SetLinePrimaryTextAction::SetLinePrimaryTextAction(SubtitleLine *line, const RichString &prevText, const RichString &text, RichDocument *primaryDoc)
 	: SubtitleLineAction(line, UndoStack::Primary, i18n("Set Line Text")),
-	  m_primaryDoc(primaryDoc),
-	  m_primaryDocState(primaryDoc->availableUndoSteps())
-{}
+	  m_prevText(prevText),
+	  m_text(text),
+	  m_primaryDoc(primaryDoc)
+{
+	if(primaryDoc) {
+		m_primaryDocState = primaryDoc->availableUndoSteps();
+		m_primaryDocGeneration = primaryDoc->historyGeneration();
+	}
+}
 
 SetLinePrimaryTextAction::~SetLinePrimaryTextAction()
 {}
@@ -37,15 +43,28 @@ bool
 SetLinePrimaryTextAction::mergeWith(const QUndoCommand *command)
 {
 	const SetLinePrimaryTextAction *cur = static_cast<const SetLinePrimaryTextAction *>(command);
-	return cur->m_primaryDoc == m_primaryDoc && cur->m_primaryDocState == m_primaryDocState;
+	if(!m_primaryDoc || cur->m_primaryDoc != m_primaryDoc || cur->m_primaryDocState != m_primaryDocState)
+		return false;
+	m_text = cur->m_text;
+	return true;
+}
+
+bool
+SetLinePrimaryTextAction::hasDocHistory() const
+{
+	return m_primaryDoc && m_primaryDoc == m_line->m_primaryDoc && m_primaryDoc->historyGeneration() == m_primaryDocGeneration;
 }
 
 void
 SetLinePrimaryTextAction::undo()
 {
 	const bool prev = m_line->ignoreDocChanges(true);
-	while(m_primaryDoc->isUndoAvailable() && m_primaryDoc->availableUndoSteps() >= m_primaryDocState)
-		m_primaryDoc->undo();
+	if(hasDocHistory()) {
+		while(m_primaryDoc->isUndoAvailable() && m_primaryDoc->availableUndoSteps() >= m_primaryDocState)
+			m_primaryDoc->undo();
+	} else {
+		m_line->applyText(true, m_prevText);
+	}
 	m_line->ignoreDocChanges(prev);
 	emit m_line->primaryTextChanged();
 }
@@ -54,19 +73,29 @@ void
 SetLinePrimaryTextAction::redo()
 {
 	const bool prev = m_line->ignoreDocChanges(true);
-	while(m_primaryDoc->isRedoAvailable() && m_primaryDoc->availableUndoSteps() < m_primaryDocState)
-		m_primaryDoc->redo();
+	if(hasDocHistory()) {
+		while(m_primaryDoc->isRedoAvailable() && m_primaryDoc->availableUndoSteps() < m_primaryDocState)
+			m_primaryDoc->redo();
+	} else {
+		m_line->applyText(true, m_text);
+	}
 	m_line->ignoreDocChanges(prev);
 	emit m_line->primaryTextChanged();
 }
 
 
 // *** SetLineSecondaryTextAction
-SetLineSecondaryTextAction::SetLineSecondaryTextAction(SubtitleLine *line, RichDocument *secondaryDoc)
+SetLineSecondaryTextAction::SetLineSecondaryTextAction(SubtitleLine *line, const RichString &prevText, const RichString &text, RichDocument *secondaryDoc)
 	: SubtitleLineAction(line, UndoStack::Secondary, i18n("Set Line Secondary Text")),
-	  m_secondaryDoc(secondaryDoc),
-	  m_secondaryDocState(secondaryDoc->availableUndoSteps())
-{}
+	  m_prevText(prevText),
+	  m_text(text),
+	  m_secondaryDoc(secondaryDoc)
+{
+	if(secondaryDoc) {
+		m_secondaryDocState = secondaryDoc->availableUndoSteps();
+		m_secondaryDocGeneration = secondaryDoc->historyGeneration();
+	}
+}
 
 SetLineSecondaryTextAction::~SetLineSecondaryTextAction()
 {}
@@ -75,15 +104,28 @@ bool
 SetLineSecondaryTextAction::mergeWith(const QUndoCommand *command)
 {
 	const SetLineSecondaryTextAction *cur = static_cast<const SetLineSecondaryTextAction *>(command);
-	return cur->m_secondaryDoc == m_secondaryDoc && cur->m_secondaryDocState == m_secondaryDocState;
+	if(!m_secondaryDoc || cur->m_secondaryDoc != m_secondaryDoc || cur->m_secondaryDocState != m_secondaryDocState)
+		return false;
+	m_text = cur->m_text;
+	return true;
+}
+
+bool
+SetLineSecondaryTextAction::hasDocHistory() const
+{
+	return m_secondaryDoc && m_secondaryDoc == m_line->m_secondaryDoc && m_secondaryDoc->historyGeneration() == m_secondaryDocGeneration;
 }
 
 void
 SetLineSecondaryTextAction::undo()
 {
 	const bool prev = m_line->ignoreDocChanges(true);
-	while(m_secondaryDoc->isUndoAvailable() && m_secondaryDoc->availableUndoSteps() >= m_secondaryDocState)
-		m_secondaryDoc->undo();
+	if(hasDocHistory()) {
+		while(m_secondaryDoc->isUndoAvailable() && m_secondaryDoc->availableUndoSteps() >= m_secondaryDocState)
+			m_secondaryDoc->undo();
+	} else {
+		m_line->applyText(false, m_prevText);
+	}
 	m_line->ignoreDocChanges(prev);
 	emit m_line->secondaryTextChanged();
 }
@@ -92,8 +134,12 @@ void
 SetLineSecondaryTextAction::redo()
 {
 	const bool prev = m_line->ignoreDocChanges(true);
-	while(m_secondaryDoc->isRedoAvailable() && m_secondaryDoc->availableUndoSteps() < m_secondaryDocState)
-		m_secondaryDoc->redo();
+	if(hasDocHistory()) {
+		while(m_secondaryDoc->isRedoAvailable() && m_secondaryDoc->availableUndoSteps() < m_secondaryDocState)
+			m_secondaryDoc->redo();
+	} else {
+		m_line->applyText(false, m_text);
+	}
 	m_line->ignoreDocChanges(prev);
 	emit m_line->secondaryTextChanged();
 }
@@ -13,6 +13,7 @@
 #include "core/richstring.h"
 #include "core/subtitleline.h"
 
+#include <QPointer>
 #include <QString>
 
 namespace SubtitleComposer {
@@ -38,7 +39,7 @@ class SetLinePrimaryTextAction : public SubtitleLineAction
 	friend class SetLineTextsAction;
 
 public:
-	SetLinePrimaryTextAction(SubtitleLine *line, RichDocument *primaryDoc);
+	SetLinePrimaryTextAction(SubtitleLine *line, const RichString &prevText, const RichString &text, RichDocument *primaryDoc);
 	virtual ~SetLinePrimaryTextAction();
 
 	inline int id() const override { return UndoAction::SetLinePrimaryText; }
@@ -49,8 +50,14 @@ protected:
 	void redo() override;
 
 private:
-	RichDocument *m_primaryDoc;
+	bool hasDocHistory() const;
+
+	RichString m_prevText;
+	RichString m_text;
+	// document history is used while it's intact, so editor cursor is restored too
+	QPointer<RichDocument> m_primaryDoc;
 	int m_primaryDocState = -1;
+	quint32 m_primaryDocGeneration = 0;
 };
 
 class SetLineSecondaryTextAction : public SubtitleLineAction
@@ -58,7 +65,7 @@ class SetLineSecondaryTextAction : public SubtitleLineAction
 	friend class SetLineTextsAction;
 
 public:
-	SetLineSecondaryTextAction(SubtitleLine *line, RichDocument *secondaryDoc);
+	SetLineSecondaryTextAction(SubtitleLine *line, const RichString &prevText, const RichString &text, RichDocument *secondaryDoc);
 	virtual ~SetLineSecondaryTextAction();
 
 	inline int id() const override { return UndoAction::SetLineSecondaryText; }
@@ -69,8 +76,14 @@ protected:
 	void redo() override;
 
 private:
-	RichDocument *m_secondaryDoc;
+	bool hasDocHistory() const;
+
+	RichString m_prevText;
+	RichString m_text;
+	// document history is used while it's intact, so editor cursor is restored too
+	QPointer<RichDocument> m_secondaryDoc;
 	int m_secondaryDocState = -1;
+	quint32 m_secondaryDocGeneration = 0;
 };
 
 class SetLineShowTimeAction : public SubtitleLineAction
@@ -27,8 +27,11 @@ public:
 		InsertLines,
 		RemoveLines,
 		MoveLine,
+		PermuteLines,
 		SwapLinesTexts,
 		ChangeStylesheet,
+		AdjustLinesTimes,
+		SetLinesTimes,
 
 		// subtitle line actions
 		SetLinePrimaryText,
@@ -10,6 +10,7 @@
 #include "application.h"
 #include "actions/useraction.h"
 #include "actions/useractionnames.h"
+#include "core/undo/editjournal.h"
 #include "core/undo/undoaction.h"
 #include "gui/treeview/lineswidget.h"
 #include "gui/treeview/linesmodel.h"
@@ -20,7 +21,8 @@ UndoStack::UndoStack(QObject *parent)
 	: QUndoStack(parent),
 	  m_level(0),
 	  m_undoAction(QUndoStack::createUndoAction(UserActionManager::instance())),
-	  m_redoAction(QUndoStack::createRedoAction(UserActionManager::instance()))
+	  m_redoAction(QUndoStack::createRedoAction(UserActionManager::instance())),
+	  m_journal(nullptr)
 {
 	m_selectionStack.push(Selection(app()->linesWidget()->selectionModel()));
 
@@ -28,6 +30,8 @@ UndoStack::UndoStack(QObject *parent)
 	connect(this, &UndoStack::redoTextChanged, redoAction(), &QAction::setToolTip);
 	connect(this, &UndoStack::indexChanged, parent, [](){ if(Subtitle *s = appSubtitle()) s->updateState(); });
 	connect(this, &UndoStack::cleanChanged, parent, [](){ if(Subtitle *s = appSubtitle()) s->updateState(); });
+	// undo/redo can also be triggered by actions created by QUndoStack
+	connect(this, &UndoStack::indexChanged, this, &UndoStack::commitJournal);
 }
 
 UndoStack::~UndoStack()
@@ -110,6 +114,13 @@ UndoStack::levelDecrease(int idx)
 	}
 }
 
+void
+UndoStack::commitJournal()
+{
+	if(m_journal && m_level == 0)
+		m_journal->commit();
+}
+
 void
 UndoStack::push(UndoAction *cmd)
 {
@@ -119,6 +130,7 @@ UndoStack::push(UndoAction *cmd)
 	m_dirtyStack[idx] = static_cast<DirtyMode>(m_dirtyStack.at(idx) | cmd->m_dirtyMode);
 	QUndoStack::push(cmd); // NOTE: cmd can/will be deleted after push()
 	levelDecrease(idx1);
+	commitJournal();
 }
 
 void
@@ -136,6 +148,7 @@ UndoStack::endMacro(DirtyMode dirtyOverride)
 	if(dirtyOverride != Invalid)
 		m_dirtyStack[idx] = dirtyOverride;
 	QUndoStack::endMacro();
+	commitJournal();
 }
 
 void
@@ -14,6 +14,7 @@
 QT_FORWARD_DECLARE_CLASS(QItemSelectionModel)
 
 namespace SubtitleComposer {
+class EditJournal;
 class UndoAction;
 
 class UndoStack : private QUndoStack
@@ -70,6 +71,9 @@ public:
 	inline DirtyMode dirtyMode(int index) const { return m_dirtyStack.at(index); }
 	using QUndoStack::command;
 
+	// journal receives a commit after every outermost action, macro, undo and redo
+	inline void setJournal(EditJournal *journal) { m_journal = journal; }
+
 public slots:
 	void undo();
 	void redo();
@@ -77,6 +81,7 @@ public slots:
 private:
 	void levelIncrease(int idx);
 	void levelDecrease(int idx);
+	void commitJournal();
 
 private:
 	int m_level;
@@ -84,6 +89,7 @@ private:
 	QStack<DirtyMode> m_dirtyStack;
 	QAction *m_undoAction;
 	QAction *m_redoAction;
+	EditJournal *m_journal;
 };
 
 }
@@ -8,6 +8,7 @@
 #include "errortracker.h"
 #include "application.h"
 #include "core/richtext/richdocument.h"
+#include "core/subtitleiterator.h"
 #include "core/subtitleline.h"
 
 using namespace SubtitleComposer;
@@ -46,6 +47,9 @@ ErrorTracker::connectSlots()
 	connect(m_subtitle.constData(), &Subtitle::lineSecondaryTextChanged, this, &ErrorTracker::onLineSecondaryTextChanged);
 	connect(m_subtitle.constData(), &Subtitle::lineShowTimeChanged, this, &ErrorTracker::onLineTimesChanged);
 	connect(m_subtitle.constData(), &Subtitle::lineHideTimeChanged, this, &ErrorTracker::onLineTimesChanged);
+	connect(m_subtitle.constData(), &Subtitle::linesPrimaryTextChanged, this, &ErrorTracker::onLinesPrimaryTextChanged);
+	connect(m_subtitle.constData(), &Subtitle::linesSecondaryTextChanged, this, &ErrorTracker::onLinesSecondaryTextChanged);
+	connect(m_subtitle.constData(), &Subtitle::linesTimesChanged, this, &ErrorTracker::onLinesTimesChanged);
 }
 
 void
@@ -82,6 +86,27 @@ ErrorTracker::onLineTimesChanged(SubtitleLine *line)
 		updateLineErrors(prevLine, prevLine->errorFlags() & SubtitleLine::OverlapsWithNext);
 }
 
+void
+ErrorTracker::onLinesPrimaryTextChanged(const RangeList &ranges)
+{
+	for(SubtitleIterator it(*m_subtitle, ranges); it.current(); ++it)
+		onLinePrimaryTextChanged(it.current());
+}
+
+void
+ErrorTracker::onLinesSecondaryTextChanged(const RangeList &ranges)
+{
+	for(SubtitleIterator it(*m_subtitle, ranges); it.current(); ++it)
+		onLineSecondaryTextChanged(it.current());
+}
+
+void
+ErrorTracker::onLinesTimesChanged(const RangeList &ranges)
+{
+	for(SubtitleIterator it(*m_subtitle, ranges); it.current(); ++it)
+		onLineTimesChanged(it.current());
+}
+
 void
 ErrorTracker::onConfigChanged()
 {
@@ -36,6 +36,9 @@ private slots:
 	void onLinePrimaryTextChanged(SubtitleLine *line);
 	void onLineSecondaryTextChanged(SubtitleLine *line);
 	void onLineTimesChanged(SubtitleLine *line);
+	void onLinesPrimaryTextChanged(const RangeList &ranges);
+	void onLinesSecondaryTextChanged(const RangeList &ranges);
+	void onLinesTimesChanged(const RangeList &ranges);
 
 	void onConfigChanged();
 
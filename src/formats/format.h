@@ -11,6 +11,7 @@
 #include "core/formatdata.h"
 #include "core/subtitle.h"
 #include "core/subtitleline.h"
+#include "core/subtitlesnapshot.h"
 
 #include <QString>
 #include <QStringBuilder>
@@ -92,6 +93,18 @@ protected:
 		line->setFormatData(formatData);
 	}
 
+	const FormatData * formatData(const SubtitleSnapshot &subtitle) const
+	{
+		const FormatData *formatData = subtitle.formatData();
+		return formatData && formatData->formatName() == m_name ? formatData : nullptr;
+	}
+
+	const FormatData * formatData(const LineSnapshot &line) const
+	{
+		const FormatData *formatData = line.formatData();
+		return formatData && formatData->formatName() == m_name ? formatData : nullptr;
+	}
+
 	QString m_name;
 	QStringList m_extensions;
 };
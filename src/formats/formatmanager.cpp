@@ -14,6 +14,7 @@
 #include "application.h"
 #include "helpers/fileloadhelper.h"
 #include "helpers/filesavehelper.h"
+#include "helpers/utf8.h"
 #include "dialogs/encodingdetectdialog.h"
 #include "scconfig.h"
 
@@ -23,6 +24,8 @@
 #include "mplayer/mplayeroutputformat.h"
 #include "mplayer2/mplayer2inputformat.h"
 #include "mplayer2/mplayer2outputformat.h"
+#include "project/projectinputformat.h"
+#include "project/projectoutputformat.h"
 #include "subrip/subripinputformat.h"
 #include "subrip/subripoutputformat.h"
 #include "substationalpha/substationalphainputformat.h"
@@ -42,9 +45,15 @@
 #include <QFile>
 #include <QFileDevice>
 #include <QFileInfo>
+#include <QScopedPointer>
 #include <QTextCodec>
+#include <QTextDecoder>
 
 #include <QUrl>
+#include <QVector>
+
+#include <algorithm>
+#include <cstring>
 
 #ifdef HAVE_ICU
 #	include <unicode/ucsdet.h>
@@ -77,6 +86,7 @@ FormatManager::FormatManager()
 	IN_OUT_FORMAT(TMPlayer)
 	IN_OUT_FORMAT(TMPlayerPlus)
 	IN_OUT_FORMAT(YouTubeCaptions)
+	IN_OUT_FORMAT(Project)
 	INPUT_FORMAT(VobSub)
 }
 
@@ -146,6 +156,111 @@ detectEncoding(const QByteArray &byteData)
 	return nullptr;
 }
 
+inline static QTextCodec *
+asciiCodec()
+{
+	// plain ASCII decodes the same with any ASCII compatible codec, prefer the configured one
+	QTextCodec *codec = QTextCodec::codecForName(SCConfig::defaultSubtitlesEncoding().toUtf8());
+	const QByteArray sample("\t\n !09AZaz~");
+	if(codec && codec->fromUnicode(QString::fromLatin1(sample)) == sample)
+		return codec;
+	return QTextCodec::codecForMib(106); // UTF-8
+}
+
+/**
+ * @brief Append text to @p out converting CRLF and CR line endings to LF.
+ * @param pendingCR set when text ended with CR, LF at the start of next chunk is then skipped
+ */
+static void
+appendNormalizedText(QString *out, const QString &text, bool *pendingCR)
+{
+	const QChar *c = text.constData();
+	const QChar *end = c + text.size();
+	if(c == end)
+		return;
+
+	if(*pendingCR && *c == QChar::LineFeed)
+		c++;
+	*pendingCR = false;
+
+	const QChar *start = c;
+	for(; c != end; c++) {
+		if(*c != QChar::CarriageReturn)
+			continue;
+		out->append(start, c - start);
+		out->append(QChar::LineFeed);
+		if(c + 1 == end)
+			*pendingCR = true;
+		else if(c[1] == QChar::LineFeed)
+			c++;
+		start = c + 1;
+	}
+	out->append(start, end - start);
+}
+
+/**
+ * @brief Decodes text data in chunks of given byte size with line endings normalized to LF
+ */
+class TextDecoder
+{
+public:
+	TextDecoder(const QByteArray &data, QTextCodec *codec, bool isUtf8, int chunkSize)
+		: m_data(data),
+		  m_codec(codec),
+		  m_chunkSize(chunkSize),
+		  m_start(0)
+	{
+		// well formed UTF-8 is decoded directly, without the codec's error handling
+		m_directUtf8 = codec->mibEnum() == 106 && (isUtf8 || Utf8::isValid(data.constData(), data.size()));
+		if(m_directUtf8 && data.size() >= 3 && memcmp(data.constData(), "\xEF\xBB\xBF", 3) == 0)
+			m_start = 3;
+		rewind();
+	}
+
+	void rewind()
+	{
+		m_offset = m_start;
+		m_pendingCR = false;
+		// decoder keeps state of multibyte sequences split between chunks
+		if(!m_directUtf8)
+			m_decoder.reset(m_codec->makeDecoder());
+	}
+
+	/**
+	 * @brief Decode next chunk into @p chunk
+	 * @return false when all data has been decoded
+	 */
+	bool next(QString *chunk)
+	{
+		const int size = m_data.size();
+		while(m_offset < size) {
+			const int len = qMin<int>(m_chunkSize, size - m_offset);
+			chunk->resize(0);
+			if(m_directUtf8) {
+				m_raw.resize(0);
+				m_offset += Utf8::decode(&m_raw, m_data.constData() + m_offset, len);
+				appendNormalizedText(chunk, m_raw, &m_pendingCR);
+			} else {
+				appendNormalizedText(chunk, m_decoder->toUnicode(m_data.constData() + m_offset, len), &m_pendingCR);
+				m_offset += len;
+			}
+			if(!chunk->isEmpty())
+				return true;
+		}
+		return false;
+	}
+
+private:
+	const QByteArray &m_data;
+	QTextCodec *m_codec;
+	const int m_chunkSize;
+	bool m_directUtf8;
+	int m_start;
+	int m_offset;
+	bool m_pendingCR;
+	QScopedPointer<QTextDecoder> m_decoder;
+	QString m_raw;
+};
 
 FormatManager::Status
 FormatManager::readBinary(Subtitle &subtitle, const QUrl &url, bool primary,
@@ -177,49 +292,97 @@ FormatManager::readText(Subtitle &subtitle, const QUrl &url, bool primary,
 	FileLoadHelper fileLoadHelper(url);
 	if(!fileLoadHelper.open())
 		return ERROR;
-	// WARNING: only 1MB of text subtitle is being read here
-	QByteArray byteData = fileLoadHelper.file()->read(1024 * 1024);
-	fileLoadHelper.close();
+	// local files are mapped, no copy of the raw data is made
+	const QByteArray byteData = fileLoadHelper.data();
 
-	QString stringData;
+	QTextCodec *textCodec;
+	bool isUtf8 = false;
 	if(!codec) {
 		// don't care about text nor text encoding
-		stringData = QString::fromLatin1(byteData);
+		textCodec = QTextCodec::codecForName("ISO-8859-1");
 	} else {
 		if(!*codec) {
-			QTextCodec *c = detectEncoding(byteData);
+			// most files are ASCII or UTF-8, which is recognized with certainty without asking ICU
+			bool ascii = false;
+			isUtf8 = Utf8::isValid(byteData.constData(), byteData.size(), &ascii);
+			QTextCodec *c;
+			if(isUtf8)
+				c = ascii ? asciiCodec() : QTextCodec::codecForMib(106);
+			else
+				c = detectEncoding(QByteArray::fromRawData(byteData.constData(), qMin<int>(byteData.size(), DetectSampleSize)));
 			if(!c)
 				return CANCEL;
 			*codec = c;
 		}
-		if(*codec)
-			stringData = (*codec)->toUnicode(byteData);
+		textCodec = *codec;
 	}
 
-	stringData.replace(QLatin1String("\r\n"), QLatin1String("\n"));
-	stringData.replace('\r', '\n');
-
 	const QString extension = QFileInfo(url.path()).suffix();
 
-	// attempt to parse subtitles based on extension information first
-	for(QMap<QString, InputFormat *>::ConstIterator it = m_inputFormats.begin(), end = m_inputFormats.end(); it != end; ++it) {
-		if(it.value()->knowsExtension(extension)) {
-			if(it.value()->readSubtitle(subtitle, primary, stringData)) {
-				if(formatName)
-					*formatName = it.value()->name();
-				return SUCCESS;
+	// rank formats by a quick look at the start of data, so that usually only one full parse is needed
+	TextDecoder decoder(byteData, textCodec, isUtf8, ReadChunkSize);
+	QString head;
+	QString chunk;
+	while(head.size() < ProbeSize && decoder.next(&chunk))
+		head.append(chunk);
+	head.truncate(ProbeSize);
+
+	struct Candidate { InputFormat *format; int score; bool knowsExtension; };
+	QVector<Candidate> candidates;
+	for(InputFormat *format : m_inputFormats) {
+		const bool knowsExtension = format->knowsExtension(extension);
+		const int score = format->probe(head);
+		// formats that don't recognize the data are still tried when extension matches
+		if(score > InputFormat::ProbeNone || knowsExtension)
+			candidates.push_back(Candidate{format, score, knowsExtension});
+	}
+	std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b){
+		if(a.score != b.score)
+			return a.score > b.score;
+		return a.knowsExtension && !b.knowsExtension;
+	});
+
+	// formats with a Reader are fed data while it is decoded, whole text is built only for the others
+	QString stringData;
+	bool haveStringData = false;
+	const auto parse = [&](const InputFormat *format) -> bool {
+		QScopedPointer<InputFormat::Reader> reader(format->createReader());
+		if(reader) {
+			if(haveStringData) {
+				reader->feed(stringData);
+			} else {
+				decoder.rewind();
+				while(decoder.next(&chunk))
+					reader->feed(chunk);
 			}
+			return format->readSubtitle(subtitle, primary, reader.data());
+		}
+		if(!haveStringData) {
+			haveStringData = true;
+			stringData.reserve(byteData.size());
+			decoder.rewind();
+			while(decoder.next(&chunk))
+				stringData.append(chunk);
+		}
+		return format->readSubtitle(subtitle, primary, stringData);
+	};
+
+	for(const Candidate &candidate : qAsConst(candidates)) {
+		if(parse(candidate.format)) {
+			if(formatName)
+				*formatName = candidate.format->name();
+			return SUCCESS;
 		}
 	}
 
-	// attempt to parse subtitles based on content
-	for(QMap<QString, InputFormat *>::ConstIterator it = m_inputFormats.begin(), end = m_inputFormats.end(); it != end; ++it) {
-		if(!it.value()->knowsExtension(extension)) {
-			if(it.value()->readSubtitle(subtitle, primary, stringData)) {
-				if(formatName)
-					*formatName = it.value()->name();
-				return SUCCESS;
-			}
+	// probe may miss data that a format still parses, try the rest in the old order
+	for(InputFormat *format : m_inputFormats) {
+		if(std::any_of(candidates.cbegin(), candidates.cend(), [format](const Candidate &c){ return c.format == format; }))
+			continue;
+		if(parse(format)) {
+			if(formatName)
+				*formatName = format->name();
+			return SUCCESS;
 		}
 	}
 
@@ -283,21 +446,29 @@ FormatManager::writeSubtitle(const Subtitle &subtitle, bool primary, const QUrl
 	if(!fileSaveHelper.open())
 		return false;
 
-	QFileDevice *file = fileSaveHelper.file();
-	QString data = format->writeSubtitle(subtitle, primary);
-	if(codec->name().startsWith("UTF-") || codec->name().contains("UCS-"))
-		data.prepend(QChar::ByteOrderMark);
+	if(format->isBinary()) {
+		if(!format->writeBinary(subtitle, primary, fileSaveHelper.file()))
+			return false;
+		return fileSaveHelper.close();
+	}
+
+	TextWriter::LineBreak lineBreak;
 	switch(SCConfig::textLineBreak()) {
 	case 1: // CRLF
-		file->write(codec->fromUnicode(data.replace(QChar::LineFeed, QLatin1String("\r\n"))));
+		lineBreak = TextWriter::CRLF;
 		break;
 	case 2: // CR
-		file->write(codec->fromUnicode(data.replace(QChar::LineFeed, QChar::CarriageReturn)));
+		lineBreak = TextWriter::CR;
 		break;
 	default: // LF
-		file->write(codec->fromUnicode(data));
+		lineBreak = TextWriter::LF;
 		break;
 	}
+	const bool byteOrderMark = codec->name().startsWith("UTF-") || codec->name().contains("UCS-");
+
+	TextWriter out(fileSaveHelper.file(), codec, lineBreak, byteOrderMark);
+	if(!format->writeSubtitle(subtitle, primary, out))
+		return false;
 
 	return fileSaveHelper.close();
 }
@@ -49,6 +49,12 @@ public:
 					   QTextCodec *codec, const QString &format, bool overwrite) const;
 
 protected:
+	enum {
+		ReadChunkSize = 256 * 1024,     // bytes decoded at once while reading text subtitles
+		DetectSampleSize = 1024 * 1024, // bytes used for text encoding detection
+		ProbeSize = 4096,               // characters passed to InputFormat::probe()
+	};
+
 	FormatManager();
 	~FormatManager();
 
@@ -0,0 +1,161 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "inputformat.h"
+
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <deque>
+
+using namespace SubtitleComposer;
+
+class InputFormat::CueParser : public QRunnable
+{
+public:
+	CueParser(const InputFormat *format, const QString &data, int start, int end, QVector<Cue> *cues)
+		: m_format(format),
+		  m_data(data),
+		  m_start(start),
+		  m_end(end),
+		  m_cues(cues)
+	{}
+
+	void run() override
+	{
+		m_format->parseCues(m_data, m_start, m_end, m_cues);
+	}
+
+private:
+	const InputFormat *m_format;
+	const QString m_data;
+	int m_start;
+	int m_end;
+	QVector<Cue> *m_cues;
+};
+
+template<class C>
+static bool
+insertCues(Subtitle &subtitle, const C &results)
+{
+	int count = 0;
+	for(const auto &cues : results)
+		count += cues.size();
+	if(!count)
+		return false;
+
+	QList<SubtitleLine *> lines;
+	lines.reserve(count);
+	for(const auto &cues : results) {
+		for(const auto &cue : cues) {
+			SubtitleLine *line = new SubtitleLine(cue.showTime, cue.hideTime);
+			line->setPrimaryText(cue.text);
+			lines.append(line);
+		}
+	}
+	subtitle.insertLines(lines);
+
+	return true;
+}
+
+class InputFormat::CueReader : public InputFormat::Reader
+{
+public:
+	CueReader(const InputFormat *format)
+		: m_format(format),
+		  m_start(0),
+		  m_splitSize(2 * ParallelChunkSize)
+	{}
+
+	~CueReader()
+	{
+		m_pool.waitForDone();
+	}
+
+	void feed(const QString &chunk) override
+	{
+		m_data.append(chunk);
+
+		// hand complete cues to workers, remaining data waits for the next chunk
+		while(m_data.size() - m_start >= m_splitSize) {
+			const int off = m_format->nextCueOffset(m_data, m_start + ParallelChunkSize);
+			if(off < 0) {
+				// no cue starts in pending data, don't rescan it for every chunk
+				m_splitSize = 2 * (m_data.size() - m_start);
+				break;
+			}
+			m_results.emplace_back();
+			m_pool.start(new CueParser(m_format, m_data.mid(m_start, off - m_start), 0, off - m_start, &m_results.back()));
+			m_start = off;
+			m_splitSize = 2 * ParallelChunkSize;
+		}
+
+		if(m_start) {
+			m_data.remove(0, m_start);
+			m_start = 0;
+		}
+	}
+
+	bool finish(Subtitle &subtitle) override
+	{
+		if(!m_data.isEmpty()) {
+			m_results.emplace_back();
+			m_format->parseCues(m_data, 0, m_data.size(), &m_results.back());
+			m_data.clear();
+		}
+		m_pool.waitForDone();
+
+		return insertCues(subtitle, m_results);
+	}
+
+private:
+	const InputFormat *m_format;
+	QString m_data;
+	int m_start;
+	int m_splitSize;
+	// workers write into elements, deque doesn't move them when appending
+	std::deque<QVector<Cue>> m_results;
+	QThreadPool m_pool;
+};
+
+InputFormat::Reader *
+InputFormat::createCueReader() const
+{
+	return new CueReader(this);
+}
+
+bool
+InputFormat::parseCuesParallel(Subtitle &subtitle, const QString &data) const
+{
+	const int chunks = qMin(QThread::idealThreadCount(), data.size() / ParallelChunkSize);
+
+	QVector<int> bounds;
+	bounds.append(0);
+	for(int i = 1; i < chunks; i++) {
+		const int off = nextCueOffset(data, int(qint64(data.size()) * i / chunks));
+		if(off < 0)
+			break;
+		if(off > bounds.last())
+			bounds.append(off);
+	}
+	bounds.append(data.size());
+
+	QVector<QVector<Cue>> results(bounds.size() - 1);
+	if(results.size() == 1) {
+		parseCues(data, 0, data.size(), &results[0]);
+	} else {
+		QThreadPool pool;
+		for(int i = 0; i < results.size(); i++)
+			pool.start(new CueParser(this, data, bounds.at(i), bounds.at(i + 1), &results[i]));
+		pool.waitForDone();
+	}
+
+	return insertCues(subtitle, qAsConst(results));
+}
@@ -11,10 +11,23 @@
 #include "format.h"
 #include "formatmanager.h"
 
+#include <QVector>
+
 namespace SubtitleComposer {
 class InputFormat : public Format
 {
 public:
+	// Incremental parser, data is fed in chunks as it is decoded so the whole text is never held at once.
+	class Reader
+	{
+	public:
+		virtual ~Reader() {}
+		// parse next chunk of data, chunks are split at arbitrary positions
+		virtual void feed(const QString &chunk) = 0;
+		// parse remaining data and add lines to subtitle, false if data was not in this format
+		virtual bool finish(Subtitle &subtitle) = 0;
+	};
+
 	bool readSubtitle(Subtitle &subtitle, bool primary, const QString &data) const
 	{
 		QExplicitlySharedDataPointer<Subtitle> newSubtitle(new Subtitle());
@@ -30,13 +43,68 @@ public:
 		return true;
 	}
 
+	bool readSubtitle(Subtitle &subtitle, bool primary, Reader *reader) const
+	{
+		QExplicitlySharedDataPointer<Subtitle> newSubtitle(new Subtitle());
+
+		if(!reader->finish(*newSubtitle))
+			return false;
+
+		if(primary)
+			subtitle.setPrimaryData(*newSubtitle, true);
+		else
+			subtitle.setSecondaryData(*newSubtitle, true);
+
+		return true;
+	}
+
+	// returns nullptr if format can only parse complete data with parseSubtitles()
+	virtual Reader * createReader() const { return nullptr; }
+
 	virtual bool isBinary() const { return false; }
 	virtual FormatManager::Status readBinary(Subtitle &, const QUrl &) { return FormatManager::ERROR; }
 
+	enum {
+		ProbeNone = 0,          // data is not in this format
+		ProbeLikely = 50,       // data looks like this format or a close variant of it
+		ProbeCertain = 100,     // data is in this format
+	};
+
+	// cheap check of the first few kilobytes, parseSubtitles() is called only for best scoring formats
+	virtual int probe(const QString &/*head*/) const { return ProbeNone; }
+
 protected:
 	virtual bool parseSubtitles(Subtitle &subtitle, const QString &data) const = 0;
 
+	// plain cue data, safe to create on worker threads
+	struct Cue
+	{
+		Time showTime;
+		Time hideTime;
+		RichString text;
+	};
+
+	enum {
+		ParallelChunkSize = 512 * 1024, // minimum characters parsed by one worker
+	};
+
+	// Formats whose cues can be parsed independently implement nextCueOffset() and parseCues() and
+	// call parseCuesParallel() from parseSubtitles(). Large data is then split at cue boundaries
+	// and parsed on a thread pool, lines are created and inserted at once on the calling thread.
+	bool parseCuesParallel(Subtitle &subtitle, const QString &data) const;
+	// offset of first cue starting at or after offset, -1 if there is none
+	virtual int nextCueOffset(const QString &/*data*/, int /*offset*/) const { return -1; }
+	// parse cues in [start, end) range of data, text of last cue ends at end
+	virtual void parseCues(const QString &/*data*/, int /*start*/, int /*end*/, QVector<Cue> */*cues*/) const {}
+	// Reader for formats implementing nextCueOffset() and parseCues(), fed data is split at
+	// cue boundaries and parsed on a thread pool while decoding continues
+	Reader * createCueReader() const;
+
 	InputFormat(const QString &name, const QStringList &extensions) : Format(name, extensions) {}
+
+private:
+	class CueParser;
+	class CueReader;
 };
 }
 
@@ -22,12 +22,10 @@ public:
 
 protected:
 
-	QString dumpSubtitles(const Subtitle &subtitle, bool primary) const override
+	void dumpSubtitles(const Subtitle &subtitle, bool primary, TextWriter &out) const override
 	{
-		QString ret;
-
 		double framesPerSecond = subtitle.framesPerSecond();
-		ret += m_lineBuilder
+		out << m_lineBuilder
 				.arg(1)
 				.arg(1)
 				.arg(QString::number(framesPerSecond, 'f', 3));
@@ -35,7 +33,7 @@ protected:
 		for(SubtitleIterator it(subtitle); it.current(); ++it) {
 			const SubtitleLine *line = it.current();
 
-			const RichString &text = (primary ? line->primaryDoc() : line->secondaryDoc())->toRichText();
+			const RichString &text = line->text(primary);
 			QString subtitle;
 
 			int prevStyle = 0;
@@ -59,12 +57,11 @@ protected:
 				prevColor = curColor;
 			}
 
-			ret += m_lineBuilder
+			out << m_lineBuilder
 					.arg(static_cast<long>((line->showTime().toMillis() / 1000.0) * framesPerSecond + 0.5))
 					.arg(static_cast<long>((line->hideTime().toMillis() / 1000.0) * framesPerSecond + 0.5))
 					.arg(subtitle);
 		}
-		return ret;
 	}
 
 	MicroDVDOutputFormat() :
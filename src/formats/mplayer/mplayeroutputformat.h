@@ -18,22 +18,19 @@ class MPlayerOutputFormat : public OutputFormat
 	friend class FormatManager;
 
 protected:
-	QString dumpSubtitles(const Subtitle &subtitle, bool primary) const override
+	void dumpSubtitles(const Subtitle &subtitle, bool primary, TextWriter &out) const override
 	{
-		QString ret;
-
 		double framesPerSecond = subtitle.framesPerSecond();
 
 		for(SubtitleIterator it(subtitle); it.current(); ++it) {
 			const SubtitleLine *line = it.current();
 
-			QString text = (primary ? line->primaryDoc() : line->secondaryDoc())->toPlainText();
+			QString text = line->text(primary);
 
-			ret += m_lineBuilder.arg(static_cast<long>((line->showTime().toMillis() / 1000.0) * framesPerSecond + 0.5))
+			out << m_lineBuilder.arg(static_cast<long>((line->showTime().toMillis() / 1000.0) * framesPerSecond + 0.5))
 					.arg(static_cast<long>((line->hideTime().toMillis() / 1000.0) * framesPerSecond + 0.5))
 					.arg(text.replace('\n', '|'));
 		}
-		return ret;
 	}
 
 	MPlayerOutputFormat() :
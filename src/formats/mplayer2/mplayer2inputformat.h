@@ -24,6 +24,12 @@ protected:
 		: InputFormat($("MPlayer2"), QStringList($("mpl")))
 	{}
 
+	int probe(const QString &head) const override
+	{
+		staticRE$(reProbe, "^\\[\\d+\\]\\[\\d+\\]", REu | REm);
+		return head.contains(reProbe) ? ProbeCertain : ProbeNone;
+	}
+
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
 	{
 		staticRE$(lineRE, "\\[(\\d+)\\]\\[(\\d+)\\]([^\n]+)\n", REu | REi);
@@ -32,6 +38,7 @@ protected:
 		if(!itLine.hasNext())
 			return false;
 
+		QList<SubtitleLine *> lines;
 		do {
 			const QRegularExpressionMatch mLine = itLine.next();
 			const Time showTime(mLine.captured(1).toInt() * 100);
@@ -39,9 +46,10 @@ protected:
 			const QString text = mLine.captured(3).replace(QChar('|'), QChar('\n'));
 
 			SubtitleLine *line = new SubtitleLine(showTime, hideTime);
-			line->primaryDoc()->setPlainText(text);
-			subtitle.insertLine(line);
+			line->setPrimaryText(RichString(text));
+			lines.append(line);
 		} while(itLine.hasNext());
+		subtitle.insertLines(lines);
 
 		return true;
 	}
@@ -18,20 +18,17 @@ class MPlayer2OutputFormat : public OutputFormat
 	friend class FormatManager;
 
 protected:
-	QString dumpSubtitles(const Subtitle &subtitle, bool primary) const override
+	void dumpSubtitles(const Subtitle &subtitle, bool primary, TextWriter &out) const override
 	{
-		QString ret;
-
 		for(SubtitleIterator it(subtitle); it.current(); ++it) {
 			const SubtitleLine *line = it.current();
 
-			QString text = (primary ? line->primaryDoc() : line->secondaryDoc())->toPlainText();
+			QString text = line->text(primary);
 
-			ret += m_lineBuilder.arg(static_cast<long>((line->showTime().toMillis() / 100.0) + 0.5))
+			out << m_lineBuilder.arg(static_cast<long>((line->showTime().toMillis() / 100.0) + 0.5))
 					.arg(static_cast<long>((line->hideTime().toMillis() / 100.0) + 0.5))
 					.arg(text.replace('\n', '|'));
 		}
-		return ret;
 	}
 
 	MPlayer2OutputFormat() :
@@ -0,0 +1,66 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "outputformat.h"
+
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+using namespace SubtitleComposer;
+
+class OutputFormat::LineDumper : public QRunnable
+{
+public:
+	LineDumper(const OutputFormat *format, const SubtitleSnapshot &snapshot, bool primary, int start, int end, QString *text)
+		: m_format(format),
+		  m_snapshot(snapshot),
+		  m_primary(primary),
+		  m_start(start),
+		  m_end(end),
+		  m_text(text)
+	{}
+
+	void run() override
+	{
+		TextWriter out(m_text);
+		m_format->dumpLines(m_snapshot, m_primary, m_start, m_end, out);
+	}
+
+private:
+	const OutputFormat *m_format;
+	const SubtitleSnapshot &m_snapshot;
+	bool m_primary;
+	int m_start;
+	int m_end;
+	QString *m_text;
+};
+
+void
+OutputFormat::dumpLinesParallel(const SubtitleSnapshot &snapshot, bool primary, TextWriter &out) const
+{
+	const int count = snapshot.count();
+	const int threads = QThread::idealThreadCount();
+	if(threads < 2 || count < 2 * ParallelLineCount) {
+		dumpLines(snapshot, primary, 0, count, out);
+		return;
+	}
+
+	// lines are written in batches of one range per thread, so only a batch is held in memory
+	QThreadPool pool;
+	QVector<QString> texts(threads);
+	for(int batch = 0; batch < count; batch += threads * ParallelLineCount) {
+		int n = 0;
+		for(int start = batch; start < count && n < threads; start += ParallelLineCount, n++) {
+			texts[n].resize(0);
+			pool.start(new LineDumper(this, snapshot, primary, start, qMin(count, start + ParallelLineCount), &texts[n]));
+		}
+		pool.waitForDone();
+
+		for(int i = 0; i < n; i++)
+			out << texts.at(i);
+	}
+}
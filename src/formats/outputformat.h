@@ -9,6 +9,7 @@
 #define OUTPUTFORMAT_H
 
 #include "format.h"
+#include "formats/textwriter.h"
 
 namespace SubtitleComposer {
 class OutputFormat : public Format
@@ -17,13 +18,40 @@ public:
 
 	QString writeSubtitle(const Subtitle &subtitle, bool primary) const
 	{
-		return dumpSubtitles(subtitle, primary);
+		QString ret;
+		TextWriter out(&ret);
+		dumpSubtitles(subtitle, primary, out);
+		return ret;
 	}
 
+	bool writeSubtitle(const Subtitle &subtitle, bool primary, TextWriter &out) const
+	{
+		dumpSubtitles(subtitle, primary, out);
+		return out.flush();
+	}
+
+	// binary formats are written straight into the device, without text encoding
+	virtual bool isBinary() const { return false; }
+	virtual bool writeBinary(const Subtitle &/*subtitle*/, bool /*primary*/, QIODevice */*device*/) const { return false; }
+
 protected:
-	virtual QString dumpSubtitles(const Subtitle &subtitle, bool primary) const = 0;
+	virtual void dumpSubtitles(const Subtitle &subtitle, bool primary, TextWriter &out) const = 0;
+
+	enum {
+		ParallelLineCount = 2048, // lines written by one worker
+	};
+
+	// Formats whose lines can be written independently implement dumpLines() and call
+	// dumpLinesParallel() from dumpSubtitles() after writing their header. Line ranges of the
+	// snapshot are then written into separate buffers on a thread pool and passed to out in order.
+	void dumpLinesParallel(const SubtitleSnapshot &snapshot, bool primary, TextWriter &out) const;
+	// write lines in [start, end) range of snapshot
+	virtual void dumpLines(const SubtitleSnapshot &/*snapshot*/, bool /*primary*/, int /*start*/, int /*end*/, TextWriter &/*out*/) const {}
 
 	OutputFormat(const QString &name, const QStringList &extensions) : Format(name, extensions) {}
+
+private:
+	class LineDumper;
 };
 }
 
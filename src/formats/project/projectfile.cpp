@@ -0,0 +1,361 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "projectfile.h"
+
+#include "core/formatdata.h"
+#include "core/richtext/richcss.h"
+#include "core/subtitle.h"
+#include "core/subtitlesnapshot.h"
+
+#include <QDataStream>
+#include <QIODevice>
+#include <QVector>
+#include <QtEndian>
+
+#include <cstring>
+
+using namespace SubtitleComposer;
+
+static const char s_magic[8] = { 'S', 'C', 'P', 'R', 'O', 'J', '\r', '\n' };
+
+static inline quint32
+le32(const uchar *p)
+{
+	return qFromLittleEndian<quint32>(p);
+}
+
+static inline quint64
+le64(const uchar *p)
+{
+	return qFromLittleEndian<quint64>(p);
+}
+
+static inline double
+leDouble(const uchar *p)
+{
+	const quint64 v = le64(p);
+	double d;
+	memcpy(&d, &v, sizeof(d));
+	return d;
+}
+
+static inline quint64
+align8(quint64 offset)
+{
+	return (offset + 7) & ~quint64(7);
+}
+
+static void
+initStream(QDataStream &stream)
+{
+	stream.setVersion(QDataStream::Qt_5_6);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+ProjectFile::ProjectFile(const QByteArray &data)
+	: m_data(data),
+	  m_valid(false),
+	  m_version(0),
+	  m_lineCount(0)
+{
+	if(!hasMagic(data) || data.size() < HeaderSize)
+		return;
+
+	const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+	m_version = le32(p + 8);
+	// newer versions can change the layout, they are refused
+	if(m_version < 1 || m_version > Version)
+		return;
+
+	const quint64 size = data.size();
+	const quint32 sectionCount = le32(p + 12);
+	if(size < HeaderSize + quint64(sectionCount) * SectionEntrySize)
+		return;
+	for(quint32 i = 0; i < sectionCount; i++) {
+		const uchar *entry = p + HeaderSize + i * SectionEntrySize;
+		const quint64 offset = le64(entry + 8);
+		const quint64 length = le64(entry + 16);
+		if(offset > size || length > size - offset)
+			return;
+	}
+	m_valid = true;
+
+	m_lines = section(SectionLines);
+	m_text = section(SectionText);
+	m_lineData = section(SectionLineData);
+	if(m_lines.size() % LineRecordSize) {
+		m_valid = false;
+		return;
+	}
+	m_lineCount = m_lines.size() / LineRecordSize;
+}
+
+bool
+ProjectFile::hasMagic(const QByteArray &data)
+{
+	return data.size() >= int(sizeof(s_magic)) && memcmp(data.constData(), s_magic, sizeof(s_magic)) == 0;
+}
+
+QByteArray
+ProjectFile::section(SectionId id) const
+{
+	if(!m_valid)
+		return QByteArray();
+
+	const uchar *p = reinterpret_cast<const uchar *>(m_data.constData());
+	for(quint32 i = 0, n = le32(p + 12); i < n; i++) {
+		const uchar *entry = p + HeaderSize + i * SectionEntrySize;
+		if(le32(entry) == quint32(id))
+			return QByteArray::fromRawData(m_data.constData() + le64(entry + 8), int(le64(entry + 16)));
+	}
+	return QByteArray();
+}
+
+QByteArray
+ProjectFile::sectionData(const QByteArray &section, quint64 offset, quint64 size) const
+{
+	if(offset > quint64(section.size()) || size > quint64(section.size()) - offset)
+		return QByteArray();
+	return QByteArray::fromRawData(section.constData() + offset, int(size));
+}
+
+const uchar *
+ProjectFile::lineRecord(int index) const
+{
+	Q_ASSERT(index >= 0 && index < m_lineCount);
+	return reinterpret_cast<const uchar *>(m_lines.constData()) + index * LineRecordSize;
+}
+
+Time
+ProjectFile::lineShowTime(int index) const
+{
+	return Time(leDouble(lineRecord(index)));
+}
+
+Time
+ProjectFile::lineHideTime(int index) const
+{
+	return Time(leDouble(lineRecord(index) + 8));
+}
+
+int
+ProjectFile::lineErrorFlags(int index) const
+{
+	return int(le32(lineRecord(index) + 16));
+}
+
+int
+ProjectFile::lineFlags(int index) const
+{
+	return int(le32(lineRecord(index) + 20));
+}
+
+SubtitleRect
+ProjectFile::linePosition(int index) const
+{
+	const uchar *r = lineRecord(index);
+	SubtitleRect pos;
+	pos.top = leDouble(r + 24);
+	pos.left = leDouble(r + 32);
+	pos.right = leDouble(r + 40);
+	pos.bottom = leDouble(r + 48);
+	pos.vertical = r[56] != 0;
+	if(r[57] <= SubtitleRect::END)
+		pos.hAlign = decltype(pos.hAlign)(r[57]);
+	if(r[58] <= SubtitleRect::TOP)
+		pos.vAlign = decltype(pos.vAlign)(r[58]);
+	return pos;
+}
+
+RichString
+ProjectFile::lineText(int index, bool *ok) const
+{
+	const uchar *r = lineRecord(index);
+	const quint32 size = le32(r + 60);
+	const QByteArray data = sectionData(m_text, le64(r + 64), size);
+	RichString text;
+	bool res = data.size() == int(size);
+	if(res && size) {
+		QDataStream stream(data);
+		initStream(stream);
+		res = text.readStyled(stream) && stream.atEnd();
+	}
+	if(ok)
+		*ok = res;
+	return text;
+}
+
+bool
+ProjectFile::lineData(int index, QMap<QByteArray, QString> *metaData, FormatData *formatData, bool *hasFormatData) const
+{
+	const uchar *r = lineRecord(index);
+	const QByteArray data = sectionData(m_lineData, le64(r + 72), le32(r + 80));
+	*hasFormatData = false;
+	if(data.isEmpty())
+		return false;
+
+	QDataStream stream(data);
+	initStream(stream);
+	return readLineData(stream, metaData, formatData, hasFormatData);
+}
+
+void
+ProjectFile::writeLineData(QDataStream &stream, const LineSnapshot &line)
+{
+	stream << line.metaData() << bool(line.formatData());
+	if(line.formatData())
+		stream << *line.formatData();
+}
+
+bool
+ProjectFile::readLineData(QDataStream &stream, QMap<QByteArray, QString> *metaData, FormatData *formatData, bool *hasFormatData)
+{
+	stream >> *metaData >> *hasFormatData;
+	if(*hasFormatData)
+		stream >> *formatData;
+	return stream.status() == QDataStream::Ok;
+}
+
+bool
+ProjectFile::readInfo(double *framesPerSecond, QMap<QByteArray, QString> *metaData, QString *stylesheet, FormatData *formatData, bool *hasFormatData) const
+{
+	const QByteArray data = section(SectionInfo);
+	*hasFormatData = false;
+	if(data.isEmpty())
+		return false;
+
+	QDataStream stream(data);
+	initStream(stream);
+	stream >> *framesPerSecond >> *metaData >> *stylesheet >> *hasFormatData;
+	if(*hasFormatData)
+		stream >> *formatData;
+	return stream.status() == QDataStream::Ok;
+}
+
+QVector<RichString>
+ProjectFile::secondaryTexts() const
+{
+	QVector<RichString> texts;
+	const QByteArray data = section(SectionSecondaryText);
+	if(data.isEmpty())
+		return texts;
+
+	QDataStream stream(data);
+	initStream(stream);
+	texts.resize(m_lineCount);
+	for(int i = 0; i < m_lineCount; i++) {
+		if(!texts[i].readStyled(stream)) {
+			texts.clear();
+			break;
+		}
+	}
+	return texts;
+}
+
+bool
+ProjectFile::write(QIODevice *device, const Subtitle &subtitle, bool primary)
+{
+	return write(device, subtitle, primary, false);
+}
+
+bool
+ProjectFile::writeSnapshot(QIODevice *device, const Subtitle &subtitle)
+{
+	return write(device, subtitle, true, true);
+}
+
+bool
+ProjectFile::write(QIODevice *device, const Subtitle &subtitle, bool primary, bool secondaryText)
+{
+	const SubtitleSnapshot snapshot = subtitle.snapshot();
+
+	QByteArray info;
+	{
+		QDataStream stream(&info, QIODevice::WriteOnly);
+		initStream(stream);
+		const FormatData *formatData = snapshot.formatData();
+		stream << snapshot.framesPerSecond() << snapshot.metaData() << subtitle.stylesheet()->unformattedCSS() << bool(formatData);
+		if(formatData)
+			stream << *formatData;
+	}
+
+	QByteArray lines, text, lineData, secondary;
+	{
+		QDataStream lineStream(&lines, QIODevice::WriteOnly);
+		QDataStream textStream(&text, QIODevice::WriteOnly);
+		QDataStream dataStream(&lineData, QIODevice::WriteOnly);
+		initStream(lineStream);
+		initStream(textStream);
+		initStream(dataStream);
+		lines.reserve(snapshot.count() * LineRecordSize);
+
+		if(secondaryText) {
+			QDataStream secondaryStream(&secondary, QIODevice::WriteOnly);
+			initStream(secondaryStream);
+			for(int i = 0, n = snapshot.count(); i < n; i++)
+				snapshot.at(i).text(false).writeStyled(secondaryStream);
+		}
+
+		for(int i = 0, n = snapshot.count(); i < n; i++) {
+			const LineSnapshot &line = snapshot.at(i);
+
+			const qint64 textOffset = textStream.device()->pos();
+			line.text(primary).writeStyled(textStream);
+			const qint64 textSize = textStream.device()->pos() - textOffset;
+
+			const qint64 dataOffset = dataStream.device()->pos();
+			if(!line.metaData().isEmpty() || line.formatData())
+				writeLineData(dataStream, line);
+			const qint64 dataSize = dataStream.device()->pos() - dataOffset;
+
+			const SubtitleRect &pos = line.pos();
+			lineStream << line.showTime().toMillis() << line.hideTime().toMillis()
+				<< quint32(line.errorFlags()) << quint32(subtitle.isLineAnchored(i) ? LineAnchored : 0)
+				<< double(pos.top) << double(pos.left) << double(pos.right) << double(pos.bottom)
+				<< quint8(pos.vertical) << quint8(pos.hAlign) << quint8(pos.vAlign) << quint8(0)
+				<< quint32(textSize) << quint64(textOffset) << quint64(dataOffset) << quint32(dataSize) << quint32(0);
+		}
+	}
+
+	struct Section { SectionId id; const QByteArray *data; };
+	QVector<Section> sections;
+	sections.append(Section{SectionInfo, &info});
+	sections.append(Section{SectionLines, &lines});
+	sections.append(Section{SectionText, &text});
+	sections.append(Section{SectionLineData, &lineData});
+	if(secondaryText)
+		sections.append(Section{SectionSecondaryText, &secondary});
+
+	QByteArray header;
+	{
+		QDataStream stream(&header, QIODevice::WriteOnly);
+		initStream(stream);
+		stream.writeRawData(s_magic, sizeof(s_magic));
+		stream << quint32(Version) << quint32(sections.size());
+		quint64 offset = align8(HeaderSize + sections.size() * SectionEntrySize);
+		for(const Section &section : qAsConst(sections)) {
+			stream << quint32(section.id) << quint32(0) << quint64(offset) << quint64(section.data->size());
+			offset = align8(offset + section.data->size());
+		}
+	}
+
+	static const char padding[8] = {};
+	auto writePadded = [device](const QByteArray &data) {
+		if(device->write(data) != data.size())
+			return false;
+		const int pad = int(align8(data.size()) - data.size());
+		return device->write(padding, pad) == pad;
+	};
+	if(!writePadded(header))
+		return false;
+	for(const Section &section : qAsConst(sections)) {
+		if(!writePadded(*section.data))
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,114 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef PROJECTFILE_H
+#define PROJECTFILE_H
+
+#include "core/richstring.h"
+#include "core/subtitleline.h"
+#include "core/time.h"
+
+#include <QByteArray>
+#include <QMap>
+#include <QVector>
+
+QT_FORWARD_DECLARE_CLASS(QDataStream)
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+
+namespace SubtitleComposer {
+class FormatData;
+class LineSnapshot;
+class Subtitle;
+
+/**
+ * @brief Native project file.
+ *
+ * File starts with a header and table of sections, every section is referenced by its offset and
+ * size. Lines are stored as fixed size records, their texts and other variable sized data are
+ * stored in separate sections and referenced from line records. All numbers are little endian
+ * and sections are 8 byte aligned, so the file can be mapped and any line read directly.
+ *
+ * Header:        magic[8], u32 version, u32 section count
+ * Section entry: u32 id, u32 reserved, u64 offset, u64 size
+ * Line record:   f64 show time, f64 hide time, u32 error flags, u32 line flags,
+ *                f64 top, f64 left, f64 right, f64 bottom, u8 vertical, u8 hAlign, u8 vAlign, u8 reserved,
+ *                u32 text size, u64 text offset, u64 data offset, u32 data size, u32 reserved
+ */
+class ProjectFile
+{
+public:
+	enum { Version = 1 };
+
+	enum SectionId {
+		SectionInfo = 1,          // QDataStream: fps, subtitle meta data, stylesheet, format data
+		SectionLines = 2,         // line records
+		SectionText = 3,          // RichString::writeStyled() data of each line
+		SectionLineData = 4,      // QDataStream: line meta data and format data
+		SectionSecondaryText = 5, // RichString::writeStyled() data of each line's secondary text
+	};
+
+	enum LineFlag {
+		LineAnchored = 0x1,
+	};
+
+	/**
+	 * @brief Reader of project file data, data is not copied and must stay valid while reading.
+	 */
+	explicit ProjectFile(const QByteArray &data);
+
+	static bool hasMagic(const QByteArray &data);
+
+	inline bool isValid() const { return m_valid; }
+	inline int version() const { return m_version; }
+
+	QByteArray section(SectionId id) const;
+
+	inline int lineCount() const { return m_lineCount; }
+	Time lineShowTime(int index) const;
+	Time lineHideTime(int index) const;
+	int lineErrorFlags(int index) const;
+	int lineFlags(int index) const;
+	SubtitleRect linePosition(int index) const;
+	// ok is set to false when text data is corrupt
+	RichString lineText(int index, bool *ok = nullptr) const;
+	// returns false when line has no meta data nor format data
+	bool lineData(int index, QMap<QByteArray, QString> *metaData, FormatData *formatData, bool *hasFormatData) const;
+
+	// reads fps, subtitle meta data, stylesheet and format data
+	bool readInfo(double *framesPerSecond, QMap<QByteArray, QString> *metaData, QString *stylesheet, FormatData *formatData, bool *hasFormatData) const;
+	// secondary texts of all lines, empty when file has no secondary text section
+	QVector<RichString> secondaryTexts() const;
+
+	static bool write(QIODevice *device, const Subtitle &subtitle, bool primary);
+	// line meta data and format data as stored in SectionLineData
+	static void writeLineData(QDataStream &stream, const LineSnapshot &line);
+	static bool readLineData(QDataStream &stream, QMap<QByteArray, QString> *metaData, FormatData *formatData, bool *hasFormatData);
+	// writes primary texts together with secondary text section
+	static bool writeSnapshot(QIODevice *device, const Subtitle &subtitle);
+
+private:
+	enum {
+		HeaderSize = 16,
+		SectionEntrySize = 24,
+		LineRecordSize = 88,
+	};
+
+	static bool write(QIODevice *device, const Subtitle &subtitle, bool primary, bool secondaryText);
+
+	const uchar * lineRecord(int index) const;
+	QByteArray sectionData(const QByteArray &section, quint64 offset, quint64 size) const;
+
+	QByteArray m_data;
+	bool m_valid;
+	int m_version;
+	QByteArray m_lines;
+	QByteArray m_text;
+	QByteArray m_lineData;
+	int m_lineCount;
+};
+}
+
+#endif // PROJECTFILE_H
@@ -0,0 +1,124 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "projectinputformat.h"
+
+#include "formats/project/projectfile.h"
+#include "helpers/common.h"
+#include "helpers/fileloadhelper.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+using namespace SubtitleComposer;
+
+ProjectInputFormat::ProjectInputFormat()
+	: InputFormat($("Subtitle Composer Project"), QStringList($("scproj")))
+{}
+
+FormatManager::Status
+ProjectInputFormat::readBinary(Subtitle &subtitle, const QUrl &url)
+{
+	// every file is offered to binary formats first, look at the magic before loading whole file
+	if(url.isLocalFile()) {
+		QFile file(url.toLocalFile());
+		if(!file.open(QIODevice::ReadOnly) || !ProjectFile::hasMagic(file.read(16)))
+			return FormatManager::ERROR;
+	} else if(!knowsExtension(QFileInfo(url.path()).suffix())) {
+		return FormatManager::ERROR;
+	}
+
+	FileLoadHelper fileLoadHelper(url);
+	if(!fileLoadHelper.open())
+		return FormatManager::ERROR;
+	// local files are mapped, lines are read straight from the mapped records
+	const ProjectFile project(fileLoadHelper.data());
+	const bool res = readProject(subtitle, project);
+	fileLoadHelper.close();
+
+	return res ? FormatManager::SUCCESS : FormatManager::ERROR;
+}
+
+bool
+ProjectInputFormat::readProject(Subtitle &subtitle, const ProjectFile &project) const
+{
+	if(!project.isValid())
+		return false;
+
+	double framesPerSecond = 0.;
+	QMap<QByteArray, QString> metaData;
+	QString stylesheet;
+	FormatData formatData = createFormatData();
+	bool hasFormatData;
+	if(!project.readInfo(&framesPerSecond, &metaData, &stylesheet, &formatData, &hasFormatData))
+		return false;
+
+	if(framesPerSecond > 0.)
+		subtitle.setFramesPerSecond(framesPerSecond);
+	for(auto it = metaData.cbegin(); it != metaData.cend(); ++it)
+		subtitle.meta(it.key(), it.value());
+	if(!stylesheet.isEmpty())
+		subtitle.stylesheetAppend(stylesheet);
+	if(hasFormatData)
+		setFormatData(subtitle, &formatData);
+
+	QList<SubtitleLine *> lines;
+	QList<SubtitleLine *> anchored;
+	lines.reserve(project.lineCount());
+	for(int i = 0, n = project.lineCount(); i < n; i++) {
+		bool textValid;
+		const RichString text = project.lineText(i, &textValid);
+		if(!textValid) {
+			qDeleteAll(lines);
+			return false;
+		}
+
+		SubtitleLine *line = new SubtitleLine(project.lineShowTime(i), project.lineHideTime(i));
+		line->setPrimaryText(text);
+		line->setErrorFlags(project.lineErrorFlags(i));
+		line->setPosition(project.linePosition(i));
+
+		metaData.clear();
+		if(project.lineData(i, &metaData, &formatData, &hasFormatData)) {
+			for(auto it = metaData.cbegin(); it != metaData.cend(); ++it)
+				line->meta(it.key(), it.value());
+			if(hasFormatData)
+				setFormatData(line, &formatData);
+		}
+
+		if(project.lineFlags(i) & ProjectFile::LineAnchored)
+			anchored.append(line);
+		lines.append(line);
+	}
+	subtitle.insertLines(lines);
+
+	for(SubtitleLine *line : qAsConst(anchored))
+		subtitle.toggleLineAnchor(line);
+
+	return true;
+}
+
+bool
+ProjectInputFormat::readLineData(SubtitleLine *line, QDataStream &stream) const
+{
+	QMap<QByteArray, QString> metaData;
+	FormatData formatData = createFormatData();
+	bool hasFormatData;
+	if(!ProjectFile::readLineData(stream, &metaData, &formatData, &hasFormatData))
+		return false;
+
+	const QList<QByteArray> keys = line->snapshot().metaData().keys();
+	for(const QByteArray &key : keys) {
+		if(!metaData.contains(key))
+			line->metaRemove(key);
+	}
+	for(auto it = metaData.cbegin(); it != metaData.cend(); ++it) {
+		if(line->meta(it.key()) != it.value() || !line->metaExists(it.key()))
+			line->meta(it.key(), it.value());
+	}
+	setFormatData(line, hasFormatData ? &formatData : nullptr);
+	return true;
+}
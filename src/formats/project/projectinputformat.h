@@ -0,0 +1,34 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef PROJECTINPUTFORMAT_H
+#define PROJECTINPUTFORMAT_H
+
+#include "formats/inputformat.h"
+
+namespace SubtitleComposer {
+class ProjectFile;
+
+class ProjectInputFormat : public InputFormat
+{
+	friend class FormatManager;
+
+public:
+	bool isBinary() const override { return true; }
+	FormatManager::Status readBinary(Subtitle &subtitle, const QUrl &url) override;
+
+	bool readProject(Subtitle &subtitle, const ProjectFile &project) const;
+	// replaces meta data and format data of line with ones written by ProjectFile::writeLineData()
+	bool readLineData(SubtitleLine *line, QDataStream &stream) const;
+
+protected:
+	bool parseSubtitles(Subtitle &, const QString &) const override { return false; }
+
+	ProjectInputFormat();
+};
+}
+
+#endif
@@ -0,0 +1,36 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef PROJECTOUTPUTFORMAT_H
+#define PROJECTOUTPUTFORMAT_H
+
+#include "formats/outputformat.h"
+#include "formats/project/projectfile.h"
+#include "helpers/common.h"
+
+namespace SubtitleComposer {
+class ProjectOutputFormat : public OutputFormat
+{
+	friend class FormatManager;
+
+public:
+	bool isBinary() const override { return true; }
+
+	bool writeBinary(const Subtitle &subtitle, bool primary, QIODevice *device) const override
+	{
+		return ProjectFile::write(device, subtitle, primary);
+	}
+
+protected:
+	void dumpSubtitles(const Subtitle &/*subtitle*/, bool /*primary*/, TextWriter &/*out*/) const override {}
+
+	ProjectOutputFormat()
+		: OutputFormat($("Subtitle Composer Project"), QStringList($("scproj")))
+	{}
+};
+}
+
+#endif
@@ -0,0 +1,168 @@
+/*
+    SPDX-FileCopyrightText: 2007-2009 Sergio Pistone <sergio_pistone@yahoo.com.ar>
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "subripinputformat.h"
+
+#include "core/richstring.h"
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+#include <QStringRef>
+#else
+#include <QStringView>
+#endif
+
+#include <algorithm>
+
+using namespace SubtitleComposer;
+
+static inline int
+digitValue(QChar ch, char max = '9')
+{
+	const ushort c = ch.unicode();
+	return c >= '0' && c <= ushort(max) ? c - '0' : -1;
+}
+
+/**
+ * @brief Parse "HH:MM:SS,mmm" (or "HH:MM:SS.mmm") starting at @p c
+ * @return pointer after the parsed time or nullptr if there is no time at @p c
+ */
+static const QChar *
+parseTime(const QChar *c, const QChar *end, Time *time)
+{
+	// shortest valid time is "00:00:00,0"
+	if(end - c < 10)
+		return nullptr;
+
+	const int h1 = digitValue(c[0], '2'), h2 = digitValue(c[1]);
+	const int m1 = digitValue(c[3], '5'), m2 = digitValue(c[4]);
+	const int s1 = digitValue(c[6], '5'), s2 = digitValue(c[7]);
+	if((h1 | h2 | m1 | m2 | s1 | s2) < 0 || c[2] != QLatin1Char(':') || c[5] != QLatin1Char(':'))
+		return nullptr;
+	if(c[8] != QLatin1Char(',') && c[8] != QLatin1Char('.'))
+		return nullptr;
+
+	c += 9;
+	int ms = 0;
+	const QChar *msStart = c;
+	for(int d; c != end && (d = digitValue(*c)) >= 0; c++) {
+		if(c - msStart < 9)
+			ms = ms * 10 + d;
+	}
+	if(c == msStart)
+		return nullptr;
+
+	*time = Time(h1 * 10 + h2, m1 * 10 + m2, s1 * 10 + s2, ms);
+	return c;
+}
+
+/**
+ * @brief Parse "HH:MM:SS,mmm --> HH:MM:SS,mmm" line occupying whole [c, end)
+ */
+static bool
+parseTimeLine(const QChar *c, const QChar *end, Time *showTime, Time *hideTime)
+{
+	static const QChar arrow[] = { QLatin1Char(' '), QLatin1Char('-'), QLatin1Char('-'), QLatin1Char('>'), QLatin1Char(' ') };
+
+	c = parseTime(c, end, showTime);
+	if(!c || end - c < 5 || !std::equal(arrow, arrow + 5, c))
+		return false;
+	c = parseTime(c + 5, end, hideTime);
+	return c == end;
+}
+
+bool
+SubRipInputFormat::parseSubtitles(Subtitle &subtitle, const QString &data) const
+{
+	return parseCuesParallel(subtitle, data);
+}
+
+int
+SubRipInputFormat::nextCueOffset(const QString &data, int offset) const
+{
+	// cue starts with a line containing only counter digits followed by time line
+	const QChar *str = data.constData();
+	const QChar *end = str + data.size();
+	const QChar *ls = str + offset;
+	if(offset > 0 && ls[-1] != QChar::LineFeed) {
+		ls = std::find(ls, end, QChar(QChar::LineFeed));
+		if(ls == end)
+			return -1;
+		ls++;
+	}
+
+	const QChar *counter = nullptr;
+	while(ls < end) {
+		const QChar *le = std::find(ls, end, QChar(QChar::LineFeed));
+		if(le == end)
+			break;
+
+		Time showTime, hideTime;
+		if(counter && parseTimeLine(ls, le, &showTime, &hideTime))
+			return counter - str;
+
+		counter = ls;
+		for(const QChar *c = ls; c != le; c++) {
+			if(digitValue(*c) < 0) {
+				counter = nullptr;
+				break;
+			}
+		}
+		if(counter == le)
+			counter = nullptr;
+
+		ls = le + 1;
+	}
+	return -1;
+}
+
+void
+SubRipInputFormat::parseCues(const QString &data, int start, int end, QVector<Cue> *cues) const
+{
+	// Cue is a counter line followed by a time line, its text runs until the next cue's counter.
+	// Single pass over lines, texts are passed to RichString as views of data.
+	const QChar *str = data.constData();
+	const QChar *dataEnd = str + end;
+	cues->reserve(cues->size() + (end - start) / 48);
+
+	int textStart = start;
+	const auto setCueText = [&](int textEnd){
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+		const QStringRef text = data.midRef(textStart, textEnd - textStart).trimmed();
+#else
+		const QStringView text = QStringView(data).mid(textStart, textEnd - textStart).trimmed();
+#endif
+		cues->last().text.setRichString(text);
+	};
+
+	for(const QChar *ls = str + start; ls < dataEnd; ) {
+		const QChar *le = std::find(ls, dataEnd, QChar(QChar::LineFeed));
+		if(le == dataEnd) // time line must be terminated by newline
+			break;
+
+		// time line must be preceded by a line ending with counter digits, those can't
+		// belong to previous cue's time line
+		const QChar *textBegin = str + textStart;
+		Time showTime, hideTime;
+		if(ls - textBegin >= 2 && digitValue(ls[-2]) >= 0 && parseTimeLine(ls, le, &showTime, &hideTime)) {
+			const QChar *counter = ls - 2;
+			while(counter > textBegin && digitValue(counter[-1]) >= 0)
+				counter--;
+
+			if(!cues->isEmpty())
+				setCueText(counter - str);
+			cues->append(Cue{showTime, hideTime, RichString()});
+			textStart = le + 1 - str;
+		}
+
+		ls = le + 1;
+	}
+
+	if(!cues->isEmpty())
+		setCueText(end);
+}
@@ -8,7 +8,6 @@
 #ifndef SUBRIPINPUTFORMAT_H
 #define SUBRIPINPUTFORMAT_H
 
-#include "core/richtext/richdocument.h"
 #include "helpers/common.h"
 #include "formats/inputformat.h"
 
@@ -25,33 +24,17 @@ protected:
 
 	{}
 
-	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
+	int probe(const QString &head) const override
 	{
-		staticRE$(reTime, "[\\d]+\n([0-2][0-9]):([0-5][0-9]):([0-5][0-9])[,\\.]([0-9]+) --> ([0-2][0-9]):([0-5][0-9]):([0-5][0-9])[,\\.]([0-9]+)\n", REu);
-
-		QRegularExpressionMatchIterator itTime = reTime.globalMatch(data);
-		if(!itTime.hasNext())
-			return false;
-
-		do {
-			QRegularExpressionMatch mTime = itTime.next();
-
-			Time showTime(mTime.captured(1).toInt(), mTime.captured(2).toInt(), mTime.captured(3).toInt(), mTime.captured(4).toInt());
-			Time hideTime(mTime.captured(5).toInt(), mTime.captured(6).toInt(), mTime.captured(7).toInt(), mTime.captured(8).toInt());
-
-			const int off = mTime.capturedEnd();
-			const QString text = data.mid(off, itTime.hasNext() ? itTime.peekNext().capturedStart() - off : -1).trimmed();
-
-			RichString stext;
-			stext.setRichString(text);
+		staticRE$(reProbe, "^\\d+\n[0-2][0-9]:[0-5][0-9]:[0-5][0-9][,\\.][0-9]+ --> ", REu | REm);
+		return head.contains(reProbe) ? ProbeCertain : ProbeNone;
+	}
 
-			SubtitleLine *line = new SubtitleLine(showTime, hideTime);
-			line->primaryDoc()->setRichText(stext, true);
-			subtitle.insertLine(line);
-		} while(itTime.hasNext());
+	Reader * createReader() const override { return createCueReader(); }
 
-		return true;
-	}
+	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override;
+	int nextCueOffset(const QString &data, int offset) const override;
+	void parseCues(const QString &data, int start, int end, QVector<Cue> *cues) const override;
 };
 }
 
@@ -10,7 +10,6 @@
 
 #include "formats/outputformat.h"
 #include "core/richtext/richdocument.h"
-#include "core/subtitleiterator.h"
 
 namespace SubtitleComposer {
 class SubRipOutputFormat : public OutputFormat
@@ -18,24 +17,35 @@ class SubRipOutputFormat : public OutputFormat
 	friend class FormatManager;
 
 protected:
-	QString dumpSubtitles(const Subtitle &subtitle, bool primary) const override
+	static void writeTime(TextWriter &out, const Time &time)
 	{
-		QString ret;
-
-		for(SubtitleIterator it(subtitle); it.current(); ++it) {
-			const SubtitleLine *line = it.current();
-
-			Time showTime = line->showTime();
-			Time hideTime = line->hideTime();
-			ret += QString::asprintf("%d\n%02d:%02d:%02d,%03d --> %02d:%02d:%02d,%03d\n", it.index() + 1, showTime.hours(), showTime.minutes(), showTime.seconds(), showTime.millis(), hideTime.hours(), hideTime.minutes(), hideTime.seconds(), hideTime.millis());
-
-			const RichString text = (primary ? line->primaryDoc() : line->secondaryDoc())->toRichText();
+		out.number(time.hours(), 2) << ':';
+		out.number(time.minutes(), 2) << ':';
+		out.number(time.seconds(), 2) << ',';
+		out.number(time.millis(), 3);
+	}
 
-			ret += text.richString().replace(QLatin1String("&amp;"), QLatin1String("&")).replace(QLatin1String("&lt;"), QLatin1String("<")).replace(QLatin1String("&gt;"), QLatin1String(">"));
+	void dumpSubtitles(const Subtitle &subtitle, bool primary, TextWriter &out) const override
+	{
+		dumpLinesParallel(subtitle.snapshot(), primary, out);
+	}
 
-			ret += QStringLiteral("\n\n");
+	void dumpLines(const SubtitleSnapshot &snapshot, bool primary, int start, int end, TextWriter &out) const override
+	{
+		for(int i = start; i < end; i++) {
+			const LineSnapshot &line = snapshot.at(i);
+
+			out << i + 1 << '\n';
+			writeTime(out, line.showTime());
+			out << " --> ";
+			writeTime(out, line.hideTime());
+			out << '\n';
+
+			QString text = line.text(primary).richString();
+			if(text.contains(QLatin1Char('&')))
+				text.replace(QLatin1String("&amp;"), QLatin1String("&")).replace(QLatin1String("&lt;"), QLatin1String("<")).replace(QLatin1String("&gt;"), QLatin1String(">"));
+			out << text << "\n\n";
 		}
-		return ret;
 	}
 
 	SubRipOutputFormat() :
@@ -120,6 +120,7 @@ protected:
 		staticRE$(reDialogueData, " *(Dialogue: *[^,]+, *)[^,]+(, *)[^,]+(, *[^,]+, *[^,]*, *[^,]*, *[^,]*, *[^,]*, *[^,]*, *).*", REu);
 		staticRE$(reTime, "(\\d+):(\\d+):(\\d+).(\\d+)", REu);
 
+		QList<SubtitleLine *> lines;
 		do {
 			QRegularExpressionMatch mFormat = itFormat.next();
 			QRegularExpressionMatchIterator itDialogue = reDialogue.globalMatch(data, mFormat.capturedEnd());
@@ -143,14 +144,15 @@ protected:
 				Time hideTime(mTime.captured(1).toInt(), mTime.captured(2).toInt(), mTime.captured(3).toInt(), mTime.captured(4).toInt() * 10);
 
 				SubtitleLine *line = new SubtitleLine(showTime, hideTime);
-				line->primaryDoc()->setRichText(toRichString(mDialogue.captured(3)), true);
+				line->setPrimaryText(toRichString(mDialogue.captured(3)));
 
 				formatData.setValue($("Dialogue"), mDialogue.captured(0).replace(reDialogueData, $("\\1%1\\2%2\\3%3\n")));
 				setFormatData(line, &formatData);
 
-				subtitle.insertLine(line);
+				lines.append(line);
 			}
 		} while(itFormat.hasNext());
+		subtitle.insertLines(lines);
 
 		return true;
 	}
@@ -160,6 +162,17 @@ protected:
 			const QStringList &extensions = QStringList($("ssa")))
 		: InputFormat(name, extensions)
 	{}
+
+	int probe(const QString &head) const override
+	{
+		staticRE$(reScriptInfo, "^ *\\[Script Info\\] *[\r\n]+", REu);
+		if(!head.contains(reScriptInfo))
+			return ProbeNone;
+		// both variants are read by the same parser, prefer the one matching styles section
+		staticRE$(reAdvanced, "^ *(?:\\[[vV]4\\+ Styles\\]|ScriptType: *[vV]4\\.00\\+)", REu | REm);
+		const bool advanced = head.contains(reAdvanced);
+		return advanced == (m_name == $("Advanced SubStation Alpha")) ? ProbeCertain : ProbeLikely;
+	}
 };
 
 class AdvancedSubStationAlphaInputFormat : public SubStationAlphaInputFormat
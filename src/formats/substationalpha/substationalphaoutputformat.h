@@ -11,7 +11,6 @@
 #include "formats/outputformat.h"
 #include "core/formatdata.h"
 #include "core/richtext/richdocument.h"
-#include "core/subtitleiterator.h"
 
 namespace SubtitleComposer {
 class SubStationAlphaOutputFormat : public OutputFormat
@@ -90,38 +89,41 @@ protected:
 		return data.mid(begin, end - begin + 1) + QStringLiteral("\n\n");
 	}
 
-	QString dumpSubtitles(const Subtitle &subtitle, bool primary) const override
+	void dumpSubtitles(const Subtitle &subtitle, bool primary, TextWriter &out) const override
 	{
 		FormatData *formatData = this->formatData(subtitle);
 
-		QString ret = normalizeBlock(formatData ? formatData->value(QStringLiteral("ScriptInfo")) : m_defaultScriptInfo)
-				+ normalizeBlock(formatData ? formatData->value(QStringLiteral("Styles")) : m_defaultStyles)
-				+ normalizeBlock(m_events);
+		out << normalizeBlock(formatData ? formatData->value(QStringLiteral("ScriptInfo")) : m_defaultScriptInfo)
+			<< normalizeBlock(formatData ? formatData->value(QStringLiteral("Styles")) : m_defaultStyles)
+			<< normalizeBlock(m_events);
 
-		for(SubtitleIterator it(subtitle); it.current(); ++it) {
-			const SubtitleLine *line = it.current();
+		dumpLinesParallel(subtitle.snapshot(), primary, out);
+	}
+
+	void dumpLines(const SubtitleSnapshot &snapshot, bool primary, int start, int end, TextWriter &out) const override
+	{
+		for(int i = start; i < end; i++) {
+			const LineSnapshot &line = snapshot.at(i);
 
-			const Time showTime = line->showTime();
+			const Time showTime = line.showTime();
 			const QString showTimeArg = QString::asprintf("%01d:%02d:%02d.%02d",
 												  showTime.hours(),
 												  showTime.minutes(),
 												  showTime.seconds(),
 												  (showTime.millis() + 5) / 10);
 
-			const Time hideTime = line->hideTime();
+			const Time hideTime = line.hideTime();
 			const QString hideTimeArg = QString::asprintf("%01d:%02d:%02d.%02d",
 												  hideTime.hours(),
 												  hideTime.minutes(),
 												  hideTime.seconds(),
 												  (hideTime.millis() + 5) / 10);
 
-			formatData = this->formatData(line);
+			const FormatData *formatData = this->formatData(line);
 
-			RichString stext = (primary ? line->primaryDoc() : line->secondaryDoc())->toRichText();
-			ret += QString(formatData ? formatData->value(QStringLiteral("Dialogue")) : m_dialogueBuilder)
-					.arg(showTimeArg, hideTimeArg, fromRichString(stext));
+			out << QString(formatData ? formatData->value(QStringLiteral("Dialogue")) : m_dialogueBuilder)
+					.arg(showTimeArg, hideTimeArg, fromRichString(line.text(primary)));
 		}
-		return ret;
 	}
 
 	SubStationAlphaOutputFormat(
@@ -150,20 +152,6 @@ protected:
 	static const char *s_dialogueBuilder;
 };
 
-const char *SubStationAlphaOutputFormat::s_defaultScriptInfo = "[Script Info]\n"
-		"Title: Untitled\n"
-		"ScriptType: V4.00\n"
-		"Collisions: Normal\n"
-		"Timer: 100\n"
-		"WrapStyle: 0\n";
-const char *SubStationAlphaOutputFormat::s_defaultStyles = "[V4 Styles]\n"
-		"Format: Name, Fontname, Fontsize, PrimaryColour, SecondaryColour, TertiaryColour, BackColour, "
-		"Bold, Italic, BorderStyle, Outline, Shadow, Alignment, MarginL, MarginR, MarginV, AlphaLevel, Encoding\n"
-		"Style: Default, Sans, 24, 16777215, 16777215, 16777215, 12632256, -1, 0, 1, 1, 1, 6, 30, 30, 415, 0, 0\n";
-const char *SubStationAlphaOutputFormat::s_events = "[Events]\n"
-		"Format: Marked, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n";
-const char *SubStationAlphaOutputFormat::s_dialogueBuilder = "Dialogue: Marked=0,%1,%2,Default,,0000,0000,0000,,%3\n";
-
 class AdvancedSubStationAlphaOutputFormat : public SubStationAlphaOutputFormat
 {
 	friend class FormatManager;
@@ -178,19 +166,6 @@ protected:
 	static const char *s_events;
 	static const char *s_dialogueBuilder;
 };
-
-const char *AdvancedSubStationAlphaOutputFormat::s_defaultScriptInfo = "[Script Info]\n"
-		"Title: Untitled\n"
-		"ScriptType: V4.00+\n"
-		"Collisions: Normal\n"
-		"Timer: 100\n"
-		"WrapStyle: 0\n";
-const char *AdvancedSubStationAlphaOutputFormat::s_defaultStyles = "[V4+ Styles]\n"
-		"Format: Name, Fontname, Fontsize, PrimaryColour, SecondaryColour, OutlineColour, BackColour, Bold, Italic, Underline, StrikeThrough, ScaleX, ScaleY, Spacing, Angle, BorderStyle, Outline, Shadow, Alignment, MarginL, MarginR, MarginV, Encoding\n"
-		"Style: Default, Sans, 16, &H00FFFFFF, &H00FFFFFF, &H00674436, &HFFFFFFF8, -1, 0, 0, 0, 100, 90, 0, 0, 1, 2.1, 0.5, 2, 15, 15, 15, 0\n";
-const char *AdvancedSubStationAlphaOutputFormat::s_events = "[Events]\n"
-		"Format: Layer, Start, End, Style, Actor, MarginL, MarginR, MarginV, Effect, Text\n";
-const char *AdvancedSubStationAlphaOutputFormat::s_dialogueBuilder = "Dialogue: 0,%1,%2,Default,,0000,0000,0000,,%3\n";
 }
 
 #endif
@@ -24,6 +24,12 @@ protected:
 		: InputFormat($("SubViewer 1.0"), QStringList($("sub")))
 	{}
 
+	int probe(const QString &head) const override
+	{
+		staticRE$(reProbe, "^\\[[0-2][0-9]:[0-5][0-9]:[0-5][0-9]\\]\n", REu | REm);
+		return head.contains(reProbe) ? ProbeCertain : ProbeNone;
+	}
+
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
 	{
 		staticRE$(reTime, "\\[([0-2][0-9]):([0-5][0-9]):([0-5][0-9])\\]\\n([^\n]*)\\n", REu);
@@ -31,6 +37,7 @@ protected:
 		if(!itTime.hasNext())
 			return false;
 
+		QList<SubtitleLine *> lines;
 		for(;;) {
 			QRegularExpressionMatch mTime = itTime.next();
 
@@ -44,10 +51,10 @@ protected:
 			const Time hideTime(mTime.captured(1).toInt(), mTime.captured(2).toInt(), mTime.captured(3).toInt(), 0);
 
 			SubtitleLine *l = new SubtitleLine(showTime, hideTime);
-			l->primaryDoc()->setPlainText(text);
-			subtitle.insertLine(l);
-
+			l->setPrimaryText(RichString(text));
+			lines.append(l);
 		}
+		subtitle.insertLines(lines);
 
 		return subtitle.count() > 0;
 	}
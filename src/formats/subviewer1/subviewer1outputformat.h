@@ -18,25 +18,23 @@ class SubViewer1OutputFormat : public OutputFormat
 	friend class FormatManager;
 
 protected:
-	QString dumpSubtitles(const Subtitle &subtitle, bool primary) const override
+	void dumpSubtitles(const Subtitle &subtitle, bool primary, TextWriter &out) const override
 	{
-		QString ret(QStringLiteral("[TITLE]\n\n[AUTHOR]\n\n[SOURCE]\n\n[PRG]\n\n[FILEPATH]\n\n[DELAY]\n0\n[CD TRACK]\n0\n[BEGIN]\n" "******** START SCRIPT ********\n"));
+		out << QStringLiteral("[TITLE]\n\n[AUTHOR]\n\n[SOURCE]\n\n[PRG]\n\n[FILEPATH]\n\n[DELAY]\n0\n[CD TRACK]\n0\n[BEGIN]\n" "******** START SCRIPT ********\n");
 
 		for(SubtitleIterator it(subtitle); it.current(); ++it) {
 			const SubtitleLine *line = it.current();
 
 			Time showTime = line->showTime();
-			ret += QString::asprintf("[%02d:%02d:%02d]\n", showTime.hours(), showTime.minutes(), showTime.seconds());
+			out << QString::asprintf("[%02d:%02d:%02d]\n", showTime.hours(), showTime.minutes(), showTime.seconds());
 
-			QString text = (primary ? line->primaryDoc() : line->secondaryDoc())->toPlainText();
-			ret += text.replace('\n', '|');
+			QString text = line->text(primary);
+			out << text.replace('\n', '|');
 
 			Time hideTime = line->hideTime();
-			ret += QString::asprintf("\n[%02d:%02d:%02d]\n\n", hideTime.hours(), hideTime.minutes(), hideTime.seconds());
+			out << QString::asprintf("\n[%02d:%02d:%02d]\n\n", hideTime.hours(), hideTime.minutes(), hideTime.seconds());
 		}
-		ret += "[END]\n" "******** END SCRIPT ********\n";
-
-		return ret;
+		out << "[END]\n" "******** END SCRIPT ********\n";
 	}
 
 	SubViewer1OutputFormat() :
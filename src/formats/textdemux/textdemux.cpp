@@ -70,7 +70,7 @@ TextDemux::onStreamData(const QString &text, quint64 msecStart, quint64 msecDura
 	stxt.setRichString(text);
 
 	SubtitleLine *line = new SubtitleLine(Time(double(msecStart)), Time(double(msecStart) + double(msecDuration)));
-	line->primaryDoc()->setPlainText(stxt);
+	line->setPrimaryText(stxt);
 	m_subtitleTemp->insertLine(line);
 }
 
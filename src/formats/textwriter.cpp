@@ -0,0 +1,86 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "textwriter.h"
+
+#include <QIODevice>
+#include <QTextCodec>
+
+using namespace SubtitleComposer;
+
+TextWriter::TextWriter(QString *string)
+	: m_text(string),
+	  m_device(nullptr),
+	  m_encoder(nullptr),
+	  m_lineBreak(LF),
+	  m_error(false)
+{
+}
+
+TextWriter::TextWriter(QIODevice *device, QTextCodec *codec, LineBreak lineBreak, bool byteOrderMark)
+	: m_text(&m_buffer),
+	  m_device(device),
+	  // BOM is written by us, codec must not add its own header on first chunk
+	  m_encoder(codec->makeEncoder(QTextCodec::IgnoreHeader)),
+	  m_lineBreak(lineBreak),
+	  m_error(false)
+{
+	m_buffer.reserve(BufferSize + BufferSize / 4);
+	if(byteOrderMark)
+		m_buffer.append(QChar::ByteOrderMark);
+}
+
+TextWriter::~TextWriter()
+{
+	flush();
+	delete m_encoder;
+}
+
+TextWriter &
+TextWriter::number(qint64 value, int width)
+{
+	QChar digits[24];
+	QChar *end = digits + sizeof(digits) / sizeof(*digits);
+	QChar *p = end;
+	const bool negative = value < 0;
+	quint64 v = negative ? quint64(0) - quint64(value) : quint64(value);
+	do {
+		*--p = QLatin1Char('0' + int(v % 10));
+		v /= 10;
+	} while(v);
+	while(end - p < width && p > digits + 1)
+		*--p = QLatin1Char('0');
+	if(negative)
+		*--p = QLatin1Char('-');
+	m_text->append(p, int(end - p));
+	return checkBuffer();
+}
+
+bool
+TextWriter::flush()
+{
+	if(!m_device || m_buffer.isEmpty())
+		return !m_error;
+
+	switch(m_lineBreak) {
+	case CRLF:
+		m_buffer.replace(QChar::LineFeed, QLatin1String("\r\n"));
+		break;
+	case CR:
+		m_buffer.replace(QChar::LineFeed, QChar::CarriageReturn);
+		break;
+	default:
+		break;
+	}
+
+	// encoder keeps its state between chunks, so surrogate pairs split at the buffer end are fine
+	const QByteArray data = m_encoder->fromUnicode(m_buffer);
+	if(m_device->write(data) != data.size())
+		m_error = true;
+	m_buffer.resize(0);
+
+	return !m_error;
+}
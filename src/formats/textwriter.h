@@ -0,0 +1,62 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef TEXTWRITER_H
+#define TEXTWRITER_H
+
+#include <QString>
+
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+QT_FORWARD_DECLARE_CLASS(QTextCodec)
+QT_FORWARD_DECLARE_CLASS(QTextEncoder)
+
+namespace SubtitleComposer {
+
+// Sink that output formats write their text into. Text is collected into a small buffer which
+// gets line breaks translated, encoded and written to the device whenever it fills up, so the
+// whole file never has to be held in memory. Without a device text is appended to a string.
+class TextWriter
+{
+public:
+	enum LineBreak { LF, CRLF, CR };
+
+	explicit TextWriter(QString *string);
+	TextWriter(QIODevice *device, QTextCodec *codec, LineBreak lineBreak = LF, bool byteOrderMark = false);
+	~TextWriter();
+
+	inline TextWriter & operator<<(const QString &text) { m_text->append(text); return checkBuffer(); }
+	inline TextWriter & operator<<(QLatin1String text) { m_text->append(text); return checkBuffer(); }
+	inline TextWriter & operator<<(const char *text) { m_text->append(QLatin1String(text)); return checkBuffer(); }
+	inline TextWriter & operator<<(QChar ch) { m_text->append(ch); return checkBuffer(); }
+	inline TextWriter & operator<<(QChar::SpecialCharacter ch) { m_text->append(QChar(ch)); return checkBuffer(); }
+	inline TextWriter & operator<<(char ch) { m_text->append(QLatin1Char(ch)); return checkBuffer(); }
+	inline TextWriter & operator<<(int value) { return number(value); }
+	inline TextWriter & operator<<(long value) { return number(value); }
+
+	// writes decimal value zero padded to at least width digits
+	TextWriter & number(qint64 value, int width = 0);
+
+	bool flush();
+	inline bool hasError() const { return m_error; }
+
+private:
+	enum { BufferSize = 64 * 1024 };
+
+	TextWriter(const TextWriter &) = delete;
+	TextWriter & operator=(const TextWriter &) = delete;
+
+	inline TextWriter & checkBuffer() { if(m_device && m_text->size() >= BufferSize) flush(); return *this; }
+
+	QString *m_text;
+	QString m_buffer;
+	QIODevice *m_device;
+	QTextEncoder *m_encoder;
+	LineBreak m_lineBreak;
+	bool m_error;
+};
+}
+
+#endif // TEXTWRITER_H
@@ -22,22 +22,30 @@ class TMPlayerInputFormat : public InputFormat
 	friend class FormatManager;
 
 protected:
-	TMPlayerInputFormat(const QString &name, const QStringList &extensions, const QString &re)
+	TMPlayerInputFormat(const QString &name, const QStringList &extensions, const QString &re, const QString &reProbe)
 		: InputFormat(name, extensions),
-		  m_reTime(re)
+		  m_reTime(re),
+		  m_reProbe(reProbe, REu | REm)
 	{}
 
 	TMPlayerInputFormat()
 		: TMPlayerInputFormat($("TMPlayer"), QStringList() << $("sub") << $("txt"),
-							  $("([0-2]?[0-9]):([0-5][0-9]):([0-5][0-9]):([^\n]*)\n?"))
+							  $("([0-2]?[0-9]):([0-5][0-9]):([0-5][0-9]):([^\n]*)\n?"),
+							  $("^[0-2]?[0-9]:[0-5][0-9]:[0-5][0-9]:"))
 	{}
 
+	int probe(const QString &head) const override
+	{
+		return head.contains(m_reProbe) ? ProbeCertain : ProbeNone;
+	}
+
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
 	{
 		QRegularExpressionMatchIterator itTime = m_reTime.globalMatch(data);
 		if(!itTime.hasNext())
 			return false;
 
+		QList<SubtitleLine *> lines;
 		do {
 			QRegularExpressionMatch mTime = itTime.next();
 
@@ -58,14 +66,16 @@ protected:
 			}
 
 			SubtitleLine *l = new SubtitleLine(showTime, hideTime);
-			l->primaryDoc()->setPlainText(text);
-			subtitle.insertLine(l);
+			l->setPrimaryText(RichString(text));
+			lines.append(l);
 		} while(itTime.hasNext());
+		subtitle.insertLines(lines);
 
 		return subtitle.count() > 0;
 	}
 
 	QRegularExpression m_reTime;
+	QRegularExpression m_reProbe;
 };
 
 class TMPlayerPlusInputFormat : public TMPlayerInputFormat
@@ -75,7 +85,8 @@ class TMPlayerPlusInputFormat : public TMPlayerInputFormat
 protected:
 	TMPlayerPlusInputFormat()
 		: TMPlayerInputFormat($("TMPlayer+"), QStringList() << $("sub") << $("txt"),
-							  $("([0-2]?[0-9]):([0-5][0-9]):([0-5][0-9])=([^\n]*)\n?"))
+							  $("([0-2]?[0-9]):([0-5][0-9]):([0-5][0-9])=([^\n]*)\n?"),
+							  $("^[0-2]?[0-9]:[0-5][0-9]:[0-5][0-9]="))
 	{}
 };
 }
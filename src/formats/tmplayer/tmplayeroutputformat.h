@@ -18,28 +18,25 @@ class TMPlayerOutputFormat : public OutputFormat
 	friend class FormatManager;
 
 protected:
-	QString dumpSubtitles(const Subtitle &subtitle, bool primary) const override
+	void dumpSubtitles(const Subtitle &subtitle, bool primary, TextWriter &out) const override
 	{
-		QString ret;
-
 		for(SubtitleIterator it(subtitle); it.current(); ++it) {
 			const SubtitleLine *line = it.current();
 
 			Time showTime = line->showTime();
-			ret += QString::asprintf(m_timeFormat, showTime.hours(), showTime.minutes(), showTime.seconds());
+			out << QString::asprintf(m_timeFormat, showTime.hours(), showTime.minutes(), showTime.seconds());
 
-			QString text = (primary ? line->primaryDoc() : line->secondaryDoc())->toPlainText();
-			ret += text.replace('\n', '|');
-			ret += '\n';
+			QString text = line->text(primary);
+			out << text.replace('\n', '|');
+			out << '\n';
 
 			// We behave like Subtitle Workshop here: to compensate for the lack of hide time
 			// indication provisions in the format we add an empty line with the hide time.
 			Time hideTime = line->hideTime();
-			ret += QString::asprintf(m_timeFormat, hideTime.hours(), hideTime.minutes(), hideTime.seconds());
+			out << QString::asprintf(m_timeFormat, hideTime.hours(), hideTime.minutes(), hideTime.seconds());
 
-			ret += '\n';
+			out << '\n';
 		}
-		return ret;
 	}
 
 	TMPlayerOutputFormat() :
@@ -17,6 +17,7 @@
 
 #include <QUrl>
 #include <QFile>
+#include <QFileInfo>
 #include <QStringView>
 
 namespace SubtitleComposer {
@@ -39,6 +40,10 @@ public:
 				filename = filenameIdx;
 		}
 
+		// every file is offered to binary formats first, don't run text subtitles through the demuxer
+		if(!probeBinary(filename))
+			return FormatManager::ERROR;
+
 		// open the sub/idx subtitles
 		StreamProcessor proc;
 		if(!proc.open(filename))
@@ -82,7 +87,7 @@ public:
 		quint32 ppFlags = dlgInit.postProcessingFlags();
 		for(int i = 0, n = subtitle.count(); i < n; i++) {
 			SubtitleLine *line = subtitle.at(i);
-			RichString text = line->primaryDoc()->toRichText();
+			RichString text = line->primaryText();
 			if(ppFlags & VobSubInputInitDialog::APOSTROPHE_TO_QUOTES)
 				text
 					.replace(QRegularExpression(QStringLiteral("(?:"
@@ -147,7 +152,7 @@ public:
 
 			// cleanup whitespace
 			text.replace(QRegularExpression(QStringLiteral("(?: *(?=\\n)|(?<=\\n) *|^ *| *$| *(?= )|(?<= ) *)")), QStringLiteral(""));
-			line->primaryDoc()->setRichText(text, true);
+			line->setPrimaryText(text);
 		}
 
 		// restore original subtitle
@@ -162,6 +167,21 @@ protected:
 		return false;
 	}
 
+	bool probeBinary(const QString &filename) const
+	{
+		if(knowsExtension(QFileInfo(filename).suffix()))
+			return true;
+
+		QFile file(filename);
+		if(!file.open(QIODevice::ReadOnly))
+			return false;
+		const QByteArray head = file.read(32);
+		return head.startsWith("# VobSub index file")
+			|| head.startsWith(QByteArray("\x00\x00\x01\xba", 4)) // MPEG program stream
+			|| head.startsWith("\x1a\x45\xdf\xa3") // Matroska/EBML
+			|| head.mid(4, 4) == "ftyp"; // MP4
+	}
+
 	VobSubInputFormat()
 		: InputFormat(QStringLiteral("DVD/BluRay Subpicture"), QStringList{
 					  QStringLiteral("idx"),
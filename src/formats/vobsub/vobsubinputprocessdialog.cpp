@@ -702,7 +702,7 @@ VobSubInputProcessDialog::processNextPiece()
 			l = new SubtitleLine((*m_frameCurrent)->subShowTime, (*m_frameCurrent)->subHideTime);
 			m_subtitle->insertLine(l);
 		}
-		l->primaryDoc()->setRichText(subText);
+		l->setPrimaryText(subText);
 
 		ui->grpText->setDisabled(true);
 		ui->grpNavButtons->setDisabled(true);
@@ -212,6 +212,12 @@ parseCueSettings(SubtitleLine *line, QStringView_ css)
 	line->setPosition(p);
 }
 
+int
+WebVTTInputFormat::probe(const QString &head) const
+{
+	return head.startsWith($("WEBVTT")) ? ProbeCertain : ProbeNone;
+}
+
 bool
 WebVTTInputFormat::parseSubtitles(Subtitle &subtitle, const QString &data) const
 {
@@ -230,6 +236,7 @@ WebVTTInputFormat::parseSubtitles(Subtitle &subtitle, const QString &data) const
 	subtitle.stylesheetClear();
 
 	// https://w3c.github.io/webvtt/
+	QList<SubtitleLine *> lines;
 	while(off < data.length()) {
 		if(QStringView(data).mid(off, 5) == $("STYLE")) {
 			if(!notes.isEmpty()) { // store note before style
@@ -265,6 +272,7 @@ WebVTTInputFormat::parseSubtitles(Subtitle &subtitle, const QString &data) const
 		QRegularExpressionMatch m = reTime.match(cueTime);
 		if(!m.isValid()) {
 			qWarning() << "Invalid WEBVTT subtitle";
+			qDeleteAll(lines);
 			return false;
 		}
 
@@ -283,7 +291,7 @@ WebVTTInputFormat::parseSubtitles(Subtitle &subtitle, const QString &data) const
 		// TODO: handle pseudo classes
 		// https://developer.mozilla.org/en-US/docs/Web/API/WebVTT_API#css_pseudo-classes
 		stext.setRichString(cueText.toString());
-		line->primaryDoc()->setRichText(stext, true);
+		line->setPrimaryText(stext);
 
 		if(!notes.isEmpty()) {
 			QString comment;
@@ -299,8 +307,9 @@ WebVTTInputFormat::parseSubtitles(Subtitle &subtitle, const QString &data) const
 			parseCueSettings(line, cueSettings);
 		if(!cueId.isEmpty())
 			line->meta("id", cueId.toString());
-		subtitle.insertLine(line);
+		lines.append(line);
 	}
+	subtitle.insertLines(lines);
 
 	if(!notes.isEmpty()) {
 		int noteId = 0;
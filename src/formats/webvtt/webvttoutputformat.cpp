@@ -7,7 +7,6 @@
 #include "webvttoutputformat.h"
 
 #include "core/richtext/richdocument.h"
-#include "core/subtitleiterator.h"
 #include "helpers/common.h"
 
 #include <QRegularExpression>
@@ -26,100 +25,103 @@ fixEmptyLines(QString str)
 	return str.replace(reEmptyLine, $("\n "));
 }
 
-QString
-WebVTTOutputFormat::dumpSubtitles(const Subtitle &subtitle, bool primary) const
+void
+WebVTTOutputFormat::dumpSubtitles(const Subtitle &subtitle, bool primary, TextWriter &out) const
 {
-	QString ret;
-
-	ret += $("WEBVTT");
-	ret.append(QChar::LineFeed);
+	out << $("WEBVTT");
+	out << QChar::LineFeed;
 	const QString &intro = fixEmptyLines(subtitle.meta("comment.intro.0"));
 	if(!intro.isEmpty()) {
-		ret.append(intro);
-		ret.append(QChar::LineFeed);
+		out << intro;
+		out << QChar::LineFeed;
 	}
-	ret.append(QChar::LineFeed);
+	out << QChar::LineFeed;
 
 	for(int noteId = 0;;) {
 		const QByteArray key(QByteArray("comment.top.") + QByteArray::number(noteId++));
 		if(!subtitle.metaExists(key))
 			break;
-		ret.append($("NOTE"));
-		ret.append(QChar::LineFeed);
-		ret.append(fixEmptyLines(subtitle.meta(key)));
-		ret.append(QChar::LineFeed);
-		ret.append(QChar::LineFeed);
+		out << $("NOTE");
+		out << QChar::LineFeed;
+		out << fixEmptyLines(subtitle.meta(key));
+		out << QChar::LineFeed;
+		out << QChar::LineFeed;
 	}
 
 	if(!subtitle.stylesheet()->unformattedCSS().isEmpty()) {
-		ret.append($("STYLE"));
-		ret.append(QChar::LineFeed);
-		ret.append(fixEmptyLines(subtitle.stylesheet()->unformattedCSS()));
-		ret.append(QChar::LineFeed);
-		ret.append(QChar::LineFeed);
+		out << $("STYLE");
+		out << QChar::LineFeed;
+		out << fixEmptyLines(subtitle.stylesheet()->unformattedCSS());
+		out << QChar::LineFeed;
+		out << QChar::LineFeed;
 	}
 
-	for(SubtitleIterator it(subtitle); it.current(); ++it) {
-		const SubtitleLine *line = it.current();
+	dumpLinesParallel(subtitle.snapshot(), primary, out);
+}
+
+void
+WebVTTOutputFormat::dumpLines(const SubtitleSnapshot &snapshot, bool primary, int start, int end, TextWriter &out) const
+{
+	for(int i = start; i < end; i++) {
+		const LineSnapshot &line = snapshot.at(i);
 
-		const QString &comment = line->meta("comment");
+		const QString &comment = line.meta("comment");
 		if(!comment.isEmpty()) {
-			ret.append($("NOTE"));
-			ret.append(comment.contains(QChar::LineFeed) ? QChar::LineFeed : QChar::Space);
-			ret.append(fixEmptyLines(comment));
-			ret.append(QChar::LineFeed);
-			ret.append(QChar::LineFeed);
+			out << $("NOTE");
+			out << (comment.contains(QChar::LineFeed) ? QChar::LineFeed : QChar::Space);
+			out << fixEmptyLines(comment);
+			out << QChar::LineFeed;
+			out << QChar::LineFeed;
 		}
 
-		const QString &cueId = line->meta("id");
+		const QString &cueId = line.meta("id");
 		if(!cueId.isEmpty()) {
-			ret.append(cueId);
-			ret.append(QChar::LineFeed);
+			out << cueId;
+			out << QChar::LineFeed;
 		}
 
-		const Time showTime = line->showTime();
-		const Time hideTime = line->hideTime();
-		ret += QString::asprintf("%02d:%02d:%02d.%03d --> %02d:%02d:%02d.%03d",
+		const Time showTime = line.showTime();
+		const Time hideTime = line.hideTime();
+		out << QString::asprintf("%02d:%02d:%02d.%03d --> %02d:%02d:%02d.%03d",
 					showTime.hours(), showTime.minutes(), showTime.seconds(), showTime.millis(),
 					hideTime.hours(), hideTime.minutes(), hideTime.seconds(), hideTime.millis());
-		const SubtitleRect &p = line->pos();
+		const SubtitleRect &p = line.pos();
 		// FIXME: consider hAlign/vAlign in rect calculations
 		// FIXME: position/line can have extra alignment/anchor parameter
 		if(p.vertical) {
-			ret.append($(" vertical:lr")); // FIXME: RTL support (vertical:rl)
+			out << $(" vertical:lr"); // FIXME: RTL support (vertical:rl)
 			const int top = p.top;
 			const int left = p.left;
 			const int height = int(p.bottom) - top;
 			if(left) // FIXME: with vertical:rl should be right
-				ret.append(QString::asprintf(" line:%02d%%", left));
+				out << QString::asprintf(" line:%02d%%", left);
 			if(top)
-				ret.append(QString::asprintf(" position:%02d%%", top));
+				out << QString::asprintf(" position:%02d%%", top);
 			if(height != 100)
-				ret.append(QString::asprintf(" size:%02d%%", height));
+				out << QString::asprintf(" size:%02d%%", height);
 		} else {
 			const int top = p.top;
 			const int left = p.left;
 			const int width = int(p.right) - left;
 			if(top)
-				ret.append(QString::asprintf(" line:%02d%%", top));
+				out << QString::asprintf(" line:%02d%%", top);
 			if(left)
-				ret.append(QString::asprintf(" position:%02d%%", left));
+				out << QString::asprintf(" position:%02d%%", left);
 			if(width != 100)
-				ret.append(QString::asprintf(" size:%02d%%", width));
+				out << QString::asprintf(" size:%02d%%", width);
 		}
 		if(p.hAlign == SubtitleRect::START)
-			ret.append(QLatin1String(" align:start"));
+			out << QLatin1String(" align:start");
 		else if(p.hAlign == SubtitleRect::END)
-			ret.append(QLatin1String(" align:end"));
-		ret.append(QChar::LineFeed);
+			out << QLatin1String(" align:end");
+		out << QChar::LineFeed;
 
-		const RichString text = (primary ? line->primaryDoc() : line->secondaryDoc())->toRichText();
-		ret += text.richString()
+		const RichString text = line.text(primary);
+		out << text.richString()
 				.replace(QLatin1String("&amp;"), QLatin1String("&"))
 				.replace(QLatin1String("&lt;"), QLatin1String("<"))
 				.replace(QLatin1String("&gt;"), QLatin1String(">"));
 
-		ret += $("\n\n");
+		out << $("\n\n");
 	}
-	return ret;
 }
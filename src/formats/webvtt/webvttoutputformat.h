@@ -15,7 +15,8 @@ class WebVTTOutputFormat : public OutputFormat
 	friend class FormatManager;
 
 protected:
-	QString dumpSubtitles(const Subtitle &subtitle, bool primary) const override;
+	void dumpSubtitles(const Subtitle &subtitle, bool primary, TextWriter &out) const override;
+	void dumpLines(const SubtitleSnapshot &snapshot, bool primary, int start, int end, TextWriter &out) const override;
 
 	WebVTTOutputFormat();
 };
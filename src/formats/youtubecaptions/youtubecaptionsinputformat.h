@@ -24,6 +24,12 @@ protected:
 		: InputFormat($("YouTube Captions"), QStringList($("sbv")))
 	{}
 
+	int probe(const QString &head) const override
+	{
+		staticRE$(reProbe, "^\\d+:[0-5][0-9]:[0-5][0-9][,\\.][0-9]{3},\\d+:[0-5][0-9]:[0-5][0-9][,\\.][0-9]{3}\n", REu | REm);
+		return head.contains(reProbe) ? ProbeCertain : ProbeNone;
+	}
+
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
 	{
 		staticRE$(reTime,
@@ -34,6 +40,7 @@ protected:
 		if(!it.hasNext())
 			return false;
 
+		QList<SubtitleLine *> lines;
 		do {
 			QRegularExpressionMatch tm = it.next();
 			const Time showTime(tm.captured(2).toInt(), tm.captured(3).toInt(), tm.captured(4).toInt(), tm.captured(5).toInt());
@@ -46,9 +53,10 @@ protected:
 			// if so, does it use standard HTML style tags?
 
 			SubtitleLine *l = new SubtitleLine(showTime, hideTime);
-			l->primaryDoc()->setHtml(text, true);
-			subtitle.insertLine(l);
+			l->setPrimaryText(RichString::fromRichString(text));
+			lines.append(l);
 		} while(it.hasNext());
+		subtitle.insertLines(lines);
 
 		return subtitle.count() > 0;
 	}
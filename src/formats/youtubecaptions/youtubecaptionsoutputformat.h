@@ -19,27 +19,24 @@ class YouTubeCaptionsOutputFormat : public OutputFormat
 	friend class FormatManager;
 
 protected:
-	QString dumpSubtitles(const Subtitle &subtitle, bool primary) const override
+	void dumpSubtitles(const Subtitle &subtitle, bool primary, TextWriter &out) const override
 	{
-		QString ret;
-
 		for(SubtitleIterator it(subtitle); it.current(); ++it) {
 			const SubtitleLine *ln = it.current();
 			const Time ts = ln->showTime();
 			const Time th = ln->hideTime();
-			ret += QString::asprintf("%d:%02d:%02d.%03d,%d:%02d:%02d.%03d\n",
+			out << QString::asprintf("%d:%02d:%02d.%03d,%d:%02d:%02d.%03d\n",
 				ts.hours(), ts.minutes(), ts.seconds(), ts.millis(),
 				th.hours(), th.minutes(), th.seconds(), th.millis());
 
-			const RichString text = (primary ? ln->primaryDoc() : ln->secondaryDoc())->toRichText();
+			const RichString text = ln->text(primary);
 
 			// TODO does the format actually supports styled text?
 			// if so, does it use standard HTML style tags?
-			ret += text.richString();
+			out << text.richString();
 
-			ret += $("\n\n");
+			out << $("\n\n");
 		}
-		return ret;
 	}
 
 	YouTubeCaptionsOutputFormat()
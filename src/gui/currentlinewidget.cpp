@@ -406,6 +406,10 @@ CurrentLineWidget::setCurrentLine(SubtitleLine *line)
 {
 	if(m_currentLine) {
 		disconnect(m_currentLine, nullptr, this, nullptr);
+		for(SimpleRichTextEdit *edit: m_textEdits) {
+			if(RichDocument *doc = qobject_cast<RichDocument *>(edit->document()))
+				doc->detachView();
+		}
 	}
 
 	m_currentLine = line;
@@ -418,6 +422,7 @@ CurrentLineWidget::setCurrentLine(SubtitleLine *line)
 		if(m_textEdits[0]->isReadOnly())
 			m_textEdits[0]->setReadOnly(false);
 		doc->setDefaultFont(QFont());
+		doc->attachView();
 		m_textEdits[0]->setDocument(doc);
 		connect(m_currentLine, &SubtitleLine::primaryTextChanged, this, &CurrentLineWidget::updateLabels);
 
@@ -425,6 +430,7 @@ CurrentLineWidget::setCurrentLine(SubtitleLine *line)
 		if(m_textEdits[1]->isReadOnly())
 			m_textEdits[1]->setReadOnly(false);
 		doc->setDefaultFont(QFont());
+		doc->attachView();
 		m_textEdits[1]->setDocument(doc);
 		connect(m_currentLine, &SubtitleLine::secondaryTextChanged, this, &CurrentLineWidget::updateLabels);
 
@@ -103,8 +103,6 @@ private:
 	bool m_translationMode;
 	bool m_showTranslation;
 	SubtitleLine *m_playingLine = nullptr;
-	SubtitleLine *m_prevLine = nullptr;
-	SubtitleLine *m_nextLine = nullptr;
 
 	const SubtitleLine *m_pauseAfterPlayingLine;
 
@@ -57,13 +57,19 @@ LinesModel::setSubtitle(Subtitle *subtitle)
 			disconnect(m_subtitle.constData(), &Subtitle::linesInserted, this, &LinesModel::onLinesInserted);
 			disconnect(m_subtitle.constData(), &Subtitle::linesAboutToBeRemoved, this, &LinesModel::onLinesAboutToRemove);
 			disconnect(m_subtitle.constData(), &Subtitle::linesRemoved, this, &LinesModel::onLinesRemoved);
+			disconnect(m_subtitle.constData(), &Subtitle::linesAboutToBeReordered, this, &LinesModel::onLinesAboutToReorder);
+			disconnect(m_subtitle.constData(), &Subtitle::linesReordered, this, &LinesModel::onLinesReordered);
 
 			disconnect(m_subtitle.constData(), &Subtitle::lineAnchorChanged, this, &LinesModel::onLineChanged);
 			disconnect(m_subtitle.constData(), &Subtitle::lineErrorFlagsChanged, this, &LinesModel::onLineChanged);
 			disconnect(m_subtitle.constData(), &Subtitle::linePrimaryTextChanged, this, &LinesModel::onLineChanged);
+			disconnect(m_subtitle.constData(), &Subtitle::linesPrimaryTextChanged, this, &LinesModel::onLinesRangeChanged);
 			disconnect(m_subtitle.constData(), &Subtitle::lineSecondaryTextChanged, this, &LinesModel::onLineChanged);
+			disconnect(m_subtitle.constData(), &Subtitle::linesSecondaryTextChanged, this, &LinesModel::onLinesRangeChanged);
 			disconnect(m_subtitle.constData(), &Subtitle::lineShowTimeChanged, this, &LinesModel::onLineChanged);
+			disconnect(m_subtitle.constData(), &Subtitle::linesShowTimeChanged, this, &LinesModel::onLinesRangeChanged);
 			disconnect(m_subtitle.constData(), &Subtitle::lineHideTimeChanged, this, &LinesModel::onLineChanged);
+			disconnect(m_subtitle.constData(), &Subtitle::linesHideTimeChanged, this, &LinesModel::onLinesRangeChanged);
 
 			disconnect(m_subtitle->stylesheet(), &RichCSS::changed, this, &LinesModel::onLinesChanged);
 
@@ -83,13 +89,19 @@ LinesModel::setSubtitle(Subtitle *subtitle)
 			connect(m_subtitle.constData(), &Subtitle::linesInserted, this, &LinesModel::onLinesInserted);
 			connect(m_subtitle.constData(), &Subtitle::linesAboutToBeRemoved, this, &LinesModel::onLinesAboutToRemove);
 			connect(m_subtitle.constData(), &Subtitle::linesRemoved, this, &LinesModel::onLinesRemoved);
+			connect(m_subtitle.constData(), &Subtitle::linesAboutToBeReordered, this, &LinesModel::onLinesAboutToReorder);
+			connect(m_subtitle.constData(), &Subtitle::linesReordered, this, &LinesModel::onLinesReordered);
 
 			connect(m_subtitle.constData(), &Subtitle::lineAnchorChanged, this, &LinesModel::onLineChanged);
 			connect(m_subtitle.constData(), &Subtitle::lineErrorFlagsChanged, this, &LinesModel::onLineChanged);
 			connect(m_subtitle.constData(), &Subtitle::linePrimaryTextChanged, this, &LinesModel::onLineChanged);
+			connect(m_subtitle.constData(), &Subtitle::linesPrimaryTextChanged, this, &LinesModel::onLinesRangeChanged);
 			connect(m_subtitle.constData(), &Subtitle::lineSecondaryTextChanged, this, &LinesModel::onLineChanged);
+			connect(m_subtitle.constData(), &Subtitle::linesSecondaryTextChanged, this, &LinesModel::onLinesRangeChanged);
 			connect(m_subtitle.constData(), &Subtitle::lineShowTimeChanged, this, &LinesModel::onLineChanged);
+			connect(m_subtitle.constData(), &Subtitle::linesShowTimeChanged, this, &LinesModel::onLinesRangeChanged);
 			connect(m_subtitle.constData(), &Subtitle::lineHideTimeChanged, this, &LinesModel::onLineChanged);
+			connect(m_subtitle.constData(), &Subtitle::linesHideTimeChanged, this, &LinesModel::onLinesRangeChanged);
 
 			connect(m_subtitle->stylesheet(), &RichCSS::changed, this, &LinesModel::onLinesChanged);
 		}
@@ -302,6 +314,8 @@ LinesModel::onLinesInserted(int firstIndex, int lastIndex)
 		QSignalBlocker s(sm);
 		sm->clear();
 	}
+	// selection was cleared silently and rows are only reported by the deferred model reset
+	lw->invalidateSelectionRanges();
 	m_resetModelTimer->start();
 }
 
@@ -317,9 +331,54 @@ LinesModel::onLinesRemoved(int firstIndex, int lastIndex)
 {
 	Q_UNUSED(firstIndex);
 	Q_UNUSED(lastIndex);
+	// cached selection ranges point to old indexes until the deferred model reset
+	static_cast<LinesWidget *>(parent())->invalidateSelectionRanges();
 	m_resetModelTimer->start();
 }
 
+void
+LinesModel::onLinesAboutToReorder(int firstIndex, int lastIndex)
+{
+	Q_UNUSED(firstIndex);
+	Q_UNUSED(lastIndex);
+
+	// pending model reset will take care of everything
+	m_layoutChanging = !m_resetModelTimer->isActive();
+	if(!m_layoutChanging)
+		return;
+
+	emit layoutAboutToBeChanged();
+
+	m_layoutPersistentIndexes = persistentIndexList();
+	m_layoutPersistentLines.clear();
+	m_layoutPersistentLines.reserve(m_layoutPersistentIndexes.size());
+	for(const QModelIndex &idx : qAsConst(m_layoutPersistentIndexes))
+		m_layoutPersistentLines.push_back(m_subtitle->line(idx.row()));
+}
+
+void
+LinesModel::onLinesReordered(int firstIndex, int lastIndex)
+{
+	Q_UNUSED(firstIndex);
+	Q_UNUSED(lastIndex);
+
+	if(!m_layoutChanging)
+		return;
+	m_layoutChanging = false;
+
+	QModelIndexList to;
+	to.reserve(m_layoutPersistentIndexes.size());
+	for(int i = 0, n = m_layoutPersistentIndexes.size(); i < n; i++) {
+		const SubtitleLine *line = m_layoutPersistentLines.at(i);
+		to.push_back(line ? index(line->index(), m_layoutPersistentIndexes.at(i).column()) : QModelIndex());
+	}
+	changePersistentIndexList(m_layoutPersistentIndexes, to);
+	m_layoutPersistentIndexes.clear();
+	m_layoutPersistentLines.clear();
+
+	emit layoutChanged();
+}
+
 void
 LinesModel::onModelReset()
 {
@@ -379,6 +438,24 @@ LinesModel::onLineChanged(const SubtitleLine *line)
 	}
 }
 
+void
+LinesModel::onLinesRangeChanged(const RangeList &ranges)
+{
+	const int firstIndex = ranges.firstIndex();
+	const int lastIndex = ranges.lastIndex();
+
+	if(m_minChangedLineIndex < 0) {
+		m_minChangedLineIndex = firstIndex;
+		m_maxChangedLineIndex = lastIndex;
+		m_dataChangedTimer->start();
+	} else {
+		if(firstIndex < m_minChangedLineIndex)
+			m_minChangedLineIndex = firstIndex;
+		if(lastIndex > m_maxChangedLineIndex)
+			m_maxChangedLineIndex = lastIndex;
+	}
+}
+
 void
 LinesModel::onLinesChanged()
 {
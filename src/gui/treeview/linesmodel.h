@@ -16,6 +16,7 @@
 namespace SubtitleComposer {
 class Subtitle;
 class SubtitleLine;
+class RangeList;
 
 class LinesModel : public QAbstractListModel
 {
@@ -54,9 +55,12 @@ private slots:
 	void onLinesInserted(int firstIndex, int lastIndex);
 	void onLinesAboutToRemove(int firstIndex, int lastIndex);
 	void onLinesRemoved(int firstIndex, int lastIndex);
+	void onLinesAboutToReorder(int firstIndex, int lastIndex);
+	void onLinesReordered(int firstIndex, int lastIndex);
 	void onModelReset();
 
 	void onLineChanged(const SubtitleLine *line);
+	void onLinesRangeChanged(const RangeList &ranges);
 	void onLinesChanged();
 	void emitDataChanged();
 
@@ -72,6 +76,9 @@ private:
 	QTimer *m_resetModelTimer;
 	std::pair<const SubtitleLine *, const SubtitleLine *> m_resetModelSelection;
 	bool m_resetModelResumeEditing;
+	bool m_layoutChanging = false;
+	QModelIndexList m_layoutPersistentIndexes;
+	QVector<const SubtitleLine *> m_layoutPersistentLines;
 
 	friend class LinesWidget;
 };
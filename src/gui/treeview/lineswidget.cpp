@@ -35,7 +35,8 @@ LinesWidget::LinesWidget(QWidget *parent)
 	  m_translationMode(false),
 	  m_showingContextMenu(false),
 	  m_itemsDelegate(new LinesItemDelegate(this)),
-	  m_inlineEditor(nullptr)
+	  m_inlineEditor(nullptr),
+	  m_selectionRangesValid(false)
 {
 	setModel(new LinesModel(this));
 	selectionModel()->deleteLater();
@@ -67,6 +68,12 @@ LinesWidget::LinesWidget(QWidget *parent)
 	viewport()->installEventFilter(this);
 
 	connect(selectionModel(), &QItemSelectionModel::currentRowChanged, this, &LinesWidget::onCurrentRowChanged);
+	connect(selectionModel(), &QItemSelectionModel::selectionChanged, this, &LinesWidget::invalidateSelectionRanges);
+	// inserted/removed rows move the selection without emitting selectionChanged
+	connect(model(), &QAbstractItemModel::rowsInserted, this, &LinesWidget::invalidateSelectionRanges);
+	connect(model(), &QAbstractItemModel::rowsRemoved, this, &LinesWidget::invalidateSelectionRanges);
+	connect(model(), &QAbstractItemModel::layoutChanged, this, &LinesWidget::invalidateSelectionRanges);
+	connect(model(), &QAbstractItemModel::modelReset, this, &LinesWidget::invalidateSelectionRanges);
 }
 
 LinesWidget::~LinesWidget()
@@ -233,14 +240,24 @@ LinesWidget::selectionHasMultipleRanges() const
 RangeList
 LinesWidget::selectionRanges() const
 {
-	RangeList ranges;
+	if(m_selectionRangesValid)
+		return m_selectionRanges;
+
+	m_selectionRanges.clear();
 
 	const QItemSelection &selection = selectionModel()->selection();
 	for(const QItemSelectionRange &r : selection) {
-		ranges << Range(r.top(), r.bottom());
+		m_selectionRanges << Range(r.top(), r.bottom());
 	}
+	m_selectionRangesValid = true;
+
+	return m_selectionRanges;
+}
 
-	return ranges;
+void
+LinesWidget::invalidateSelectionRanges()
+{
+	m_selectionRangesValid = false;
 }
 
 RangeList
@@ -409,7 +426,7 @@ LinesWidget::contextMenuEvent(QContextMenuEvent *e)
 	menu.addMenu(&textsMenu);
 
 	QMenu stylesMenu(i18n("Styles"));
-	const int styleFlags = subLine ? subLine->primaryDoc()->cummulativeStyleFlags() | subLine->secondaryDoc()->cummulativeStyleFlags() : 0;
+	const int styleFlags = subLine ? subLine->primaryText().cummulativeStyleFlags() | subLine->secondaryText().cummulativeStyleFlags() : 0;
 	addAppAction(&stylesMenu, ACT_TOGGLE_SELECTED_LINES_BOLD, true, styleFlags & RichString::Bold);
 	addAppAction(&stylesMenu, ACT_TOGGLE_SELECTED_LINES_ITALIC, true, styleFlags & RichString::Italic);
 	addAppAction(&stylesMenu, ACT_TOGGLE_SELECTED_LINES_UNDERLINE, true, styleFlags & RichString::Underline);
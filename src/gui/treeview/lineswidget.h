@@ -74,6 +74,7 @@ private:
 
 private slots:
 	void onCurrentRowChanged();
+	void invalidateSelectionRanges();
 
 private:
 	bool m_scrollFollowsModel;
@@ -84,6 +85,10 @@ private:
 	LinesItemDelegate *m_itemsDelegate;
 	QWidget *m_inlineEditor;
 
+	// selection ranges are queried on every waveform repaint, rebuild them only when selection or rows change
+	mutable RangeList m_selectionRanges;
+	mutable bool m_selectionRangesValid;
+
 	friend class LinesWidgetScrollToModelDetacher;
 	friend class LinesModel;
 	friend class LinesItemDelegate;
@@ -60,6 +60,8 @@ RichLineEdit::RichLineEdit(const QStyleOptionViewItem &styleOption, QWidget *par
 
 RichLineEdit::~RichLineEdit()
 {
+	if(m_document)
+		m_document->detachView();
 	delete m_control;
 }
 
@@ -157,7 +159,11 @@ RichLineEdit::setupActions()
 void
 RichLineEdit::setDocument(RichDocument *document)
 {
+	if(m_document)
+		m_document->detachView();
 	m_document = document;
+	if(m_document)
+		m_document->attachView();
 	m_control->setDocument(m_document);
 	m_control->setFont(m_lineStyle.font);
 	m_control->setLayoutDirection(m_lineStyle.direction);
@@ -0,0 +1,104 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef PAGEDARRAY_H
+#define PAGEDARRAY_H
+
+#include <QAtomicPointer>
+#include <QtGlobal>
+
+namespace SubtitleComposer {
+/**
+ * @brief Fixed capacity array whose zeroed pages are allocated when they are first written.
+ *
+ * Pages are allocated lock-free, so different threads can reserve and write different parts of
+ * the array. Readers must only access elements that were published after they were written.
+ * Array can also wrap external contiguous memory, which is then not owned.
+ */
+template<typename T>
+class PagedArray
+{
+public:
+	enum { PageShift = 16, PageSize = 1 << PageShift, PageMask = PageSize - 1 };
+
+	explicit PagedArray(quint32 capacity)
+		: m_capacity(capacity),
+		  m_pageCount((quint64(capacity) + PageMask) >> PageShift),
+		  m_pages(new QAtomicPointer<T>[m_pageCount]),
+		  m_owned(true)
+	{
+	}
+
+	PagedArray(const T *data, quint32 capacity)
+		: m_capacity(capacity),
+		  m_pageCount((quint64(capacity) + PageMask) >> PageShift),
+		  m_pages(new QAtomicPointer<T>[m_pageCount]),
+		  m_owned(false)
+	{
+		for(quint32 i = 0; i < m_pageCount; i++)
+			m_pages[i].storeRelease(const_cast<T *>(data) + (quint64(i) << PageShift));
+	}
+
+	~PagedArray()
+	{
+		if(m_owned) {
+			for(quint32 i = 0; i < m_pageCount; i++)
+				delete[] m_pages[i].loadAcquire();
+		}
+		delete[] m_pages;
+	}
+
+	inline quint32 capacity() const { return m_capacity; }
+
+	// allocates pages of elements [start, end)
+	void reserve(quint32 start, quint32 end)
+	{
+		if(start >= end)
+			return;
+		const quint32 last = qMin((end - 1) >> PageShift, m_pageCount - 1);
+		for(quint32 i = start >> PageShift; i <= last; i++) {
+			if(m_pages[i].loadAcquire())
+				continue;
+			T *page = new T[PageSize]();
+			if(!m_pages[i].testAndSetOrdered(nullptr, page))
+				delete[] page;
+		}
+	}
+
+	// writing requires page to be reserved, reading pages that weren't reserved returns zeros
+	inline T & operator[](quint32 index) { return *data(index); }
+	inline const T & operator[](quint32 index) const { return *data(index); }
+
+	// contiguous elements starting at index, valid till the end of its page
+	inline T * data(quint32 index)
+	{
+		Q_ASSERT(m_pages[index >> PageShift].loadAcquire());
+		return m_pages[index >> PageShift].loadAcquire() + (index & PageMask);
+	}
+	inline const T * data(quint32 index) const
+	{
+		const T *page = m_pages[index >> PageShift].loadAcquire();
+		return (page ? page : zeroPage()) + (index & PageMask);
+	}
+	inline static quint32 pageEnd(quint32 index) { return (index | PageMask) + 1; }
+
+private:
+	Q_DISABLE_COPY(PagedArray)
+
+	static const T * zeroPage()
+	{
+		static const T page[PageSize] = {};
+		return page;
+	}
+
+	quint32 m_capacity;
+	quint32 m_pageCount;
+	QAtomicPointer<T> *m_pages;
+	bool m_owned;
+};
+}
+
+#endif // PAGEDARRAY_H
@@ -0,0 +1,225 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "peakkernel.h"
+
+// vector kernels assume signed 16-bit samples, level of sample v is then |v + 1|
+#if SAMPLE_MAX == 32767
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PEAK_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(PEAK_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PEAK_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+// sum of a chunk fits into 32 bits
+#define CHUNK_SIZE (1 << 16)
+#define NODE_SIZE (1 << WaveBuffer::PEAK_BASE_SHIFT)
+
+using namespace SubtitleComposer;
+
+static inline void
+reduceGeneric(const SAMPLE_TYPE *sample, quint32 count, quint64 *sum, quint32 *peak)
+{
+	quint64 s = 0;
+	quint32 p = 0;
+	for(const SAMPLE_TYPE *end = sample + count; sample != end; sample++) {
+		const quint32 val = WaveBuffer::sampleLevel(*sample);
+		s += val;
+		if(p < val)
+			p = val;
+	}
+	*sum = s;
+	*peak = p;
+}
+
+template<void (*reduce)(const SAMPLE_TYPE *, quint32, quint64 *, quint32 *)>
+static void
+reduceNodes(const SAMPLE_TYPE *sample, quint32 nodeCount, WavePeak *peaks)
+{
+	for(const WavePeak *end = peaks + nodeCount; peaks != end; peaks++, sample += NODE_SIZE) {
+		quint64 sum;
+		quint32 peak;
+		reduce(sample, NODE_SIZE, &sum, &peak);
+		peaks->mean = sum >> WaveBuffer::PEAK_BASE_SHIFT;
+		peaks->peak = peak;
+	}
+}
+
+#ifdef PEAK_SSE2
+static inline void
+reduceSSE2(const SAMPLE_TYPE *sample, quint32 count, quint64 *sum, quint32 *peak)
+{
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i bias = _mm_set1_epi16(-32768);
+	const __m128i zero = _mm_setzero_si128();
+	// SSE2 has only signed 16-bit max, levels are biased to keep their order
+	__m128i peakAcc = bias;
+	quint64 s = 0;
+
+	const SAMPLE_TYPE *end = sample + (count & ~7U);
+	while(sample != end) {
+		const SAMPLE_TYPE *chunkEnd = end - sample > CHUNK_SIZE ? sample + CHUNK_SIZE : end;
+		__m128i sumAcc = zero;
+		for(; sample != chunkEnd; sample += 8) {
+			const __m128i x = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(sample)), one);
+			const __m128i sign = _mm_srai_epi16(x, 15);
+			const __m128i val = _mm_sub_epi16(_mm_xor_si128(x, sign), sign);
+			peakAcc = _mm_max_epi16(peakAcc, _mm_xor_si128(val, bias));
+			sumAcc = _mm_add_epi32(sumAcc, _mm_unpacklo_epi16(val, zero));
+			sumAcc = _mm_add_epi32(sumAcc, _mm_unpackhi_epi16(val, zero));
+		}
+		sumAcc = _mm_add_epi32(sumAcc, _mm_shuffle_epi32(sumAcc, 0x4E));
+		sumAcc = _mm_add_epi32(sumAcc, _mm_shuffle_epi32(sumAcc, 0xB1));
+		s += quint32(_mm_cvtsi128_si32(sumAcc));
+	}
+	peakAcc = _mm_max_epi16(peakAcc, _mm_shuffle_epi32(peakAcc, 0x4E));
+	peakAcc = _mm_max_epi16(peakAcc, _mm_shuffle_epi32(peakAcc, 0xB1));
+	peakAcc = _mm_max_epi16(peakAcc, _mm_srli_epi32(peakAcc, 16));
+	quint32 p = (quint32(_mm_cvtsi128_si32(peakAcc)) & 0xFFFF) ^ 0x8000;
+
+	quint64 tailSum;
+	quint32 tailPeak;
+	reduceGeneric(sample, count & 7, &tailSum, &tailPeak);
+	*sum = s + tailSum;
+	*peak = qMax(p, tailPeak);
+}
+#endif
+
+#ifdef PEAK_AVX2
+__attribute__((target("avx2")))
+static inline void
+reduceAVX2(const SAMPLE_TYPE *sample, quint32 count, quint64 *sum, quint32 *peak)
+{
+	const __m256i one = _mm256_set1_epi16(1);
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i peakAcc = zero;
+	quint64 s = 0;
+
+	const SAMPLE_TYPE *end = sample + (count & ~15U);
+	while(sample != end) {
+		const SAMPLE_TYPE *chunkEnd = end - sample > CHUNK_SIZE ? sample + CHUNK_SIZE : end;
+		__m256i sumAcc = zero;
+		for(; sample != chunkEnd; sample += 16) {
+			// abs of -32768 is 0x8000, which is the right level when read unsigned
+			const __m256i val = _mm256_abs_epi16(_mm256_add_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(sample)), one));
+			peakAcc = _mm256_max_epu16(peakAcc, val);
+			sumAcc = _mm256_add_epi32(sumAcc, _mm256_unpacklo_epi16(val, zero));
+			sumAcc = _mm256_add_epi32(sumAcc, _mm256_unpackhi_epi16(val, zero));
+		}
+		__m128i s128 = _mm_add_epi32(_mm256_castsi256_si128(sumAcc), _mm256_extracti128_si256(sumAcc, 1));
+		s128 = _mm_add_epi32(s128, _mm_shuffle_epi32(s128, 0x4E));
+		s128 = _mm_add_epi32(s128, _mm_shuffle_epi32(s128, 0xB1));
+		s += quint32(_mm_cvtsi128_si32(s128));
+	}
+	__m128i p128 = _mm_max_epu16(_mm256_castsi256_si128(peakAcc), _mm256_extracti128_si256(peakAcc, 1));
+	p128 = _mm_max_epu16(p128, _mm_shuffle_epi32(p128, 0x4E));
+	p128 = _mm_max_epu16(p128, _mm_shuffle_epi32(p128, 0xB1));
+	p128 = _mm_max_epu16(p128, _mm_srli_epi32(p128, 16));
+	const quint32 p = quint32(_mm_cvtsi128_si32(p128)) & 0xFFFF;
+
+	quint64 tailSum;
+	quint32 tailPeak;
+	reduceGeneric(sample, count & 15, &tailSum, &tailPeak);
+	*sum = s + tailSum;
+	*peak = qMax(p, tailPeak);
+}
+
+__attribute__((target("avx2")))
+static void
+reduceNodesAVX2(const SAMPLE_TYPE *sample, quint32 nodeCount, WavePeak *peaks)
+{
+	for(const WavePeak *end = peaks + nodeCount; peaks != end; peaks++, sample += NODE_SIZE) {
+		quint64 sum;
+		quint32 peak;
+		reduceAVX2(sample, NODE_SIZE, &sum, &peak);
+		peaks->mean = sum >> WaveBuffer::PEAK_BASE_SHIFT;
+		peaks->peak = peak;
+	}
+}
+#endif
+
+static const PeakKernel::ReduceFunc s_reduceFuncs[PeakKernel::KindCount] = {
+	reduceGeneric,
+#ifdef PEAK_SSE2
+	reduceSSE2,
+#else
+	nullptr,
+#endif
+#ifdef PEAK_AVX2
+	reduceAVX2,
+#else
+	nullptr,
+#endif
+};
+
+static const PeakKernel::ReduceNodesFunc s_reduceNodesFuncs[PeakKernel::KindCount] = {
+	reduceNodes<reduceGeneric>,
+#ifdef PEAK_SSE2
+	reduceNodes<reduceSSE2>,
+#else
+	nullptr,
+#endif
+#ifdef PEAK_AVX2
+	reduceNodesAVX2,
+#else
+	nullptr,
+#endif
+};
+
+static PeakKernel::Kind
+bestKind()
+{
+	for(int kind = PeakKernel::KindCount - 1; kind > PeakKernel::Generic; kind--) {
+		if(PeakKernel::isSupported(PeakKernel::Kind(kind)))
+			return PeakKernel::Kind(kind);
+	}
+	return PeakKernel::Generic;
+}
+
+PeakKernel::Kind PeakKernel::s_kind = bestKind();
+PeakKernel::ReduceFunc PeakKernel::s_reduce = s_reduceFuncs[PeakKernel::s_kind];
+PeakKernel::ReduceNodesFunc PeakKernel::s_reduceNodes = s_reduceNodesFuncs[PeakKernel::s_kind];
+
+bool
+PeakKernel::isSupported(Kind kind)
+{
+	if(kind < Generic || kind >= KindCount || !s_reduceFuncs[kind])
+		return false;
+#ifdef PEAK_AVX2
+	if(kind == AVX2) {
+		// this runs from static initializers, possibly before libgcc initialized cpu model
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+	}
+#endif
+	return true;
+}
+
+const char *
+PeakKernel::name(Kind kind)
+{
+	switch(kind) {
+	case Generic: return "generic";
+	case SSE2: return "sse2";
+	case AVX2: return "avx2";
+	default: return "";
+	}
+}
+
+bool
+PeakKernel::setKind(Kind kind)
+{
+	if(!isSupported(kind))
+		return false;
+	s_kind = kind;
+	s_reduce = s_reduceFuncs[kind];
+	s_reduceNodes = s_reduceNodesFuncs[kind];
+	return true;
+}
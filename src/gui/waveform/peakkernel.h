@@ -0,0 +1,45 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef PEAKKERNEL_H
+#define PEAKKERNEL_H
+
+#include "gui/waveform/wavebuffer.h"
+
+namespace SubtitleComposer {
+/**
+ * @brief Reduction of samples to mean and peak of WaveBuffer::sampleLevel().
+ *
+ * Vectorized kernels are picked at runtime by CPU features, generic one is always available.
+ */
+class PeakKernel
+{
+public:
+	enum Kind { Generic, SSE2, AVX2, KindCount };
+
+	typedef void (*ReduceFunc)(const SAMPLE_TYPE *sample, quint32 count, quint64 *sum, quint32 *peak);
+	typedef void (*ReduceNodesFunc)(const SAMPLE_TYPE *sample, quint32 nodeCount, WavePeak *peaks);
+
+	static bool isSupported(Kind kind);
+	static const char * name(Kind kind);
+
+	// kernel used by reduce() and reduceNodes(), best supported one is used by default
+	static inline Kind kind() { return s_kind; }
+	static bool setKind(Kind kind);
+
+	// sum and peak of levels of count samples
+	static inline void reduce(const SAMPLE_TYPE *sample, quint32 count, quint64 *sum, quint32 *peak) { s_reduce(sample, count, sum, peak); }
+	// mean and peak of nodeCount consecutive pyramid nodes of (1 << WaveBuffer::PEAK_BASE_SHIFT) samples
+	static inline void reduceNodes(const SAMPLE_TYPE *sample, quint32 nodeCount, WavePeak *peaks) { s_reduceNodes(sample, nodeCount, peaks); }
+
+private:
+	static Kind s_kind;
+	static ReduceFunc s_reduce;
+	static ReduceNodesFunc s_reduceNodes;
+};
+}
+
+#endif // PEAKKERNEL_H
@@ -7,14 +7,20 @@
 #include "wavebuffer.h"
 
 #include "application.h"
+#include "gui/waveform/peakkernel.h"
+#include "gui/waveform/wavecache.h"
+#include "gui/waveform/wavedecimator.h"
 #include "gui/waveform/waveformwidget.h"
 #include "gui/waveform/zoombuffer.h"
 
 #include <QProgressBar>
+#include <QRunnable>
 #include <QScrollBar>
 #include <QtMath>
 
-#define MAX_WINDOW_ZOOM 3000 // TODO: calculate this when receiving stream data and do sample rate conversion
+#define MAX_WINDOW_ZOOM 3000 // samples are decimated to this rate while decoding
+#define SEGMENT_MIN_LENGTH (5 * 60 * 1000) // msec
+#define SEGMENT_MAX_COUNT 8
 //#define SAMPLE_RATE 8000
 //#define SAMPLE_RATE_MILLIS (SAMPLE_RATE / 1000)
 //#define DRAG_TOLERANCE (double(10 * m_samplesPerPixel / SAMPLE_RATE_MILLIS))
@@ -24,22 +30,64 @@ namespace SubtitleComposer {
 struct WaveformFrame {
 	explicit WaveformFrame(quint8 shift, quint8 channels)
 		: offset(0),
-		  sampleShift(shift),
-		  frameSize((1 << sampleShift) * channels),
-		  overflow(0),
-		  val(new qint32[channels])
+		  decimator(shift, channels)
 	{
 	}
 
-	virtual ~WaveformFrame() {
-		delete[] val;
+	quint32 offset;
+	WaveDecimator decimator;
+};
+
+class CacheKeyTask : public QRunnable
+{
+public:
+	CacheKeyTask(QObject *buffer, uint generation, const QString &mediaFile, int audioStream)
+		: m_buffer(buffer),
+		  m_generation(generation),
+		  m_mediaFile(mediaFile),
+		  m_audioStream(audioStream)
+	{}
+
+	void run() override
+	{
+		const QString cacheKey = WaveCache::key(m_mediaFile, m_audioStream);
+		QMetaObject::invokeMethod(m_buffer, "onCacheKey", Qt::QueuedConnection,
+			Q_ARG(uint, m_generation), Q_ARG(QString, m_mediaFile), Q_ARG(int, m_audioStream), Q_ARG(QString, cacheKey));
 	}
 
-	quint32 offset;
-	quint8 sampleShift;
-	quint16 frameSize;
-	quint16 overflow;
-	qint32 *val;
+private:
+	QObject *m_buffer;
+	const uint m_generation;
+	const QString m_mediaFile;
+	const int m_audioStream;
+};
+
+struct WaveformSegment {
+	explicit WaveformSegment(StreamProcessor *stream, quint64 msecStart)
+		: stream(stream),
+		  msecStart(msecStart),
+		  msecDecoded(0),
+		  finished(false),
+		  start(0),
+		  frame(nullptr),
+		  peakEnd(0)
+	{
+	}
+
+	~WaveformSegment() {
+		delete frame;
+	}
+
+	StreamProcessor *stream;
+	quint64 msecStart;
+	// used only in main thread
+	quint64 msecDecoded;
+	bool finished;
+	// used only in stream thread
+	quint32 start;
+	WaveformFrame *frame;
+	// end of samples processed into peaks
+	QAtomicInt peakEnd;
 };
 }
 
@@ -49,19 +97,27 @@ using namespace SubtitleComposer;
 WaveBuffer::WaveBuffer(WaveformWidget *parent)
 	: QObject(parent),
 	  m_wfWidget(parent),
-	  m_stream(new StreamProcessor(this)),
 	  m_waveformDuration(0),
 	  m_waveformChannels(0),
 	  m_waveformChannelSize(0),
 	  m_waveform(nullptr),
+	  m_peakLevels(0),
+	  m_peaks(nullptr),
+	  m_peakSamples(0),
 	  m_samplesSec(0),
-	  m_wfFrame(nullptr),
-	  m_zoomBuffer(new ZoomBuffer(this))
+	  m_sampleShift(0),
+	  m_segmentsGeneration(0),
+	  m_zoomBuffer(new ZoomBuffer(this)),
+	  m_cache(new WaveCache())
+{
+}
+
+WaveBuffer::~WaveBuffer()
 {
-	connect(m_stream, &StreamProcessor::streamProgress, this, &WaveBuffer::onStreamProgress);
-	connect(m_stream, &StreamProcessor::streamFinished, this, &WaveBuffer::onStreamFinished);
-	// Using Qt::DirectConnection here makes WaveBuffer::onStreamData() to execute in SpeechProcessor's thread
-	connect(m_stream, &StreamProcessor::audioDataAvailable, this, &WaveBuffer::onStreamData, Qt::DirectConnection);
+	// pending key results are discarded together with this object
+	m_keyPool.waitForDone();
+	stopSegments();
+	delete m_cache;
 }
 
 quint32
@@ -71,9 +127,19 @@ WaveBuffer::millisPerPixel() const
 }
 
 quint32
-WaveBuffer::samplesAvailable() const
+WaveBuffer::peaksAvailable() const
 {
-	return m_wfFrame ? m_wfFrame->offset : m_waveformChannelSize;
+	if(m_segments.isEmpty())
+		return m_peakSamples.loadAcquire();
+
+	// segments overlap a bit, samples are contiguous up to the end of first unfinished segment
+	quint32 available = 0;
+	for(const WaveformSegment *segment : m_segments) {
+		available = qMax(available, quint32(segment->peakEnd.loadAcquire()));
+		if(!segment->finished)
+			break;
+	}
+	return available;
 }
 
 void
@@ -81,9 +147,116 @@ WaveBuffer::setAudioStream(const QString &mediaFile, int audioStream)
 {
 	m_waveformDuration = 0;
 
+	// media file is hashed in background, results of streams that were replaced meanwhile are ignored
+	m_keyPool.start(new CacheKeyTask(this, ++m_segmentsGeneration, mediaFile, audioStream));
+}
+
+void
+WaveBuffer::onCacheKey(uint generation, const QString &mediaFile, int audioStream, const QString &cacheKey)
+{
+	if(generation != m_segmentsGeneration)
+		return;
+
+	if(m_cache->open(cacheKey)) {
+		// samples and peaks are used directly from mapped cache, they are never written
+		m_samplesSec = m_cache->sampleRate();
+		m_waveformDuration = m_cache->duration();
+		m_waveformChannels = m_cache->channels();
+		m_waveformChannelSize = m_cache->channelSize();
+		m_peakLevels = m_cache->peakLevels();
+		m_data.reset(new WaveData(m_waveformChannels, m_peakLevels));
+		m_waveform = m_data->samples;
+		m_peaks = m_data->peaks;
+		for(quint16 ch = 0; ch < m_waveformChannels; ch++)
+			m_waveform[ch] = new PagedArray<SAMPLE_TYPE>(m_cache->samples(ch), m_waveformChannelSize);
+		for(quint16 ch = 0; ch < m_waveformChannels; ch++) {
+			for(quint8 level = 0; level < m_peakLevels; level++)
+				m_peaks[ch * m_peakLevels + level] = new PagedArray<WavePeak>(m_cache->peaks(ch, level), m_waveformChannelSize >> (PEAK_BASE_SHIFT + level));
+		}
+		m_peakSamples.storeRelease(m_waveformChannelSize);
+
+		m_zoomBuffer->setWaveform(m_waveform);
+
+		emit waveformUpdated();
+		return;
+	}
+	m_cacheKey = cacheKey;
+
+	if(!startSegments(mediaFile, audioStream))
+		m_cacheKey.clear();
+}
+
+bool
+WaveBuffer::startSegments(const QString &mediaFile, int audioStream)
+{
 	static WaveFormat waveFormat(0, 0, sizeof(SAMPLE_TYPE) * 8, true);
-	if(m_stream->open(mediaFile) && m_stream->initAudio(audioStream, waveFormat))
-		m_stream->start();
+
+	QVector<StreamProcessor *> streams;
+	streams.append(new StreamProcessor(this));
+	if(!streams.first()->open(mediaFile) || !streams.first()->initAudio(audioStream, waveFormat)) {
+		delete streams.first();
+		return false;
+	}
+
+	// every segment is decoded by its own stream processor, short streams are not split
+	const quint64 length = streams.first()->length();
+	const quint64 count = qBound(Q_UINT64_C(1), qMin(quint64(QThread::idealThreadCount()), length / SEGMENT_MIN_LENGTH), quint64(SEGMENT_MAX_COUNT));
+	while(quint64(streams.size()) < count) {
+		StreamProcessor *stream = new StreamProcessor(this);
+		if(!stream->open(mediaFile) || !stream->initAudio(audioStream, waveFormat)) {
+			delete stream;
+			break;
+		}
+		streams.append(stream);
+	}
+
+	const quint32 generation = ++m_segmentsGeneration;
+	for(int i = 0; i < streams.size(); i++) {
+		StreamProcessor *stream = streams.at(i);
+		const quint64 msecStart = length * i / streams.size();
+		// last segment runs till the end as stream length might be wrong
+		stream->setAudioRange(msecStart, i + 1 < streams.size() ? length * (i + 1) / streams.size() : 0);
+
+		WaveformSegment *segment = new WaveformSegment(stream, msecStart);
+		m_segments.append(segment);
+
+		// segment is deleted only after its stream is stopped, late queued signals are ignored by generation
+		connect(stream, &StreamProcessor::streamProgress, this, [this, generation, segment](quint64 msecPos, quint64 msecLength) {
+			if(generation == m_segmentsGeneration)
+				onStreamProgress(segment, msecPos, msecLength);
+		});
+		connect(stream, &StreamProcessor::streamFinished, this, [this, generation, segment]() {
+			if(generation == m_segmentsGeneration)
+				onStreamFinished(segment);
+		});
+		connect(stream, &StreamProcessor::streamError, this, [this, generation]() {
+			if(generation == m_segmentsGeneration)
+				onStreamError();
+		});
+		// Using Qt::DirectConnection here makes WaveBuffer::onStreamData() to execute in SpeechProcessor's thread
+		connect(stream, &StreamProcessor::audioDataAvailable, this, [this, segment](const void *buffer, qint32 size, const WaveFormat *waveFormat, qint64 msecStart, qint64 msecDuration) {
+			onStreamData(segment, buffer, size, waveFormat, msecStart, msecDuration);
+		}, Qt::DirectConnection);
+	}
+
+	for(WaveformSegment *segment : qAsConst(m_segments))
+		segment->stream->start();
+
+	return true;
+}
+
+void
+WaveBuffer::stopSegments()
+{
+	m_segmentsGeneration++;
+
+	const QVector<WaveformSegment *> segments = m_segments;
+	m_segments.clear();
+	for(WaveformSegment *segment : segments) {
+		segment->stream->close();
+		segment->stream->deleteLater();
+		delete segment;
+	}
 }
 
 void
@@ -99,14 +272,19 @@ WaveBuffer::setNullAudioStream(quint64 msecVideoLength)
 void
 WaveBuffer::clearAudioStream()
 {
-	m_stream->close();
+	// interrupted stream must not be cached
+	m_cacheKey.clear();
+	stopSegments();
 
 	if(m_waveform) {
 		m_zoomBuffer->setWaveform(nullptr);
-		for(quint32 i = 0; i < m_waveformChannels; i++)
-			delete[] m_waveform[i];
-		delete[] m_waveform;
 		m_waveform = nullptr;
+		m_peaks = nullptr;
+		// arrays wrapping mapped cache don't own their data, they are never shared with cache writer
+		m_data.reset();
+		m_cache->close();
+		m_peakLevels = 0;
+		m_peakSamples.storeRelease(0);
 		m_waveformChannelSize = 0;
 		m_waveformChannels = 0;
 		m_samplesSec = 0;
@@ -114,7 +292,7 @@ WaveBuffer::clearAudioStream()
 }
 
 void
-WaveBuffer::onStreamProgress(quint64 msecPos, quint64 msecLength)
+WaveBuffer::onStreamProgress(WaveformSegment *segment, quint64 msecPos, quint64 msecLength)
 {
 	if(!m_waveformDuration) {
 		m_waveformDuration = msecLength / 1000;
@@ -122,17 +300,100 @@ WaveBuffer::onStreamProgress(quint64 msecPos, quint64 msecLength)
 		m_wfWidget->m_progressWidget->show();
 		m_wfWidget->m_scrollBar->setRange(0, m_waveformDuration * 1000 - m_wfWidget->windowSizeInner());
 	}
-	m_wfWidget->m_progressBar->setValue(msecPos / 1000);
+
+	segment->msecDecoded = msecPos > segment->msecStart ? msecPos - segment->msecStart : 0;
+	quint64 msecDecoded = 0;
+	for(const WaveformSegment *s : qAsConst(m_segments))
+		msecDecoded += s->msecDecoded;
+	m_wfWidget->m_progressBar->setValue(msecDecoded / 1000);
+
+	m_zoomBuffer->refresh();
 }
 
 void
-WaveBuffer::onStreamFinished()
+WaveBuffer::onStreamFinished(WaveformSegment *segment)
 {
+	segment->finished = true;
+	for(const WaveformSegment *s : qAsConst(m_segments)) {
+		if(!s->finished) {
+			m_zoomBuffer->refresh();
+			return;
+		}
+	}
+
 	m_wfWidget->m_progressWidget->hide();
-	if(m_wfFrame) {
-		m_waveformChannelSize = m_wfFrame->offset;
-		delete m_wfFrame;
-		m_wfFrame = nullptr;
+
+	// waveform ends where the furthest segment stopped
+	bool decoded = false;
+	quint32 channelSize = 0;
+	for(const WaveformSegment *s : qAsConst(m_segments)) {
+		if(s->frame) {
+			channelSize = qMax(channelSize, s->frame->offset);
+			decoded = true;
+		}
+	}
+
+	m_segmentsGeneration++;
+	for(WaveformSegment *s : qAsConst(m_segments)) {
+		// finished signal is queued, thread may still be leaving run()
+		s->stream->wait();
+		s->stream->deleteLater();
+		delete s;
+	}
+	m_segments.clear();
+
+	if(decoded) {
+		m_waveformChannelSize = channelSize;
+		// pyramid nodes across segment seams were skipped while decoding
+		updatePeaks(0, m_waveformChannelSize, 0);
+		m_peakSamples.storeRelease(m_waveformChannelSize);
+		// visible range is derived again
+		emit waveformUpdated();
+	}
+
+	if(m_waveform && !m_cacheKey.isEmpty()) {
+		WaveCache::store(m_cacheKey, m_samplesSec, m_waveformDuration, m_waveformChannelSize, m_data);
+	}
+	m_cacheKey.clear();
+}
+
+void
+WaveBuffer::onStreamError()
+{
+	// waveform is incomplete
+	m_cacheKey.clear();
+}
+
+void
+WaveBuffer::updatePeaks(quint32 start, quint32 end, quint32 first)
+{
+	// only complete nodes are written, partial ones are finished by later calls - nodes starting
+	// before first sample could still be missing samples of other segment
+	for(quint8 level = 0; level < m_peakLevels; level++) {
+		const quint8 shift = PEAK_BASE_SHIFT + level;
+		const quint32 nodeStart = qMax(start >> shift, quint32((quint64(first) + (1 << shift) - 1) >> shift));
+		const quint32 nodeEnd = end >> shift;
+		for(quint16 ch = 0; ch < m_waveformChannels; ch++) {
+			PagedArray<WavePeak> &peaks = *m_peaks[ch * m_peakLevels + level];
+			peaks.reserve(nodeStart, nodeEnd);
+			if(level == 0) {
+				// runs are split at page ends of both arrays
+				const PagedArray<SAMPLE_TYPE> &samples = *m_waveform[ch];
+				for(quint32 i = nodeStart; i < nodeEnd;) {
+					const quint32 n = qMin(qMin(nodeEnd, PagedArray<WavePeak>::pageEnd(i)), PagedArray<SAMPLE_TYPE>::pageEnd(i << shift) >> shift) - i;
+					PeakKernel::reduceNodes(samples.data(i << shift), n, peaks.data(i));
+					i += n;
+				}
+			} else {
+				const PagedArray<WavePeak> &child = *m_peaks[ch * m_peakLevels + level - 1];
+				for(quint32 i = nodeStart; i < nodeEnd; i++) {
+					const WavePeak &a = child[i << 1];
+					const WavePeak &b = child[(i << 1) + 1];
+					peaks[i].mean = (quint32(a.mean) + b.mean) >> 1;
+					peaks[i].peak = qMax(a.peak, b.peak);
+				}
+			}
+		}
 	}
 }
 
@@ -140,102 +401,99 @@ inline static SAMPLE_TYPE
 scaleSample(SAMPLE_TYPE sample)
 {
 	static const qreal valMax = qreal(SAMPLE_MAX - SAMPLE_MIN) / 2.;
-	return qSqrt(qreal(sample) / valMax) * SAMPLE_MAX;
+	// negative peaks are kept by decimation, they are scaled by magnitude
+	const qreal scaled = qSqrt(qAbs(qreal(sample)) / valMax) * SAMPLE_MAX;
+	return sample < 0 ? -scaled : scaled;
 }
 
 void
-WaveBuffer::onStreamData(const void *buffer, qint32 size, const WaveFormat *waveFormat, const qint64 msecStart, const qint64 /*msecDuration*/)
+WaveBuffer::onStreamData(WaveformSegment *segment, const void *buffer, qint32 size, const WaveFormat *waveFormat, const qint64 msecStart, const qint64 /*msecDuration*/)
 {
 	// make sure WaveBuffer::onStreamProgress() signal was processed since we're in different thread
 	while(!m_waveformDuration) {
 		QThread::yieldCurrentThread();
-		if(m_stream->isInterruptionRequested())
+		if(segment->stream->isInterruptionRequested())
 			return;
 	}
 
-	if(!m_waveformChannels) {
-		m_samplesSec = waveFormat->sampleRate();
-		quint8 sampleShift = 0;
-		while(m_samplesSec > MAX_WINDOW_ZOOM) {
-			m_samplesSec >>= 1;
-			sampleShift++;
-		}
-		m_waveformChannels = waveFormat->channels();
-		m_waveformChannelSize = m_samplesSec * (m_waveformDuration + 60); // added 60sec as duration might be wrong
-		m_waveform = new SAMPLE_TYPE *[m_waveformChannels];
-		for(quint32 i = 0; i < m_waveformChannels; i++)
-			m_waveform[i] = new SAMPLE_TYPE[m_waveformChannelSize];
+	if(!segment->frame) {
+		QMutexLocker l(&m_initMutex);
 
-		m_wfFrame = new WaveformFrame(sampleShift, m_waveformChannels);
-
-		m_zoomBuffer->setWaveform(m_waveform);
+		if(!m_waveform) {
+			m_samplesSec = waveFormat->sampleRate();
+			m_sampleShift = 0;
+			while(m_samplesSec > MAX_WINDOW_ZOOM) {
+				m_samplesSec >>= 1;
+				m_sampleShift++;
+			}
+			m_waveformChannels = waveFormat->channels();
+			m_waveformChannelSize = m_samplesSec * (m_waveformDuration + 60); // added 60sec as duration might be wrong
+			// pages are allocated as they are written, parts that weren't decoded read as silence
+			m_peakLevels = 0;
+			while(m_waveformChannelSize >> (PEAK_BASE_SHIFT + m_peakLevels))
+				m_peakLevels++;
+			m_data.reset(new WaveData(m_waveformChannels, m_peakLevels));
+			m_waveform = m_data->samples;
+			m_peaks = m_data->peaks;
+			for(quint32 i = 0; i < m_waveformChannels; i++)
+				m_waveform[i] = new PagedArray<SAMPLE_TYPE>(m_waveformChannelSize);
+			for(quint32 i = 0; i < quint32(m_waveformChannels) * m_peakLevels; i++)
+				m_peaks[i] = new PagedArray<WavePeak>(m_waveformChannelSize >> (PEAK_BASE_SHIFT + i % m_peakLevels));
+			m_peakSamples.storeRelease(0);
+
+			m_zoomBuffer->setWaveform(m_waveform);
+
+			emit waveformUpdated();
+		}
 
-		emit waveformUpdated();
+		segment->start = qMin(quint32(segment->msecStart * m_samplesSec / 1000), m_waveformChannelSize - 1);
+		segment->frame = new WaveformFrame(m_sampleShift, m_waveformChannels);
+		segment->frame->offset = segment->start;
 	}
+	WaveformFrame *frame = segment->frame;
 
 	Q_ASSERT(waveFormat->bitsPerSample() == sizeof(SAMPLE_TYPE) * 8);
 
 	const SAMPLE_TYPE *sample = reinterpret_cast<const SAMPLE_TYPE *>(buffer);
+	quint32 dirtyStart = frame->offset;
 
 	{ // handle overlaps and holes between buffers (tested streams had ~2ms error - might be useless)
-		const quint32 inStartOffset = qMax(0LL, msecStart) * m_samplesSec / 1000;
-		if(inStartOffset < m_wfFrame->offset) {
+		const quint32 inStartOffset = qMin(quint32(qMax(0LL, msecStart) * m_samplesSec / 1000), m_waveformChannelSize - 1);
+
+		// allocate pages of everything this buffer can write
+		const quint32 writeEnd = qMin(m_waveformChannelSize, qMax(frame->offset, inStartOffset) + 2 + quint32(size / sizeof(SAMPLE_TYPE)) / frame->decimator.bucketSize());
+		for(quint32 c = 0; c < m_waveformChannels; c++)
+			m_waveform[c]->reserve(qMin(frame->offset, inStartOffset), writeEnd);
+
+		if(inStartOffset < frame->offset) {
 			// overwrite part of local buffer
-			m_wfFrame->offset = inStartOffset;
-		} else if(inStartOffset > m_wfFrame->offset) {
+			frame->offset = inStartOffset;
+			frame->decimator.reset();
+		} else if(inStartOffset > frame->offset) {
 			// pad hole in local buffer
-			quint32 i = m_wfFrame->offset;
-			if(i > 0) {
-				for(; i < inStartOffset; i++) {
-					for(quint32 c = 0; c < m_waveformChannels; c++)
-						m_waveform[c][i] = m_waveform[c][i - 1];
-				}
-			} else {
-				for(quint32 c = 0; c < m_waveformChannels; c++)
-					memset(m_waveform[c], 0, inStartOffset * sizeof(SAMPLE_TYPE));
+			for(quint32 c = 0; c < m_waveformChannels; c++) {
+				PagedArray<SAMPLE_TYPE> &samples = *m_waveform[c];
+				for(quint32 i = frame->offset; i < inStartOffset; i++)
+					samples[i] = i ? qAsConst(samples)[i - 1] : 0;
 			}
-			m_wfFrame->offset = inStartOffset;
+			frame->offset = inStartOffset;
+			frame->decimator.reset();
 		}
+		dirtyStart = qMin(dirtyStart, frame->offset);
 	}
 
 	Q_ASSERT(m_waveformChannels > 0);
 
-	quint32 len = size / sizeof(SAMPLE_TYPE);
-
-	if(m_wfFrame->overflow) {
-		const quint32 overflowFrameSize = qMin(m_wfFrame->overflow + len, quint32(m_wfFrame->frameSize));
-
-		quint32 c = m_wfFrame->overflow;
-		for(; c < m_waveformChannels; c++)
-			m_wfFrame->val[c] = *sample++;
-		for(; c < overflowFrameSize; c++)
-			m_wfFrame->val[c % m_waveformChannels] += *sample++;
-		for(c = 0; c < m_waveformChannels; c++)
-			m_waveform[c][m_wfFrame->offset] = scaleSample(m_wfFrame->val[c] >> m_wfFrame->sampleShift);
-
-		len -= overflowFrameSize - m_wfFrame->overflow;
-		if(overflowFrameSize < m_wfFrame->frameSize) {
-			// no more data
-			Q_ASSERT(len == 0);
-			m_wfFrame->overflow = overflowFrameSize;
+	// bucket split between buffers is completed by the next one
+	frame->decimator.feed(sample, size / sizeof(SAMPLE_TYPE), [this, frame](const SAMPLE_TYPE *val) {
+		// duration might be wrong, samples past the end are dropped
+		if(frame->offset >= m_waveformChannelSize)
 			return;
-		}
-		m_wfFrame->offset++;
-	}
+		for(quint16 c = 0; c < m_waveformChannels; c++)
+			(*m_waveform[c])[frame->offset] = scaleSample(val[c]);
+		frame->offset++;
+	});
 
-	if(m_wfFrame->offset + (len >> m_wfFrame->sampleShift) >= m_waveformChannelSize) // make sure we don't overflow
-		len = (m_waveformChannelSize - m_wfFrame->offset - 1) << m_wfFrame->sampleShift;
-
-	while(len > m_wfFrame->frameSize) {
-		quint32 c = 0;
-		for(; c < m_waveformChannels; c++)
-			m_wfFrame->val[c] = *sample++;
-		for(; c < m_wfFrame->frameSize; c++)
-			m_wfFrame->val[c % m_waveformChannels] += *sample++;
-		for(c = 0; c < m_waveformChannels; c++)
-			m_waveform[c][m_wfFrame->offset] = scaleSample(m_wfFrame->val[c] >> m_wfFrame->sampleShift);
-		len -= m_wfFrame->frameSize;
-		m_wfFrame->offset++;
-	}
-	m_wfFrame->overflow = len;
+	updatePeaks(dirtyStart, frame->offset, segment->start);
+	segment->peakEnd.storeRelease(frame->offset);
 }
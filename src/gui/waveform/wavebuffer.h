@@ -7,9 +7,15 @@
 #ifndef WAVEBUFFER_H
 #define WAVEBUFFER_H
 
+#include "gui/waveform/pagedarray.h"
 #include "streamprocessor/streamprocessor.h"
 
+#include <QAtomicInt>
+#include <QMutex>
 #include <QObject>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QVector>
 
 // FIXME: make sample size configurable or drop this
 //*
@@ -23,20 +29,61 @@
 //*/
 
 namespace SubtitleComposer {
+class WaveCache;
 class WaveformWidget;
 class ZoomBuffer;
+struct WaveformSegment;
 
 struct WaveZoomData {
 	quint32 min;
 	quint32 max;
 };
 
+struct WavePeak {
+	quint16 mean;
+	quint16 peak;
+};
+
+/**
+ * @brief Samples and peak pyramid levels of every channel, owns arrays it holds.
+ *
+ * Data is shared with WaveCache while it is being stored, so it outlives the stream that decoded it.
+ */
+struct WaveData {
+	WaveData(quint16 channels, quint8 peakLevels)
+		: channels(channels),
+		  peakLevels(peakLevels),
+		  samples(new PagedArray<SAMPLE_TYPE> *[channels]()),
+		  peaks(new PagedArray<WavePeak> *[quint32(channels) * peakLevels]())
+	{
+	}
+
+	~WaveData()
+	{
+		for(quint32 i = 0; i < channels; i++)
+			delete samples[i];
+		for(quint32 i = 0; i < quint32(channels) * peakLevels; i++)
+			delete peaks[i];
+		delete[] samples;
+		delete[] peaks;
+	}
+
+	const quint16 channels;
+	const quint8 peakLevels;
+	PagedArray<SAMPLE_TYPE> ** const samples;
+	PagedArray<WavePeak> ** const peaks;
+
+private:
+	Q_DISABLE_COPY(WaveData)
+};
+
 class WaveBuffer : public QObject
 {
 	Q_OBJECT
 
 public:
 	explicit WaveBuffer(WaveformWidget *parent = nullptr);
+	virtual ~WaveBuffer();
 
 	/**
 	 * @brief waveformDuration
@@ -57,7 +104,7 @@ public:
 
 	inline quint16 channels() const { return m_waveformChannels; }
 
-	inline bool isDecoding() const { return m_wfFrame != nullptr; }
+	inline bool isDecoding() const { return !m_segments.isEmpty(); }
 
 	/**
 	 * @brief MAX_WINDOW_ZOOM
@@ -65,7 +112,17 @@ public:
 	 */
 	inline static quint32 MAX_WINDOW_ZOOM() { return 3000; }
 
-	quint32 samplesAvailable() const;
+	/**
+	 * @brief Peak pyramid is built while decoding, node of level 0 covers (1 << PEAK_BASE_SHIFT) samples
+	 *  and every next level halves the number of nodes. Node holds mean and peak of sampleLevel().
+	 */
+	enum { PEAK_BASE_SHIFT = 4 };
+	inline quint8 peakLevels() const { return m_peakLevels; }
+	inline const PagedArray<WavePeak> & peaks(quint16 channel, quint8 level) const { return *m_peaks[channel * m_peakLevels + level]; }
+	// number of samples from start covered by complete pyramid nodes
+	quint32 peaksAvailable() const;
+
+	inline static quint32 sampleLevel(SAMPLE_TYPE sample) { return qAbs(qint32(sample) - SAMPLE_MIN - (SAMPLE_MAX - SAMPLE_MIN) / 2); }
 
 	void setAudioStream(const QString &mediaFile, int audioStream);
 	void setNullAudioStream(quint64 msecVideoLength);
@@ -76,26 +133,48 @@ public:
 signals:
 	void waveformUpdated();
 
+private slots:
+	void onCacheKey(uint generation, const QString &mediaFile, int audioStream, const QString &cacheKey);
+
 private:
-	void onStreamData(const void *buffer, qint32 size, const WaveFormat *waveFormat, const qint64 msecStart, const qint64 msecDuration);
-	void onStreamProgress(quint64 msecPos, quint64 msecLength);
-	void onStreamFinished();
+	bool startSegments(const QString &mediaFile, int audioStream);
+	void stopSegments();
+	void onStreamData(WaveformSegment *segment, const void *buffer, qint32 size, const WaveFormat *waveFormat, const qint64 msecStart, const qint64 msecDuration);
+	void onStreamProgress(WaveformSegment *segment, quint64 msecPos, quint64 msecLength);
+	void onStreamFinished(WaveformSegment *segment);
+	void onStreamError();
+	void updatePeaks(quint32 start, quint32 end, quint32 first);
 
 private:
 	WaveformWidget *m_wfWidget;
 
-	StreamProcessor *m_stream;
-
 	quint32 m_waveformDuration; // FIXME: change to msec
 	quint16 m_waveformChannels;
 	quint32 m_waveformChannelSize;
-	SAMPLE_TYPE **m_waveform;
+	// storage is paged, so only decoded part of the stream takes memory
+	QSharedPointer<WaveData> m_data;
+	// arrays of m_data
+	PagedArray<SAMPLE_TYPE> **m_waveform;
+
+	quint8 m_peakLevels;
+	PagedArray<WavePeak> **m_peaks;
+	QAtomicInt m_peakSamples;
 
 	quint32 m_samplesSec;
+	quint8 m_sampleShift;
 
-	struct WaveformFrame *m_wfFrame;
+	// audio is decoded in parallel segments, first one to receive data allocates the waveform
+	QVector<WaveformSegment *> m_segments;
+	quint32 m_segmentsGeneration;
+	QMutex m_initMutex;
 
 	ZoomBuffer *m_zoomBuffer;
+
+	WaveCache *m_cache;
+	// set while decoding stream that should be cached once it is complete
+	QString m_cacheKey;
+	// media files are hashed for cache keys in background
+	QThreadPool m_keyPool;
 };
 }
 
@@ -0,0 +1,265 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "wavecache.h"
+
+#include "scconfig.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QRunnable>
+#include <QStandardPaths>
+#include <QThreadPool>
+
+#include <cstring>
+
+#define HASH_CHUNK_SIZE (1 << 20)
+
+using namespace SubtitleComposer;
+
+static const char s_magic[8] = { 'S', 'C', 'W', 'A', 'V', 'E', '\r', '\n' };
+
+// entries are written one at a time, so eviction sees all previously stored files
+Q_GLOBAL_STATIC(QThreadPool, s_writerPool)
+
+static inline quint64
+align8(quint64 offset)
+{
+	return (offset + 7) & ~quint64(7);
+}
+
+static inline quint32
+levelSize(quint32 channelSize, quint8 level)
+{
+	return channelSize >> (WaveBuffer::PEAK_BASE_SHIFT + level);
+}
+
+template<typename T>
+static bool
+writePaged(QIODevice *device, const PagedArray<T> &array, quint32 size)
+{
+	for(quint32 i = 0; i < size;) {
+		const quint32 n = qMin(size, PagedArray<T>::pageEnd(i)) - i;
+		const qint64 bytes = qint64(n) * sizeof(T);
+		if(device->write(reinterpret_cast<const char *>(array.data(i)), bytes) != bytes)
+			return false;
+		i += n;
+	}
+	static const char padding[8] = {};
+	const int pad = int(align8(quint64(size) * sizeof(T)) - quint64(size) * sizeof(T));
+	return device->write(padding, pad) == pad;
+}
+
+class WaveCache::Writer : public QRunnable
+{
+public:
+	Writer(const QString &path, const Header &header, const QSharedPointer<const WaveData> &data, quint64 sizeMax)
+		: m_path(path),
+		  m_header(header),
+		  m_data(data),
+		  m_sizeMax(sizeMax)
+	{}
+
+	void run() override
+	{
+		QSaveFile file(m_path);
+		if(!file.open(QIODevice::WriteOnly) || !write(&file) || !file.commit())
+			return;
+		WaveCache::evict(m_sizeMax);
+	}
+
+private:
+	bool write(QIODevice *device) const
+	{
+		static const char padding[8] = {};
+		const int pad = int(align8(sizeof(m_header)) - sizeof(m_header));
+		if(device->write(reinterpret_cast<const char *>(&m_header), sizeof(m_header)) != qint64(sizeof(m_header)) || device->write(padding, pad) != pad)
+			return false;
+		for(quint16 ch = 0; ch < m_data->channels; ch++) {
+			if(!writePaged(device, *m_data->samples[ch], m_header.channelSize))
+				return false;
+		}
+		for(quint8 level = 0; level < m_data->peakLevels; level++) {
+			for(quint16 ch = 0; ch < m_data->channels; ch++) {
+				if(!writePaged(device, *m_data->peaks[ch * m_data->peakLevels + level], levelSize(m_header.channelSize, level)))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	const QString m_path;
+	const Header m_header;
+	const QSharedPointer<const WaveData> m_data;
+	const quint64 m_sizeMax;
+};
+
+WaveCache::WaveCache()
+	: m_data(nullptr),
+	  m_header(nullptr)
+{
+}
+
+WaveCache::~WaveCache()
+{
+	close();
+}
+
+QString
+WaveCache::cacheDir()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/waveform");
+}
+
+quint64
+WaveCache::fileSize(quint16 channels, quint32 channelSize, quint8 peakLevels)
+{
+	quint64 size = align8(sizeof(Header)) + channels * align8(quint64(channelSize) * sizeof(SAMPLE_TYPE));
+	for(quint8 level = 0; level < peakLevels; level++)
+		size += channels * align8(quint64(levelSize(channelSize, level)) * sizeof(WavePeak));
+	return size;
+}
+
+QString
+WaveCache::key(const QString &mediaFile, int audioStream)
+{
+	const QFileInfo info(mediaFile);
+	QFile file(info.absoluteFilePath());
+	if(!info.isFile() || !file.open(QIODevice::ReadOnly))
+		return QString();
+
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(info.canonicalFilePath().toUtf8());
+	{
+		QByteArray id;
+		QDataStream stream(&id, QIODevice::WriteOnly);
+		stream << qint64(info.size()) << qint64(info.lastModified().toMSecsSinceEpoch()) << qint32(audioStream);
+		hash.addData(id);
+	}
+	hash.addData(file.read(HASH_CHUNK_SIZE));
+	if(info.size() > HASH_CHUNK_SIZE && file.seek(qMax(qint64(HASH_CHUNK_SIZE), info.size() - HASH_CHUNK_SIZE)))
+		hash.addData(file.read(HASH_CHUNK_SIZE));
+
+	return QString::fromLatin1(hash.result().toHex());
+}
+
+bool
+WaveCache::open(const QString &key)
+{
+	close();
+
+	if(key.isEmpty() || SCConfig::wfCacheSize() <= 0)
+		return false;
+
+	m_file.setFileName(cacheDir() + QChar('/') + key + QStringLiteral(".wave"));
+	if(!m_file.open(QIODevice::ReadOnly))
+		return false;
+
+	const qint64 size = m_file.size();
+	uchar *data = size >= qint64(sizeof(Header)) ? m_file.map(0, size) : nullptr;
+	const Header *header = reinterpret_cast<const Header *>(data);
+	if(!data
+			|| memcmp(header->magic, s_magic, sizeof(s_magic)) != 0
+			|| header->version != Version
+			|| header->sampleBits != sizeof(SAMPLE_TYPE) * 8
+			|| header->peakBaseShift != WaveBuffer::PEAK_BASE_SHIFT
+			|| !header->channels || header->channels > 0xFFFF
+			|| !header->channelSize || !header->sampleRate
+			|| header->peakLevels > 32
+			|| fileSize(header->channels, header->channelSize, header->peakLevels) != quint64(size)) {
+		if(data)
+			m_file.unmap(data);
+		m_file.close();
+		return false;
+	}
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+	// modification time orders entries for eviction
+	m_file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+#endif
+
+	m_data = data;
+	m_header = header;
+	return true;
+}
+
+void
+WaveCache::close()
+{
+	if(m_data)
+		m_file.unmap(m_data);
+	m_data = nullptr;
+	m_header = nullptr;
+	m_file.close();
+}
+
+const SAMPLE_TYPE *
+WaveCache::samples(quint16 channel) const
+{
+	Q_ASSERT(m_data && channel < channels());
+	const quint64 offset = align8(sizeof(Header)) + channel * align8(quint64(channelSize()) * sizeof(SAMPLE_TYPE));
+	return reinterpret_cast<const SAMPLE_TYPE *>(m_data + offset);
+}
+
+const WavePeak *
+WaveCache::peaks(quint16 channel, quint8 level) const
+{
+	Q_ASSERT(m_data && channel < channels() && level < peakLevels());
+	quint64 offset = fileSize(channels(), channelSize(), level);
+	offset += channel * align8(quint64(levelSize(channelSize(), level)) * sizeof(WavePeak));
+	return reinterpret_cast<const WavePeak *>(m_data + offset);
+}
+
+bool
+WaveCache::store(const QString &key, quint32 sampleRate, quint32 duration, quint32 channelSize, const QSharedPointer<const WaveData> &data)
+{
+	const int sizeMax = SCConfig::wfCacheSize();
+	if(key.isEmpty() || sizeMax <= 0 || !data || !QDir().mkpath(cacheDir()))
+		return false;
+
+	// entry that doesn't fit would be evicted right away
+	if(fileSize(data->channels, channelSize, data->peakLevels) > quint64(sizeMax) << 20)
+		return false;
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, s_magic, sizeof(s_magic));
+	header.version = Version;
+	header.sampleBits = sizeof(SAMPLE_TYPE) * 8;
+	header.peakBaseShift = WaveBuffer::PEAK_BASE_SHIFT;
+	header.channels = data->channels;
+	header.channelSize = channelSize;
+	header.sampleRate = sampleRate;
+	header.duration = duration;
+	header.peakLevels = data->peakLevels;
+
+	s_writerPool->setMaxThreadCount(1);
+	s_writerPool->start(new Writer(cacheDir() + QChar('/') + key + QStringLiteral(".wave"), header, data, quint64(sizeMax) << 20));
+	return true;
+}
+
+void
+WaveCache::waitForStored()
+{
+	s_writerPool->waitForDone();
+}
+
+void
+WaveCache::evict(quint64 sizeMax)
+{
+	// newest entries are kept
+	const QFileInfoList entries = QDir(cacheDir()).entryInfoList(QStringList(QStringLiteral("*.wave")), QDir::Files, QDir::Time);
+	quint64 size = 0;
+	for(const QFileInfo &entry : entries) {
+		size += entry.size();
+		if(size > sizeMax)
+			QFile::remove(entry.absoluteFilePath());
+	}
+}
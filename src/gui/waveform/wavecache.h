@@ -0,0 +1,83 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef WAVECACHE_H
+#define WAVECACHE_H
+
+#include "gui/waveform/wavebuffer.h"
+
+#include <QFile>
+#include <QSharedPointer>
+#include <QString>
+
+namespace SubtitleComposer {
+/**
+ * @brief On-disk cache of decoded waveforms and their peak pyramids.
+ *
+ * Entries are keyed by media file path, size, modification time, hash of its first and last
+ * MiB and audio stream index. Cached file is memory mapped, so its samples and peaks are used
+ * in place. Entries are written in background and once cache grows over configured size least
+ * recently used entries are removed.
+ *
+ * File: magic[8], u32 version, u32 sample bits, u32 peak base shift, u32 channels,
+ *       u32 channel size, u32 sample rate, u32 duration, u32 peak levels,
+ *       samples of every channel, then peak levels of every channel - all native endian and 8 byte aligned
+ */
+class WaveCache
+{
+public:
+	enum { Version = 1 };
+
+	WaveCache();
+	~WaveCache();
+
+	// returns empty key when media file can't be identified
+	static QString key(const QString &mediaFile, int audioStream);
+
+	// maps cached waveform, data stays valid until close()
+	bool open(const QString &key);
+	void close();
+	inline bool isOpen() const { return m_data != nullptr; }
+
+	inline quint16 channels() const { return m_header->channels; }
+	inline quint32 channelSize() const { return m_header->channelSize; }
+	inline quint32 sampleRate() const { return m_header->sampleRate; }
+	inline quint32 duration() const { return m_header->duration; }
+	inline quint8 peakLevels() const { return m_header->peakLevels; }
+	const SAMPLE_TYPE * samples(quint16 channel) const;
+	const WavePeak * peaks(quint16 channel, quint8 level) const;
+
+	// data is written in background and must not change anymore, returns false if entry won't be written
+	static bool store(const QString &key, quint32 sampleRate, quint32 duration, quint32 channelSize, const QSharedPointer<const WaveData> &data);
+	// blocks until stored entries are written
+	static void waitForStored();
+
+private:
+	class Writer;
+
+	struct Header {
+		char magic[8];
+		quint32 version;
+		quint32 sampleBits;
+		quint32 peakBaseShift;
+		quint32 channels;
+		quint32 channelSize;
+		quint32 sampleRate;
+		quint32 duration;
+		quint32 peakLevels;
+	};
+
+	static QString cacheDir();
+	static quint64 fileSize(quint16 channels, quint32 channelSize, quint8 peakLevels);
+	static void evict(quint64 sizeMax);
+
+	QFile m_file;
+	uchar *m_data;
+	const Header *m_header;
+};
+}
+
+#endif // WAVECACHE_H
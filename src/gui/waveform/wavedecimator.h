@@ -0,0 +1,70 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef WAVEDECIMATOR_H
+#define WAVEDECIMATOR_H
+
+#include "gui/waveform/wavebuffer.h"
+
+namespace SubtitleComposer {
+/**
+ * @brief Min/max decimation of interleaved samples by a power of two.
+ *
+ * Every output frame holds the sample of its bucket that is furthest from silence in every channel,
+ * averaging would flatten short transients. Bucket can be split across any number of buffers, its
+ * part is carried over to the next feed().
+ */
+class WaveDecimator
+{
+public:
+	WaveDecimator(quint8 shift, quint16 channels)
+		: m_bucketSize(quint32(channels) << shift),
+		  m_channels(channels),
+		  m_fill(0),
+		  m_val(new SAMPLE_TYPE[channels])
+	{
+	}
+
+	~WaveDecimator()
+	{
+		delete[] m_val;
+	}
+
+	// interleaved samples that make one output frame
+	inline quint32 bucketSize() const { return m_bucketSize; }
+
+	// drops partially filled bucket
+	inline void reset() { m_fill = 0; }
+
+	// out(const SAMPLE_TYPE *frame) is called for every completed bucket
+	template<typename Out>
+	void feed(const SAMPLE_TYPE *sample, quint32 len, Out out)
+	{
+		const SAMPLE_TYPE *end = sample + len;
+		while(sample != end) {
+			const quint16 ch = m_fill % m_channels;
+			// first sample of every channel starts the bucket
+			if(m_fill < m_channels || WaveBuffer::sampleLevel(*sample) > WaveBuffer::sampleLevel(m_val[ch]))
+				m_val[ch] = *sample;
+			sample++;
+			if(++m_fill == m_bucketSize) {
+				m_fill = 0;
+				out(static_cast<const SAMPLE_TYPE *>(m_val));
+			}
+		}
+	}
+
+private:
+	Q_DISABLE_COPY(WaveDecimator)
+
+	const quint32 m_bucketSize;
+	const quint16 m_channels;
+	quint32 m_fill;
+	SAMPLE_TYPE *m_val;
+};
+}
+
+#endif // WAVEDECIMATOR_H
@@ -36,6 +36,8 @@
 
 #include <KLocalizedString>
 
+#include <algorithm>
+
 using namespace SubtitleComposer;
 
 #define ZOOM_MIN (1 << 3)
@@ -382,12 +384,22 @@ WaveformWidget::updateVisibleLines()
 		}
 	}
 
+	QVector<SubtitleLine *> lines = m_subtitle->linesInRange(m_timeStart, m_timeEnd);
+	if(m_draggedLine) {
+		// dragged line is shown even when it's outside of visible timespan
+		SubtitleLine *dragged = m_draggedLine->line();
+		if(dragged->subtitle() == m_subtitle.data() && !lines.contains(dragged)) {
+			const int draggedIndex = dragged->index();
+			auto pos = std::lower_bound(lines.begin(), lines.end(), draggedIndex, [](const SubtitleLine *l, int index){
+				return l->index() < index;
+			});
+			lines.insert(pos, dragged);
+		}
+	}
+
 	it = m_visibleLines.begin();
-	for(int i = 0, n = m_subtitle->count(); i < n; i++) {
-		SubtitleLine *sub = m_subtitle->at(i);
+	for(SubtitleLine *sub: qAsConst(lines)) {
 		const bool isDragged = m_draggedLine != nullptr && sub == m_draggedLine->line();
-		if(!sub->intersectsTimespan(m_timeStart, m_timeEnd) && !isDragged)
-			continue;
 		const Time showTime = isDragged ? m_draggedLine->showTime() : sub->showTime();
 		while(it != m_visibleLines.end() && (*it)->showTime() < showTime) {
 			if((*it)->line() == sub)
@@ -711,20 +723,9 @@ WaveformWidget::showContextMenu(QPoint pos)
 		menu->addSeparator();
 		needSubtitle.append(
 			menu->addAction(i18n("Join Lines"), this, [&](){
-				int startIndex = -1, endIndex = -1;
-				const Time startTime = rightMouseSoonerTime();
-				const Time endTime = rightMouseLaterTime();
-				for(int idx = 0, n = m_subtitle->count(); idx < n; idx++) {
-					const SubtitleLine *sub = m_subtitle->at(idx);
-					if(sub->intersectsTimespan(startTime, endTime)) {
-						if(startIndex == -1 || startIndex > idx)
-							startIndex = idx;
-						if(endIndex == -1 || endIndex < idx)
-							endIndex = idx;
-					}
-				}
-				if(endIndex >= 0 && startIndex != endIndex)
-					m_subtitle->joinLines(RangeList(Range(startIndex, endIndex)));
+				const QVector<SubtitleLine *> lines = m_subtitle->linesInRange(rightMouseSoonerTime(), rightMouseLaterTime());
+				if(lines.size() > 1)
+					m_subtitle->joinLines(RangeList(Range(lines.first()->index(), lines.last()->index())));
 			})
 		);
 		needCurrentLine.append(
@@ -24,8 +24,8 @@ WaveSubtitle::WaveSubtitle(SubtitleLine *line, WaveRenderer *parent)
 	  m_rend(parent),
 	  m_image(1, 1, QImage::Format_ARGB32_Premultiplied)
 {
-	const RichDocument *doc = m_rend->showTranslation() ? m_line->secondaryDoc() : m_line->primaryDoc();
-	connect(doc, &RichDocument::contentsChanged, this, [&](){ m_imageDirty = true; });
+	connect(m_line, &SubtitleLine::primaryTextChanged, this, [&](){ m_imageDirty = true; });
+	connect(m_line, &SubtitleLine::secondaryTextChanged, this, [&](){ m_imageDirty = true; });
 }
 
 WaveSubtitle::~WaveSubtitle()
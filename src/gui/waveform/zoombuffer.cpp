@@ -6,198 +6,115 @@
 
 #include "zoombuffer.h"
 
-#include <list>
-
-struct DataRange {
-	quint32 start;
-	quint32 end;
-};
-typedef std::list<DataRange> RangeList;
+#include "gui/waveform/peakkernel.h"
 
 using namespace SubtitleComposer;
 
 ZoomBuffer::ZoomBuffer(WaveBuffer *parent)
-	: QThread(parent),
+	: QObject(parent),
 	  m_waveBuffer(parent),
 	  m_samplesPerPixel(0),
-	  m_waveformZoomed(nullptr),
-	  m_waveformZoomedSize(0),
 	  m_waveform(nullptr)
 {
 }
 
-ZoomBuffer::~ZoomBuffer()
-{
-	stopAndClear();
-}
-
-void
-ZoomBuffer::stopAndClear()
-{
-	requestInterruption();
-	wait();
-
-	if(m_waveformZoomed) {
-		m_waveformZoomedSize = 0;
-		for(quint16 ch = 0; ch < m_waveBuffer->channels(); ch++)
-			delete[] m_waveformZoomed[ch];
-		delete[] m_waveformZoomed;
-		m_waveformZoomed = nullptr;
-		m_reqLen = nullptr;
-	}
-}
-
-void
-ZoomBuffer::start()
-{
-	if(!m_samplesPerPixel || !m_waveform)
-		return;
-
-	Q_ASSERT(m_waveformZoomed == nullptr);
-
-	// alloc memory for zoomed pixel data
-	m_waveformZoomedSize = (m_waveBuffer->lengthSamples() + m_samplesPerPixel - 1) / m_samplesPerPixel;
-	m_waveformZoomed = new WaveZoomData *[m_waveBuffer->channels()];
-	for(quint32 i = 0; i < m_waveBuffer->channels(); i++)
-		m_waveformZoomed[i] = new WaveZoomData[m_waveformZoomedSize];
-	emit zoomedBufferReady();
-
-	QThread::start();
-}
-
 void
-ZoomBuffer::run()
+ZoomBuffer::updateZoomRange(quint32 start, quint32 end)
 {
-	Q_ASSERT(m_waveform != nullptr);
-	Q_ASSERT(m_waveformZoomed != nullptr);
-	Q_ASSERT(m_samplesPerPixel > 0);
-	Q_ASSERT(m_waveBuffer->lengthSamples() > 0);
-
-	m_restartProcessing = false;
-
-	RangeList ranges;
-	quint32 lastProcessed = 0;
-	RangeList::iterator range = ranges.end();
-	for(;;) {
-		// wait for more samples if there aren't any
-		if(ranges.empty()) {
-			while(!isInterruptionRequested()) {
-				const bool decoding = m_waveBuffer->isDecoding();
-				const quint32 lastAvailable = m_waveBuffer->samplesAvailable() / m_samplesPerPixel;
-				if(lastProcessed != lastAvailable) {
-					ranges.push_back(DataRange{lastProcessed, lastAvailable});
-					break;
+	const quint16 channels = m_waveBuffer->channels();
+	const quint32 spp = m_samplesPerPixel;
+	const quint32 len = end - start;
+
+	// pick largest pyramid level whose nodes are not wider than a pixel
+	int level = -1;
+	while(level + 1 < m_waveBuffer->peakLevels() && (1U << (WaveBuffer::PEAK_BASE_SHIFT + level + 1)) <= spp)
+		level++;
+
+	for(quint16 ch = 0; ch < channels; ch++) {
+		m_waveformZoomed[ch].resize(len);
+		WaveZoomData *out = m_waveformZoomed[ch].data();
+
+		if(level < 0) {
+			const PagedArray<SAMPLE_TYPE> &samples = *m_waveform[ch];
+			for(quint32 x = 0; x < len; x++) {
+				quint64 sum = 0;
+				quint32 peak = 0;
+				// pixel can span a page boundary
+				for(quint32 i = (start + x) * spp, iEnd = i + spp; i < iEnd;) {
+					const quint32 n = qMin(iEnd, PagedArray<SAMPLE_TYPE>::pageEnd(i)) - i;
+					quint64 pageSum;
+					quint32 pagePeak;
+					PeakKernel::reduce(samples.data(i), n, &pageSum, &pagePeak);
+					sum += pageSum;
+					peak = qMax(peak, pagePeak);
+					i += n;
 				}
-				if(!decoding)
-					break;
-				msleep(100);
+				out[x].min = sum / spp;
+				out[x].max = peak;
 			}
+			continue;
 		}
 
-		// process requested range
-		if(m_reqLen) {
-			QMutexLocker l(&m_reqMutex);
-
-			m_restartProcessing = false;
-
-			RangeList::iterator reqRange = ranges.begin();
-			while(reqRange != ranges.end()) {
-				if(reqRange->start >= m_reqEnd || m_reqStart >= reqRange->end) {
-					++reqRange;
-					continue;
-				}
-				if(reqRange->start < m_reqStart) {
-					// there are samples before requested range
-					ranges.insert(reqRange, DataRange{reqRange->start, m_reqStart});
-					reqRange->start = m_reqStart;
-				}
-				if(reqRange->end > m_reqEnd) {
-					// there are samples after requested range
-					ranges.insert(std::next(reqRange), DataRange{m_reqEnd, reqRange->end});
-					reqRange->end = m_reqEnd;
-				}
-				*m_reqLen = reqRange->start - m_reqStart;
-				emit zoomedBufferReady();
-				break;
-			}
-
-			if(reqRange == ranges.end()) {
-				const quint32 lastAvailable = m_waveBuffer->samplesAvailable() / m_samplesPerPixel;
-				if(lastAvailable < m_reqEnd) {
-					*m_reqLen = lastAvailable - qMin(m_reqStart, lastAvailable);
-				} else {
-					// got whole range... do not check no more
-					*m_reqLen = m_reqEnd - m_reqStart;
-					m_reqLen = nullptr;
-				}
-				emit zoomedBufferReady();
-			} else {
-				range = reqRange;
+		// pixel spans at least one whole node, nodes crossing its start are included
+		const quint8 shift = WaveBuffer::PEAK_BASE_SHIFT + level;
+		const PagedArray<WavePeak> &peaks = m_waveBuffer->peaks(ch, level);
+		for(quint32 x = 0; x < len; x++) {
+			const quint32 nEnd = ((start + x + 1) * spp) >> shift;
+			quint32 n = ((start + x) * spp) >> shift;
+			const quint32 nCount = nEnd - n;
+			quint32 sum = 0;
+			quint32 peak = 0;
+			for(; n < nEnd; n++) {
+				sum += peaks[n].mean;
+				if(peak < peaks[n].peak)
+					peak = peaks[n].peak;
 			}
+			out[x].min = sum / nCount;
+			out[x].max = peak;
 		}
-
-		// there's nothing left
-		if(ranges.empty() || isInterruptionRequested())
-			break;
-
-		// otherwise process what is left
-		if(range == ranges.end())
-			range = ranges.begin();
-
-		Q_ASSERT(range != ranges.end());
-
-		updateZoomRange(&range->start, range->end);
-		lastProcessed = range->start;
-
-		// whole range was processed
-		if(range->start == range->end)
-			range = ranges.erase(range);
 	}
 }
 
 void
-ZoomBuffer::updateZoomRange(quint32 *start, quint32 end)
+ZoomBuffer::updateRequest()
 {
-	Q_ASSERT(end <= m_waveformZoomedSize);
+	const quint32 lastAvailable = m_waveBuffer->peaksAvailable() / m_samplesPerPixel;
+	const quint32 end = qMin(m_reqEnd, lastAvailable);
+	const quint32 start = qMin(m_reqStart, end);
 
-	const quint16 channels = m_waveBuffer->channels();
+	updateZoomRange(start, end);
 
-	while(*start < end) {
-		quint32 i = *start * m_samplesPerPixel;
+	for(quint16 ch = 0; ch < m_waveBuffer->channels(); ch++)
+		m_reqBuffers[ch] = m_waveformZoomed[ch].data();
+	*m_reqLen = end - start;
 
-		for(quint16 ch = 0; ch < channels; ch++) {
-			const quint32 val = qAbs(qint32(m_waveform[ch][i]) - SAMPLE_MIN - (SAMPLE_MAX - SAMPLE_MIN) / 2);
-			m_waveformZoomed[ch][*start].min = val / m_samplesPerPixel;
-			m_waveformZoomed[ch][*start].max = val;
-		}
+	// got whole range... do not check no more
+	if(end == m_reqEnd)
+		m_reqLen = nullptr;
+}
 
-		const quint32 iEnd = i + m_samplesPerPixel;
-		while(++i < iEnd) {
-			for(quint16 ch = 0; ch < channels; ch++) {
-				const quint32 val = qAbs(qint32(m_waveform[ch][i]) - SAMPLE_MIN - (SAMPLE_MAX - SAMPLE_MIN) / 2);
-				m_waveformZoomed[ch][*start].min += val / m_samplesPerPixel;
-				if(m_waveformZoomed[ch][*start].max < val)
-					m_waveformZoomed[ch][*start].max = val;
-			}
-		}
+void
+ZoomBuffer::refresh()
+{
+	QMutexLocker l(&m_publicMutex);
+
+	if(!m_reqLen || !m_waveform)
+		return;
 
-		(*start)++;
+	updateRequest();
 
-		if(isInterruptionRequested() || m_restartProcessing)
-			break;
-	}
+	emit zoomedBufferReady();
 }
 
 void
-ZoomBuffer::setWaveform(const SAMPLE_TYPE * const *waveform)
+ZoomBuffer::setWaveform(const PagedArray<SAMPLE_TYPE> * const *waveform)
 {
 	QMutexLocker l(&m_publicMutex);
 
-	stopAndClear();
-
 	m_waveform = waveform;
-
-	start();
+	m_waveformZoomed.clear();
+	m_waveformZoomed.resize(waveform ? m_waveBuffer->channels() : 0);
+	m_reqLen = nullptr;
 }
 
 void
@@ -208,39 +125,30 @@ ZoomBuffer::setZoomScale(quint32 samplesPerPixel)
 	if(m_samplesPerPixel == samplesPerPixel)
 		return;
 
-	stopAndClear();
-
 	m_samplesPerPixel = samplesPerPixel;
-
-	start();
+	m_reqLen = nullptr;
 }
 
 void
 ZoomBuffer::zoomedBuffer(quint32 timeStart, quint32 timeEnd, WaveZoomData **buffers, quint32 *bufLen)
 {
+	QMutexLocker l(&m_publicMutex);
+
 	*bufLen = 0;
+	m_reqLen = nullptr;
 
-	if(!m_waveform || !m_waveformZoomed)
+	if(!m_waveform || !m_samplesPerPixel)
 		return;
 
-	QMutexLocker l(&m_reqMutex);
-
+	const quint32 zoomedSize = (m_waveBuffer->lengthSamples() + m_samplesPerPixel - 1) / m_samplesPerPixel;
 	m_reqStart = qMin(static_cast<quint32>(static_cast<quint64>(timeStart)
 										   * m_waveBuffer->sampleRate() / m_samplesPerPixel / 1000),
-					  m_waveformZoomedSize);
+					  zoomedSize);
 	m_reqEnd = qMin(static_cast<quint32>(static_cast<quint64>(timeEnd)
 										 * m_waveBuffer->sampleRate() / m_samplesPerPixel / 1000),
-					m_waveformZoomedSize);
+					zoomedSize);
+	m_reqBuffers = buffers;
 	m_reqLen = bufLen;
 
-	for(quint16 ch = 0; ch < m_waveBuffer->channels(); ch++)
-		buffers[ch] = &m_waveformZoomed[ch][m_reqStart];
-
-	if(isFinished()) {
-		const quint32 lastAvailable = m_waveBuffer->samplesAvailable() / m_samplesPerPixel;
-		*bufLen = qMin(m_reqEnd, lastAvailable) - qMin(m_reqStart, lastAvailable);
-	} else {
-		*bufLen = 0;
-		m_restartProcessing = true;
-	}
+	updateRequest();
 }
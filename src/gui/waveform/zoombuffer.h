@@ -8,31 +8,38 @@
 #define ZOOMBUFFER_H
 
 #include <QMutex>
-#include <QThread>
-#include <QWaitCondition>
+#include <QObject>
+#include <QVector>
 
 #include "gui/waveform/wavebuffer.h"
 
 namespace SubtitleComposer {
-class ZoomBuffer : public QThread
+/**
+ * @brief Zoomed waveform of requested time range derived from WaveBuffer's peak pyramid.
+ *
+ * Every pixel is aggregated from at most three nodes of the largest pyramid level that is not
+ * coarser than the zoom scale, so changing zoom costs time proportional to the visible pixels only.
+ * Zoom scales finer than the pyramid base level are computed from the samples directly.
+ */
+class ZoomBuffer : public QObject
 {
 	Q_OBJECT
 
 public:
 	explicit ZoomBuffer(WaveBuffer *parent);
-	virtual ~ZoomBuffer();
 
-	void setWaveform(const SAMPLE_TYPE * const *waveform);
+	void setWaveform(const PagedArray<SAMPLE_TYPE> * const *waveform);
 	void setZoomScale(quint32 samplesPerPixel);
 	void zoomedBuffer(quint32 timeStart, quint32 timeEnd, WaveZoomData **buffers, quint32 *bufLen);
 
 	inline quint32 samplesPerPixel() const { return m_samplesPerPixel; }
 
+	// updates last requested range if it wasn't complete yet
+	void refresh();
+
 private:
-	void run() override;
-	void updateZoomRange(quint32 *start, quint32 end);
-	void stopAndClear();
-	void start();
+	void updateRequest();
+	void updateZoomRange(quint32 start, quint32 end);
 
 signals:
 	void zoomedBufferReady();
@@ -41,17 +48,14 @@ private:
 	WaveBuffer *m_waveBuffer;
 
 	quint32 m_samplesPerPixel;
-	WaveZoomData **m_waveformZoomed;
-	quint32 m_waveformZoomedSize;
-	const SAMPLE_TYPE * const *m_waveform;
+	QVector<QVector<WaveZoomData>> m_waveformZoomed;
+	const PagedArray<SAMPLE_TYPE> * const *m_waveform;
 
 	QMutex m_publicMutex;
 
-	bool m_restartProcessing;
-
-	QMutex m_reqMutex;
 	quint32 m_reqStart = 0;
 	quint32 m_reqEnd = 0;
+	WaveZoomData **m_reqBuffers = nullptr;
 	quint32 *m_reqLen = nullptr;
 };
 }
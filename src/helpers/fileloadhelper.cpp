@@ -10,6 +10,9 @@
 #include <QIODevice>
 #include <QBuffer>
 #include <QDebug>
+#include <QFile>
+
+#include <limits>
 
 #include <kio_version.h>
 #include <kio/statjob.h>
@@ -17,7 +20,8 @@
 
 FileLoadHelper::FileLoadHelper(const QUrl &url) :
 	m_url(url),
-	m_file(0)
+	m_file(0),
+	m_map(nullptr)
 {}
 
 FileLoadHelper::~FileLoadHelper()
@@ -38,6 +42,25 @@ FileLoadHelper::file()
 	return m_file;
 }
 
+QByteArray
+FileLoadHelper::data()
+{
+	QFile *file = qobject_cast<QFile *>(m_file);
+	if(!file)
+		return m_data;
+
+	const qint64 size = file->size();
+	if(!m_map && size > 0 && size <= std::numeric_limits<int>::max())
+		m_map = file->map(0, size);
+	if(m_map)
+		return QByteArray::fromRawData(reinterpret_cast<const char *>(m_map), size);
+
+	// mapping is not possible for some files (e.g. pipes), read them instead
+	if(m_data.isEmpty() && file->seek(0))
+		m_data = file->readAll();
+	return m_data;
+}
+
 bool
 FileLoadHelper::open()
 {
@@ -81,8 +104,9 @@ FileLoadHelper::close()
 	if(!m_file)
 		return false;
 
-	delete m_file;
+	delete m_file; // also unmaps the file
 	m_file = nullptr;
+	m_map = nullptr;
 
 	return true;
 }
@@ -26,6 +26,8 @@ public:
 
 	const QUrl & url();
 	QIODevice * file();
+	// whole file contents without copying, local files are memory mapped - valid until close()
+	QByteArray data();
 
 	bool open();
 	bool close();
@@ -39,6 +41,7 @@ private:
 	QByteArray m_data;
 	QUrl m_url;
 	QIODevice *m_file;
+	uchar *m_map;
 };
 
 #endif
@@ -0,0 +1,145 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "utf8.h"
+
+#include <QtAlgorithms>
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UTF8_SSE2
+#include <emmintrin.h>
+#endif
+
+// returns first byte in [p, end) that is not a 7-bit character
+static inline const uchar *
+skipAscii(const uchar *p, const uchar *end)
+{
+#ifdef UTF8_SSE2
+	for(; end - p >= 16; p += 16) {
+		const uint mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+		if(mask)
+			return p + qCountTrailingZeroBits(mask);
+	}
+#else
+	for(; end - p >= 8; p += 8) {
+		quint64 v;
+		memcpy(&v, p, sizeof(v));
+		if(v & Q_UINT64_C(0x8080808080808080))
+			break;
+	}
+#endif
+	while(p != end && *p < 0x80)
+		p++;
+	return p;
+}
+
+bool
+Utf8::isValid(const char *data, qint64 size, bool *ascii)
+{
+	if(ascii)
+		*ascii = false;
+
+	const uchar *p = reinterpret_cast<const uchar *>(data);
+	const uchar *end = p + size;
+	bool onlyAscii = true;
+	for(;;) {
+		p = skipAscii(p, end);
+		if(p == end)
+			break;
+		onlyAscii = false;
+
+		// valid ranges of the second byte exclude overlong forms, surrogates and values above U+10FFFF
+		const uchar c = *p;
+		int n;
+		uchar lo = 0x80, hi = 0xBF;
+		if(c < 0xC2) {
+			return false;
+		} else if(c < 0xE0) {
+			n = 1;
+		} else if(c < 0xF0) {
+			n = 2;
+			if(c == 0xE0)
+				lo = 0xA0;
+			else if(c == 0xED)
+				hi = 0x9F;
+		} else if(c < 0xF5) {
+			n = 3;
+			if(c == 0xF0)
+				lo = 0x90;
+			else if(c == 0xF4)
+				hi = 0x8F;
+		} else {
+			return false;
+		}
+
+		if(end - p <= n || p[1] < lo || p[1] > hi)
+			return false;
+		for(int i = 2; i <= n; i++) {
+			if((p[i] & 0xC0) != 0x80)
+				return false;
+		}
+		p += n + 1;
+	}
+
+	if(ascii)
+		*ascii = onlyAscii;
+	return true;
+}
+
+int
+Utf8::decode(QString *out, const char *data, int size)
+{
+	// UTF-16 never needs more code units than there are UTF-8 bytes
+	const int outStart = out->size();
+	out->resize(outStart + size);
+	ushort *dst = reinterpret_cast<ushort *>(out->data()) + outStart;
+
+	const uchar *src = reinterpret_cast<const uchar *>(data);
+	const uchar *end = src + size;
+	while(src != end) {
+#ifdef UTF8_SSE2
+		// widen 7-bit characters 16 at a time
+		const __m128i zero = _mm_setzero_si128();
+		while(end - src >= 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+			if(_mm_movemask_epi8(v))
+				break;
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_unpacklo_epi8(v, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 8), _mm_unpackhi_epi8(v, zero));
+			src += 16;
+			dst += 16;
+		}
+		if(src == end)
+			break;
+#endif
+		uint c = *src;
+		if(c < 0x80) {
+			*dst++ = ushort(c);
+			src++;
+			continue;
+		}
+
+		const int n = c < 0xE0 ? 1 : (c < 0xF0 ? 2 : 3);
+		if(end - src <= n)
+			break;
+		if(n == 1) {
+			c = ((c & 0x1F) << 6) | (src[1] & 0x3F);
+		} else if(n == 2) {
+			c = ((c & 0x0F) << 12) | ((src[1] & 0x3F) << 6) | (src[2] & 0x3F);
+		} else {
+			c = ((c & 0x07) << 18) | ((src[1] & 0x3F) << 12) | ((src[2] & 0x3F) << 6) | (src[3] & 0x3F);
+			*dst++ = ushort(QChar::highSurrogate(c));
+			c = QChar::lowSurrogate(c);
+		}
+		*dst++ = ushort(c);
+		src += n + 1;
+	}
+
+	out->resize(int(dst - reinterpret_cast<const ushort *>(out->constData())));
+	return int(src - reinterpret_cast<const uchar *>(data));
+}
@@ -0,0 +1,24 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <QString>
+
+class Utf8
+{
+public:
+	// returns true when data is well formed UTF-8 - overlong forms, surrogates and code points
+	// above U+10FFFF are rejected; ascii is set when data contains only 7-bit characters
+	static bool isValid(const char *data, qint64 size, bool *ascii = nullptr);
+
+	// appends decoded well formed UTF-8 data to out, returns number of bytes consumed -
+	// sequence that is incomplete at the end of data is left for the next call
+	static int decode(QString *out, const char *data, int size);
+};
+
+#endif
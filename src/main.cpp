@@ -126,12 +126,15 @@ handleCommandLine(SubtitleComposer::Application &app, KAboutData &aboutData)
 		}
 	}
 
-	if(!fileSub.isEmpty())
-		app.openSubtitle(System::urlFromPath(fileSub));
-	else
-		app.newSubtitle();
-	if(!fileTrans.isEmpty())
-		app.openSubtitleTr(System::urlFromPath(fileTrans));
+	// unsaved changes of a session that crashed are offered before opening anything
+	if(!app.recoverSession()) {
+		if(!fileSub.isEmpty())
+			app.openSubtitle(System::urlFromPath(fileSub));
+		else
+			app.newSubtitle();
+		if(!fileTrans.isEmpty())
+			app.openSubtitleTr(System::urlFromPath(fileTrans));
+	}
 	if(!fileVideo.isEmpty())
 		app.openVideo(System::urlFromPath(fileVideo));
 }
@@ -79,7 +79,7 @@ Scripting::SubtitleLine::primaryLines() const
 QObject *
 Scripting::SubtitleLine::primaryText() const
 {
-	return new Scripting::RichString(m_backend->primaryDoc()->toRichText(), const_cast<Scripting::SubtitleLine *>(this));
+	return new Scripting::RichString(m_backend->primaryText(), const_cast<Scripting::SubtitleLine *>(this));
 }
 
 void
@@ -87,25 +87,25 @@ Scripting::SubtitleLine::setPrimaryText(QObject *object)
 {
 	const Scripting::RichString *string = qobject_cast<const Scripting::RichString *>(object);
 	if(string)
-		m_backend->primaryDoc()->setRichText(string->m_backend);
+		m_backend->setPrimaryText(string->m_backend);
 }
 
 QString
 Scripting::SubtitleLine::plainPrimaryText() const
 {
-	return m_backend->primaryDoc()->toPlainText();
+	return m_backend->primaryText();
 }
 
 void
 Scripting::SubtitleLine::setPlainPrimaryText(const QString &plainText)
 {
-	m_backend->primaryDoc()->setPlainText(plainText);
+	m_backend->setPrimaryText(SubtitleComposer::RichString(plainText));
 }
 
 QString
 Scripting::SubtitleLine::richPrimaryText() const
 {
-	return m_backend->primaryDoc()->toRichText().richString();
+	return m_backend->primaryText().richString();
 }
 
 void
@@ -113,7 +113,7 @@ Scripting::SubtitleLine::setRichPrimaryText(const QString &richText)
 {
 	SubtitleComposer::RichString text;
 	text.setRichString(richText);
-	m_backend->primaryDoc()->setRichText(text);
+	m_backend->setPrimaryText(text);
 }
 
 int
@@ -137,7 +137,7 @@ Scripting::SubtitleLine::secondaryLines() const
 QObject *
 Scripting::SubtitleLine::secondaryText() const
 {
-	return new Scripting::RichString(m_backend->secondaryDoc()->toRichText(), const_cast<Scripting::SubtitleLine *>(this));
+	return new Scripting::RichString(m_backend->secondaryText(), const_cast<Scripting::SubtitleLine *>(this));
 }
 
 void
@@ -146,27 +146,27 @@ Scripting::SubtitleLine::setSecondaryText(QObject *object)
 	if(app()->translationMode()) {
 		const Scripting::RichString *string = qobject_cast<const Scripting::RichString *>(object);
 		if(string)
-			m_backend->secondaryDoc()->setRichText(string->m_backend);
+			m_backend->setSecondaryText(string->m_backend);
 	}
 }
 
 QString
 Scripting::SubtitleLine::plainSecondaryText() const
 {
-	return m_backend->secondaryDoc()->toPlainText();
+	return m_backend->secondaryText();
 }
 
 void
 Scripting::SubtitleLine::setPlainSecondaryText(const QString &plainText)
 {
 	if(app()->translationMode())
-		m_backend->secondaryDoc()->setPlainText(plainText);
+		m_backend->setSecondaryText(SubtitleComposer::RichString(plainText));
 }
 
 QString
 Scripting::SubtitleLine::richSecondaryText() const
 {
-	return m_backend->secondaryDoc()->toRichText();
+	return m_backend->secondaryText();
 }
 
 void
@@ -175,7 +175,7 @@ Scripting::SubtitleLine::setRichSecondaryText(const QString &richText)
 	if(app()->translationMode()) {
 		SubtitleComposer::RichString text;
 		text.setRichString(richText);
-		m_backend->secondaryDoc()->setRichText(text);
+		m_backend->setSecondaryText(text);
 	}
 }
 
@@ -412,5 +412,5 @@ Scripting::SubtitleLine::check(int errorFlagsToCheck, bool update)
 bool
 Scripting::SubtitleLine::isRightToLeft() const
 {
-	return m_backend->primaryDoc()->toPlainText().isRightToLeft();
+	return m_backend->primaryText().isRightToLeft();
 }
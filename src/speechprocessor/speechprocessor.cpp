@@ -182,7 +182,7 @@ SpeechProcessor::onTextRecognized(const QString &text, const double milliShow, c
 
 	LinesWidgetScrollToModelDetacher detacher(*app()->linesWidget());
 	SubtitleLine *line = new SubtitleLine(milliShow, milliHide);
-	line->primaryDoc()->setPlainText(text);
+	line->setPrimaryText(RichString(text));
 	m_subtitle->insertLine(line);
 }
 
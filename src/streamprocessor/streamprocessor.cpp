@@ -55,6 +55,7 @@ StreamProcessor::open(const QString &filename)
 	m_imageStreamIndex = -1;
 	m_textStreamIndex = -1;
 	m_streamLen = m_streamPos = 0;
+	m_audioStart = m_audioEnd = 0;
 
 #if defined(VERBOSE) || !defined(NDEBUG)
 	av_log_set_level(AV_LOG_VERBOSE);
@@ -248,6 +249,10 @@ StreamProcessor::initAudio(int streamIndex, const WaveFormat &waveFormat)
 	if(!m_audioReady)
 		return false;
 
+	const int64_t streamDuration = m_avStream->duration * 1000 * m_avStream->time_base.num / m_avStream->time_base.den;
+	const int64_t containerDuration = m_avFormat->duration * 1000 / AV_TIME_BASE;
+	m_streamLen = streamDuration > containerDuration ? streamDuration : containerDuration;
+
 	// update stream format so zero values are set to input stream format values
 	if(m_audioStreamFormat.sampleRate() == 0)
 		m_audioStreamFormat.setSampleRate(m_codecCtx->sample_rate);
@@ -300,6 +305,13 @@ StreamProcessor::initAudio(int streamIndex, const WaveFormat &waveFormat)
 	return true;
 }
 
+void
+StreamProcessor::setAudioRange(quint64 msecStart, quint64 msecEnd)
+{
+	m_audioStart = msecStart;
+	m_audioEnd = msecEnd;
+}
+
 bool
 StreamProcessor::initImage(int streamIndex)
 {
@@ -368,9 +380,15 @@ StreamProcessor::processAudio()
 		frameResampled->format = m_audioSampleFormat;
 	}
 
-	const int64_t streamDuration = m_avStream->duration * 1000 * m_avStream->time_base.num / m_avStream->time_base.den;
-	const int64_t containerDuration = m_avFormat->duration * 1000 / AV_TIME_BASE;
-	m_streamLen = streamDuration > containerDuration ? streamDuration : containerDuration;
+	if(m_audioStart) {
+		// seek to keyframe before range start, frames that end before it are skipped
+		const int64_t ts = av_rescale_q(m_audioStart, AVRational{1, 1000}, m_avStream->time_base);
+		ret = av_seek_frame(m_avFormat, m_audioStreamCurrent, ts, AVSEEK_FLAG_BACKWARD);
+		if(ret < 0) {
+			av_strerror(ret, errorText, sizeof(errorText));
+			qWarning() << "Error seeking audio stream, decoding from start" << errorText;
+		}
+	}
 
 	int64_t timeFrameStart = 0;
 	int64_t timeFrameDuration = 0;
@@ -413,6 +431,10 @@ StreamProcessor::processAudio()
 				if(ret == 0) {
 					if(frame->best_effort_timestamp)
 						timeFrameStart = frame->best_effort_timestamp * 1000 * m_avStream->time_base.num / m_avStream->time_base.den;
+					if(m_audioEnd && timeFrameStart >= int64_t(m_audioEnd)) {
+						conversionComplete = true;
+						break;
+					}
 				}
 
 				bool drainSampleBuffer = false;
@@ -446,13 +468,17 @@ StreamProcessor::processAudio()
 						emit streamProgress(m_streamPos, m_streamLen);
 					}
 
+					// frames that end before requested range are dropped
+					const bool inRange = timeFrameEnd > int64_t(m_audioStart);
 					if(m_swResample) {
 						Q_ASSERT(frameResampled != nullptr);
-						emit audioDataAvailable(frameResampled->data[0], qint32(frameSize * frameResampled->channels),
-							&m_audioStreamFormat, qint64(timeFrameStart + timeResampleDelay), qint64(timeFrameDuration));
+						if(inRange) {
+							emit audioDataAvailable(frameResampled->data[0], qint32(frameSize * frameResampled->channels),
+								&m_audioStreamFormat, qint64(timeFrameStart + timeResampleDelay), qint64(timeFrameDuration));
+						}
 
 						drainSampleBuffer = swr_get_out_samples(m_swResample, 0) > 1000;
-					} else {
+					} else if(inRange) {
 						emit audioDataAvailable(frame->data[0], qint32(frameSize * frame->channels),
 							&m_audioStreamFormat, qint64(timeFrameStart), qint64(timeFrameDuration));
 					}
@@ -37,6 +37,8 @@ public:
 
 	bool open(const QString &filename);
 	bool initAudio(int streamIndex, const WaveFormat &waveFormat);
+	// decode only audio in [msecStart, msecEnd) - msecEnd of zero decodes till the end of stream
+	void setAudioRange(quint64 msecStart, quint64 msecEnd);
 	bool initImage(int streamIndex);
 	bool initText(int streamIndex);
 	Q_INVOKABLE void close();
@@ -45,6 +47,8 @@ public:
 	QStringList listText();
 	QStringList listImage();
 
+	inline quint64 length() const { return m_streamLen; }
+
 	bool start();
 
 signals:
@@ -69,6 +73,8 @@ private:
 	int m_audioStreamIndex;
 	int m_audioStreamCurrent;
 	WaveFormat m_audioStreamFormat;
+	quint64 m_audioStart;
+	quint64 m_audioEnd;
 
 	bool m_imageReady;
 	int m_imageStreamIndex;
@@ -0,0 +1,240 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "editjournaltest.h"
+
+#include "core/rangelist.h"
+#include "core/richtext/richcss.h"
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+#include "core/subtitlesnapshot.h"
+#include "core/undo/editjournal.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>                               // krazy:exclude=c++/includes
+
+using namespace SubtitleComposer;
+
+namespace {
+Subtitle *
+createSubtitle()
+{
+	Subtitle *sub = new Subtitle(25.);
+	QList<SubtitleLine *> lines;
+	for(int i = 0; i < 5; i++) {
+		SubtitleLine *line = new SubtitleLine(Time(i * 1000.), Time(i * 1000. + 800.));
+		line->setPrimaryText(RichString(QStringLiteral("line %1").arg(i)));
+		lines.append(line);
+	}
+	sub->insertLines(lines);
+	return sub;
+}
+
+void
+compareSubtitles(const Subtitle &loaded, const Subtitle &sub)
+{
+	QCOMPARE(loaded.count(), sub.count());
+	QCOMPARE(loaded.framesPerSecond(), sub.framesPerSecond());
+	QCOMPARE(loaded.stylesheet()->unformattedCSS(), sub.stylesheet()->unformattedCSS());
+	for(int i = 0; i < sub.count(); i++) {
+		QCOMPARE(loaded.at(i)->showTime().toMillis(), sub.at(i)->showTime().toMillis());
+		QCOMPARE(loaded.at(i)->hideTime().toMillis(), sub.at(i)->hideTime().toMillis());
+		QCOMPARE(loaded.at(i)->primaryText().richString(), sub.at(i)->primaryText().richString());
+		QCOMPARE(loaded.at(i)->secondaryText().richString(), sub.at(i)->secondaryText().richString());
+		QCOMPARE(loaded.at(i)->errorFlags(), sub.at(i)->errorFlags());
+		QCOMPARE(loaded.isLineAnchored(i), sub.isLineAnchored(i));
+		QVERIFY(loaded.at(i)->pos() == sub.at(i)->pos());
+		QCOMPARE(loaded.at(i)->snapshot().metaData(), sub.at(i)->snapshot().metaData());
+	}
+}
+}
+
+void
+EditJournalTest::testReplay()
+{
+	QTemporaryDir dir;
+	const QString path = dir.filePath(QStringLiteral("session"));
+	QExplicitlySharedDataPointer<Subtitle> sub(createSubtitle());
+
+	EditJournal journal;
+	QVERIFY(journal.open(path, sub.data()));
+
+	sub->at(1)->setPrimaryText(RichString(QStringLiteral("changed")));
+	journal.commit();
+
+	// line is moved by its new show time
+	sub->at(3)->setTimes(Time(100.), Time(200.));
+	journal.commit();
+	QCOMPARE(sub->at(1)->primaryText().string(), QStringLiteral("line 3"));
+
+	sub->removeLines(RangeList(Range(2, 3)), Both);
+	journal.commit();
+
+	SubtitleRect pos;
+	pos.top = 10.f;
+	pos.vAlign = SubtitleRect::TOP;
+	sub->at(0)->setPosition(pos);
+	journal.commit();
+	sub->at(1)->meta("comment", QStringLiteral("meta"));
+	journal.commit();
+
+	// position and meta data have to stay with their lines when those are reordered
+	sub->shiftLines(RangeList(Range(0, 1)), 10000);
+	journal.commit();
+	sub->sortLines(Range::full());
+	journal.commit();
+	QCOMPARE(sub->at(1)->primaryText().string(), QStringLiteral("line 0"));
+	QVERIFY(sub->at(1)->pos() == pos);
+	QCOMPARE(sub->at(2)->meta("comment"), QStringLiteral("meta"));
+
+	sub->insertLines(QList<SubtitleLine *>() << new SubtitleLine(Time(2500.), Time(2900.)));
+	sub->at(0)->setSecondaryText(RichString(QStringLiteral("translated")));
+	sub->at(1)->setErrorFlags(SubtitleLine::MaxDuration);
+	sub->setFramesPerSecond(30.);
+	sub->toggleLineAnchor(2);
+	sub->stylesheetAppend(QStringLiteral("::cue(.yellow) { color: yellow; }"));
+	journal.commit();
+
+	EditJournal::Info info{QUrl(QStringLiteral("file:///tmp/test.srt")), QStringLiteral("SubRip"), true, QUrl(), QString()};
+	journal.setInfo(info);
+
+	QExplicitlySharedDataPointer<Subtitle> loaded(new Subtitle());
+	EditJournal::Info loadedInfo{QUrl(), QString(), false, QUrl(), QString()};
+	QVERIFY(EditJournal::replay(path, loaded.data(), &loadedInfo));
+	compareSubtitles(*loaded, *sub);
+	QCOMPARE(loadedInfo.url, info.url);
+	QCOMPARE(loadedInfo.format, info.format);
+	QCOMPARE(loadedInfo.translationMode, true);
+
+	journal.close();
+	QVERIFY(!QFile::exists(path + QStringLiteral(".journal")));
+}
+
+void
+EditJournalTest::testIncompleteTransaction()
+{
+	QTemporaryDir dir;
+	const QString path = dir.filePath(QStringLiteral("session"));
+	QExplicitlySharedDataPointer<Subtitle> sub(createSubtitle());
+
+	EditJournal journal;
+	QVERIFY(journal.open(path, sub.data()));
+	sub->at(4)->setPrimaryText(RichString(QStringLiteral("committed")));
+	journal.commit();
+	journal.close(false);
+
+	// remove lines record (type 4) without commit, followed by a record cut short
+	QFile file(path + QStringLiteral(".journal"));
+	QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+	file.write(QByteArray::fromHex("08000000" "04" "00000000" "00000000"));
+	file.write(QByteArray::fromHex("20000000" "07" "0000"));
+	file.close();
+
+	QExplicitlySharedDataPointer<Subtitle> loaded(new Subtitle());
+	QVERIFY(EditJournal::replay(path, loaded.data()));
+	compareSubtitles(*loaded, *sub);
+	QCOMPARE(loaded->at(4)->primaryText().string(), QStringLiteral("committed"));
+}
+
+void
+EditJournalTest::testCompact()
+{
+	QTemporaryDir dir;
+	const QString path = dir.filePath(QStringLiteral("session"));
+	QExplicitlySharedDataPointer<Subtitle> sub(createSubtitle());
+
+	EditJournal journal;
+	QVERIFY(journal.open(path, sub.data()));
+	for(int i = 0; i < sub->count(); i++) {
+		sub->at(i)->setSecondaryText(RichString(QStringLiteral("secondary %1").arg(i)));
+		journal.commit();
+	}
+	const qint64 journalSize = QFileInfo(path + QStringLiteral(".journal")).size();
+
+	QVERIFY(journal.compact());
+	QVERIFY(!QFile::exists(path + QStringLiteral(".1.scproj")));
+	QVERIFY(QFile::exists(path + QStringLiteral(".2.scproj")));
+	QVERIFY(QFileInfo(path + QStringLiteral(".journal")).size() < journalSize);
+
+	sub->at(0)->setPrimaryText(RichString(QStringLiteral("after compact")));
+	journal.commit();
+
+	QExplicitlySharedDataPointer<Subtitle> loaded(new Subtitle());
+	QVERIFY(EditJournal::replay(path, loaded.data()));
+	compareSubtitles(*loaded, *sub);
+}
+
+void
+EditJournalTest::testLiveSessionLock()
+{
+#if QT_VERSION < QT_VERSION_CHECK(5, 10, 0)
+	QSKIP("setting file time requires Qt 5.10");
+#else
+	QStandardPaths::setTestModeEnabled(true);
+	const QString path = EditJournal::newSessionPath();
+	QExplicitlySharedDataPointer<Subtitle> sub(createSubtitle());
+
+	EditJournal journal;
+	QVERIFY(journal.open(path, sub.data()));
+
+	// lock of a session that was started long ago is still held by a running instance
+	QFile lockFile(path + QStringLiteral(".lock"));
+	QVERIFY(lockFile.open(QIODevice::ReadWrite));
+	QVERIFY(lockFile.setFileTime(QDateTime::currentDateTime().addSecs(-120), QFileDevice::FileModificationTime));
+	lockFile.close();
+
+	QVERIFY(!EditJournal::orphanedSessions().contains(path));
+	QVERIFY(QFile::exists(path + QStringLiteral(".lock")));
+	QVERIFY(QFile::exists(path + QStringLiteral(".journal")));
+
+	journal.close();
+	QVERIFY(!QFile::exists(path + QStringLiteral(".journal")));
+#endif
+}
+
+void
+EditJournalTest::testHasChanges()
+{
+	QTemporaryDir dir;
+	const QString path = dir.filePath(QStringLiteral("session"));
+	QExplicitlySharedDataPointer<Subtitle> sub(createSubtitle());
+
+	// only header, info and commit records
+	EditJournal journal;
+	QVERIFY(journal.open(path, sub.data()));
+	journal.setInfo(EditJournal::Info{QUrl(QStringLiteral("file:///tmp/test.srt")), QStringLiteral("SubRip"), false, QUrl(), QString()});
+	journal.close(false);
+	QVERIFY(!EditJournal::hasChanges(path));
+	QExplicitlySharedDataPointer<Subtitle> loaded(new Subtitle());
+	bool changed = true;
+	QVERIFY(EditJournal::replay(path, loaded.data(), nullptr, &changed));
+	QVERIFY(!changed);
+
+	QVERIFY(journal.open(path, sub.data()));
+	sub->at(0)->setPrimaryText(RichString(QStringLiteral("changed")));
+	journal.commit();
+	journal.close(false);
+	QVERIFY(EditJournal::hasChanges(path));
+	loaded = new Subtitle();
+	QVERIFY(EditJournal::replay(path, loaded.data(), nullptr, &changed));
+	QVERIFY(changed);
+
+	// snapshot of a dirty subtitle holds changes that are not journaled
+	QExplicitlySharedDataPointer<Subtitle> dirty(createSubtitle());
+	dirty->markPrimaryDirty();
+	QVERIFY(journal.open(path, dirty.data()));
+	journal.close(false);
+	QVERIFY(EditJournal::hasChanges(path));
+	loaded = new Subtitle();
+	QVERIFY(EditJournal::replay(path, loaded.data(), nullptr, &changed));
+	QVERIFY(changed);
+}
+
+QTEST_GUILESS_MAIN(EditJournalTest);
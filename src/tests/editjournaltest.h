@@ -0,0 +1,24 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef EDITJOURNALTEST_H
+#define EDITJOURNALTEST_H
+
+#include <QObject>
+
+class EditJournalTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void testReplay();
+	void testIncompleteTransaction();
+	void testCompact();
+	void testLiveSessionLock();
+	void testHasChanges();
+};
+
+#endif
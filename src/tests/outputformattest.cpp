@@ -0,0 +1,155 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "outputformattest.h"
+
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+#include "core/subtitlesnapshot.h"
+#include "formats/subrip/subripoutputformat.h"
+#include "formats/substationalpha/substationalphaoutputformat.h"
+#include "formats/webvtt/webvttoutputformat.h"
+#include "subriptestdata.h"
+
+#include <QTest>
+
+using namespace SubtitleComposer;
+
+namespace {
+class SubRipWriter : public SubRipOutputFormat
+{
+public:
+	using SubRipOutputFormat::dumpLines;
+};
+
+class SubStationAlphaWriter : public SubStationAlphaOutputFormat
+{
+public:
+	using SubStationAlphaOutputFormat::dumpLines;
+};
+
+class AdvancedSubStationAlphaWriter : public AdvancedSubStationAlphaOutputFormat
+{
+public:
+	using AdvancedSubStationAlphaOutputFormat::dumpLines;
+};
+
+class WebVTTWriter : public WebVTTOutputFormat
+{
+public:
+	using WebVTTOutputFormat::dumpLines;
+};
+
+// enough lines to be written by several workers
+const int cues = 20000;
+
+QExplicitlySharedDataPointer<Subtitle>
+createSubtitle()
+{
+	SubRipParser parser;
+	QExplicitlySharedDataPointer<Subtitle> sub(new Subtitle());
+	parser.parseSubtitles(*sub, generateSubRip(cues));
+	return sub;
+}
+
+// all lines written in one go on the calling thread
+template<class W>
+QString
+dumpSerial(const W &writer, const Subtitle &subtitle)
+{
+	QString text;
+	{
+		TextWriter out(&text);
+		const SubtitleSnapshot snapshot = subtitle.snapshot();
+		writer.dumpLines(snapshot, true, 0, snapshot.count(), out);
+	}
+	return text;
+}
+}
+
+void
+OutputFormatTest::testSubRip()
+{
+	QExplicitlySharedDataPointer<Subtitle> sub = createSubtitle();
+	QCOMPARE(sub->count(), cues);
+
+	SubRipWriter writer;
+	const QString data = writer.writeSubtitle(*sub, true);
+	QVERIFY(data.startsWith(QStringLiteral("1\n00:00:00,000 --> 00:00:00,400\n")));
+
+	// lines written in parallel must match lines written in one go
+	QCOMPARE(data, dumpSerial(writer, *sub));
+
+	SubRipParser parser;
+	QExplicitlySharedDataPointer<Subtitle> reparsed(new Subtitle());
+	QVERIFY(parser.parseSubtitles(*reparsed, data));
+	QCOMPARE(reparsed->count(), cues);
+	for(int i = 0; i < cues; i += 997) {
+		QCOMPARE(reparsed->at(i)->showTime().toMillis(), sub->at(i)->showTime().toMillis());
+		QCOMPARE(reparsed->at(i)->hideTime().toMillis(), sub->at(i)->hideTime().toMillis());
+		QCOMPARE(reparsed->at(i)->primaryText().richString(), sub->at(i)->primaryText().richString());
+	}
+}
+
+void
+OutputFormatTest::testSubStationAlpha_data()
+{
+	QTest::addColumn<bool>("advanced");
+
+	QTest::newRow("ssa") << false;
+	QTest::newRow("ass") << true;
+}
+
+void
+OutputFormatTest::testSubStationAlpha()
+{
+	QFETCH(bool, advanced);
+
+	QExplicitlySharedDataPointer<Subtitle> sub = createSubtitle();
+
+	QString data, serial;
+	if(advanced) {
+		AdvancedSubStationAlphaWriter writer;
+		data = writer.writeSubtitle(*sub, true);
+		serial = dumpSerial(writer, *sub);
+	} else {
+		SubStationAlphaWriter writer;
+		data = writer.writeSubtitle(*sub, true);
+		serial = dumpSerial(writer, *sub);
+	}
+
+	// header followed by dialogue lines in the same order as written in one go
+	QVERIFY(data.startsWith(QStringLiteral("[Script Info]\n")));
+	QVERIFY(data.endsWith(serial));
+	QVERIFY(data.left(data.size() - serial.size()).endsWith(QStringLiteral(", Effect, Text\n\n")));
+	QCOMPARE(serial.count(QStringLiteral("Dialogue: ")), cues);
+	QVERIFY(serial.startsWith(QStringLiteral("Dialogue: ")));
+	QVERIFY(serial.contains(QStringLiteral(",0:00:00.00,0:00:00.40,Default,,0000,0000,0000,,Line {\\i1}number{\\i0} 0\\Nsecond row\n")));
+}
+
+void
+OutputFormatTest::testWebVTT()
+{
+	QExplicitlySharedDataPointer<Subtitle> sub = createSubtitle();
+	// notes and ids are written by workers too
+	for(int i = 0; i < cues; i += 101) {
+		sub->at(i)->meta("comment", QStringLiteral("note\n\nwith empty line"));
+		sub->at(i)->meta("id", QStringLiteral("cue") + QString::number(i));
+	}
+
+	WebVTTWriter writer;
+	const QString data = writer.writeSubtitle(*sub, true);
+	const QString serial = dumpSerial(writer, *sub);
+
+	QVERIFY(data.startsWith(QStringLiteral("WEBVTT\n")));
+	QVERIFY(data.endsWith(serial));
+	QCOMPARE(serial.count(QStringLiteral(" --> ")), cues);
+	QCOMPARE(serial.count(QStringLiteral("NOTE\nnote\n \nwith empty line\n\n")), (cues + 100) / 101);
+	QVERIFY(serial.startsWith(QStringLiteral("NOTE\nnote\n \nwith empty line\n\ncue0\n00:00:00.000 --> ")));
+	QVERIFY(serial.contains(QStringLiteral("with empty line\n\ncue19998\n")));
+}
+
+QTEST_MAIN(OutputFormatTest);
@@ -0,0 +1,23 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef OUTPUTFORMATTEST_H
+#define OUTPUTFORMATTEST_H
+
+#include <QObject>
+
+class OutputFormatTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void testSubRip();
+	void testSubStationAlpha_data();
+	void testSubStationAlpha();
+	void testWebVTT();
+};
+
+#endif
@@ -0,0 +1,124 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "pagedarraytest.h"
+#include "gui/waveform/pagedarray.h"
+
+#include <QRunnable>
+#include <QTest>                               // krazy:exclude=c++/includes
+#include <QThreadPool>
+#include <QVector>
+
+using namespace SubtitleComposer;
+
+typedef PagedArray<qint16> Array;
+
+namespace {
+class Writer : public QRunnable
+{
+public:
+	Writer(Array *array, quint32 start, quint32 end)
+		: m_array(array),
+		  m_start(start),
+		  m_end(end)
+	{}
+
+	void run() override
+	{
+		m_array->reserve(m_start, m_end);
+		for(quint32 i = m_start; i < m_end; i++)
+			(*m_array)[i] = qint16(i);
+	}
+
+private:
+	Array *m_array;
+	const quint32 m_start;
+	const quint32 m_end;
+};
+}
+
+void
+PagedArrayTest::testReserve()
+{
+	Array array(3 * Array::PageSize + 100);
+	const Array &constArray = array;
+	QCOMPARE(array.capacity(), quint32(3 * Array::PageSize + 100));
+
+	// pages that weren't reserved all read from the same zeroed page
+	QCOMPARE(constArray.data(0), constArray.data(Array::PageSize));
+	QCOMPARE(constArray[Array::PageSize + 5], qint16(0));
+
+	// only pages touching [start, end) are allocated
+	array.reserve(Array::PageSize - 1, Array::PageSize + 1);
+	QVERIFY(constArray.data(0) != constArray.data(Array::PageSize));
+	QVERIFY(constArray.data(0) != constArray.data(2 * Array::PageSize));
+	QCOMPARE(constArray.data(2 * Array::PageSize), constArray.data(3 * Array::PageSize));
+
+	// allocated pages are zeroed, and reserving them again keeps their data
+	QCOMPARE(constArray[Array::PageSize - 1], qint16(0));
+	array[Array::PageSize - 1] = 1;
+	array[Array::PageSize] = 2;
+	array.reserve(0, 2 * Array::PageSize);
+	QCOMPARE(constArray[Array::PageSize - 1], qint16(1));
+	QCOMPARE(constArray[Array::PageSize], qint16(2));
+
+	// end is clamped to capacity, last page is partial
+	array.reserve(3 * Array::PageSize, 10 * Array::PageSize);
+	array[3 * Array::PageSize + 99] = 3;
+	QCOMPARE(constArray[3 * Array::PageSize + 99], qint16(3));
+
+	// empty range allocates nothing
+	const qint16 *zeroPage = constArray.data(2 * Array::PageSize);
+	array.reserve(2 * Array::PageSize + 1, 2 * Array::PageSize + 1);
+	QCOMPARE(constArray.data(2 * Array::PageSize), zeroPage);
+
+	QCOMPARE(Array::pageEnd(0), quint32(Array::PageSize));
+	QCOMPARE(Array::pageEnd(Array::PageSize - 1), quint32(Array::PageSize));
+	QCOMPARE(Array::pageEnd(Array::PageSize), quint32(2 * Array::PageSize));
+}
+
+void
+PagedArrayTest::testConcurrentReserve()
+{
+	const quint32 size = 8 * Array::PageSize;
+	Array array(size);
+
+	// writers share pages at their boundaries, each page has to be allocated once
+	QThreadPool pool;
+	const quint32 step = Array::PageSize / 3;
+	for(quint32 start = 0; start < size; start += step)
+		pool.start(new Writer(&array, start, qMin(size, start + step)));
+	pool.waitForDone();
+
+	const Array &constArray = array;
+	for(quint32 i = 0; i < size; i++) {
+		if(constArray[i] != qint16(i))
+			QFAIL(qPrintable(QStringLiteral("element %1 was lost").arg(i)));
+	}
+}
+
+void
+PagedArrayTest::testExternal()
+{
+	QVector<qint16> data(Array::PageSize + 10);
+	for(int i = 0; i < data.size(); i++)
+		data[i] = qint16(i * 3);
+
+	{
+		Array array(data.constData(), data.size());
+		const Array &constArray = array;
+		QCOMPARE(constArray.data(0), data.constData());
+		QCOMPARE(constArray.data(Array::PageSize + 1), data.constData() + Array::PageSize + 1);
+		// wrapped pages are already there
+		array.reserve(0, data.size());
+		QCOMPARE(constArray.data(Array::PageSize), data.constData() + Array::PageSize);
+		QCOMPARE(constArray[Array::PageSize + 9], qint16((Array::PageSize + 9) * 3));
+	}
+	// memory is not owned by the array
+	QCOMPARE(data.at(5), qint16(15));
+}
+
+QTEST_GUILESS_MAIN(PagedArrayTest);
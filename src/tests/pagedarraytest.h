@@ -0,0 +1,22 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef PAGEDARRAYTEST_H
+#define PAGEDARRAYTEST_H
+
+#include <QObject>
+
+class PagedArrayTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void testReserve();
+	void testConcurrentReserve();
+	void testExternal();
+};
+
+#endif
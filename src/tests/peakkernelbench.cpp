@@ -0,0 +1,58 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "gui/waveform/peakkernel.h"
+
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <cstdio>
+
+using namespace SubtitleComposer;
+
+// reports samples/second of every supported peak kernel
+int
+main(int /*argc*/, char ** /*argv*/)
+{
+	const int sampleCount = 1 << 22;
+	const int rounds = 50;
+
+	QVector<SAMPLE_TYPE> samples(sampleCount);
+	quint32 seed = 1;
+	for(SAMPLE_TYPE &sample : samples) {
+		seed = seed * 1103515245 + 12345;
+		sample = SAMPLE_TYPE(seed >> 16);
+	}
+	QVector<WavePeak> peaks(sampleCount >> WaveBuffer::PEAK_BASE_SHIFT);
+
+	for(int kind = PeakKernel::Generic; kind < PeakKernel::KindCount; kind++) {
+		const char *name = PeakKernel::name(PeakKernel::Kind(kind));
+		if(!PeakKernel::setKind(PeakKernel::Kind(kind))) {
+			printf("%-8s not supported\n", name);
+			continue;
+		}
+
+		QElapsedTimer timer;
+		quint64 sum = 0;
+		quint32 peak = 0;
+		timer.start();
+		for(int i = 0; i < rounds; i++)
+			PeakKernel::reduce(samples.constData(), sampleCount, &sum, &peak);
+		const qint64 reduceNs = qMax(timer.nsecsElapsed(), Q_INT64_C(1));
+
+		timer.restart();
+		for(int i = 0; i < rounds; i++)
+			PeakKernel::reduceNodes(samples.constData(), peaks.size(), peaks.data());
+		const qint64 nodesNs = qMax(timer.nsecsElapsed(), Q_INT64_C(1));
+
+		printf("%-8s reduce: %8.1f Msamples/s   reduceNodes: %8.1f Msamples/s   (%llu %u)\n", name,
+			   double(sampleCount) * rounds * 1000. / reduceNs,
+			   double(sampleCount) * rounds * 1000. / nodesNs,
+			   static_cast<unsigned long long>(sum), peak);
+	}
+
+	return 0;
+}
@@ -0,0 +1,112 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "peakkerneltest.h"
+#include "gui/waveform/peakkernel.h"
+
+#include <QTest>                               // krazy:exclude=c++/includes
+
+using namespace SubtitleComposer;
+
+void
+PeakKernelTest::initTestCase()
+{
+	quint32 seed = 1;
+	m_samples.resize(200000);
+	for(SAMPLE_TYPE &sample : m_samples) {
+		seed = seed * 1103515245 + 12345;
+		sample = SAMPLE_TYPE(seed >> 16);
+	}
+	// extremes are where vector abs and unsigned max can go wrong
+	m_samples[3] = SAMPLE_MIN;
+	m_samples[21] = SAMPLE_MAX;
+	m_samples[40] = -1;
+	m_samples[41] = 0;
+}
+
+void
+PeakKernelTest::cleanupTestCase()
+{
+	PeakKernel::setKind(PeakKernel::Generic);
+}
+
+void
+PeakKernelTest::testReduce_data()
+{
+	QTest::addColumn<int>("kind");
+	QTest::addColumn<int>("offset");
+	QTest::addColumn<int>("count");
+
+	for(int kind = PeakKernel::Generic; kind < PeakKernel::KindCount; kind++) {
+		const char *name = PeakKernel::name(PeakKernel::Kind(kind));
+		for(int count : {0, 1, 7, 8, 15, 16, 17, 31, 1000, 199990}) {
+			QTest::newRow(QByteArray(name).append(' ').append(QByteArray::number(count)).constData()) << kind << 0 << count;
+			QTest::newRow(QByteArray(name).append(" unaligned ").append(QByteArray::number(count)).constData()) << kind << 3 << count;
+		}
+	}
+}
+
+void
+PeakKernelTest::testReduce()
+{
+	QFETCH(int, kind);
+	QFETCH(int, offset);
+	QFETCH(int, count);
+
+	if(!PeakKernel::setKind(PeakKernel::Kind(kind)))
+		QSKIP("kernel is not supported");
+
+	quint64 expectedSum = 0;
+	quint32 expectedPeak = 0;
+	for(int i = offset; i < offset + count; i++) {
+		const quint32 val = WaveBuffer::sampleLevel(m_samples[i]);
+		expectedSum += val;
+		expectedPeak = qMax(expectedPeak, val);
+	}
+
+	quint64 sum = 1;
+	quint32 peak = 1;
+	PeakKernel::reduce(m_samples.constData() + offset, count, &sum, &peak);
+	QCOMPARE(sum, expectedSum);
+	QCOMPARE(peak, expectedPeak);
+}
+
+void
+PeakKernelTest::testReduceNodes_data()
+{
+	QTest::addColumn<int>("kind");
+
+	for(int kind = PeakKernel::Generic; kind < PeakKernel::KindCount; kind++)
+		QTest::newRow(PeakKernel::name(PeakKernel::Kind(kind))) << kind;
+}
+
+void
+PeakKernelTest::testReduceNodes()
+{
+	QFETCH(int, kind);
+
+	if(!PeakKernel::setKind(PeakKernel::Kind(kind)))
+		QSKIP("kernel is not supported");
+
+	const int nodeSize = 1 << WaveBuffer::PEAK_BASE_SHIFT;
+	const int nodeCount = m_samples.size() / nodeSize;
+	QVector<WavePeak> peaks(nodeCount);
+	PeakKernel::reduceNodes(m_samples.constData(), nodeCount, peaks.data());
+
+	for(int n = 0; n < nodeCount; n++) {
+		quint32 sum = 0;
+		quint32 peak = 0;
+		for(int i = n * nodeSize; i < (n + 1) * nodeSize; i++) {
+			const quint32 val = WaveBuffer::sampleLevel(m_samples[i]);
+			sum += val;
+			peak = qMax(peak, val);
+		}
+		QCOMPARE(quint32(peaks[n].mean), sum >> WaveBuffer::PEAK_BASE_SHIFT);
+		QCOMPARE(quint32(peaks[n].peak), peak);
+	}
+}
+
+QTEST_GUILESS_MAIN(PeakKernelTest)
@@ -0,0 +1,31 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef PEAKKERNELTEST_H
+#define PEAKKERNELTEST_H
+
+#include <QObject>
+#include <QVector>
+
+#include "gui/waveform/wavebuffer.h"
+
+class PeakKernelTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void initTestCase();
+	void cleanupTestCase();
+	void testReduce_data();
+	void testReduce();
+	void testReduceNodes_data();
+	void testReduceNodes();
+
+private:
+	QVector<SAMPLE_TYPE> m_samples;
+};
+
+#endif
@@ -0,0 +1,146 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "projectfiletest.h"
+
+#include "core/richtext/richcss.h"
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+#include "formats/project/projectfile.h"
+#include "formats/project/projectinputformat.h"
+
+#include <QBuffer>
+#include <QTest>                               // krazy:exclude=c++/includes
+
+using namespace SubtitleComposer;
+
+namespace {
+class ProjectReader : public ProjectInputFormat
+{
+};
+
+QByteArray
+writeProject(const Subtitle &subtitle)
+{
+	QBuffer buf;
+	buf.open(QIODevice::WriteOnly);
+	if(!ProjectFile::write(&buf, subtitle, true))
+		return QByteArray();
+	return buf.data();
+}
+}
+
+void
+ProjectFileTest::testRoundTrip()
+{
+	QExplicitlySharedDataPointer<Subtitle> sub(new Subtitle(25.));
+	sub->meta("comment.intro.0", QStringLiteral("intro"));
+	sub->stylesheetAppend(QStringLiteral("::cue(.yellow) { color: yellow; }"));
+
+	QList<SubtitleLine *> lines;
+	for(int i = 0; i < 3; i++) {
+		SubtitleLine *line = new SubtitleLine(Time(i * 1000.), Time(i * 1000. + 800.));
+		line->setPrimaryText(RichString::fromRichString(QStringLiteral("line <i>%1</i>\n<b>bold</b>").arg(i)));
+		lines.append(line);
+	}
+	sub->insertLines(lines);
+	sub->at(2)->setPrimaryText(RichString::fromRichString(QStringLiteral("<v Bob>voice <c.yellow>class</c></v> <font color=#ff0000>red</font>")));
+
+	SubtitleRect pos;
+	pos.top = 10.f;
+	pos.left = 20.5f;
+	pos.vertical = true;
+	pos.hAlign = SubtitleRect::END;
+	sub->at(1)->setPosition(pos);
+	sub->at(1)->meta("id", QStringLiteral("cue-1"));
+	sub->at(2)->setErrorFlags(SubtitleLine::MaxDuration | SubtitleLine::OverlapsWithNext);
+	sub->toggleLineAnchor(1);
+
+	const QByteArray data = writeProject(*sub);
+	QVERIFY(ProjectFile::hasMagic(data));
+	QCOMPARE(data.size() % 8, 0);
+
+	const ProjectFile project(data);
+	QVERIFY(project.isValid());
+	QCOMPARE(project.lineCount(), 3);
+	QCOMPARE(project.lineShowTime(2).toMillis(), 2000.);
+	QCOMPARE(project.lineText(0).richString(), sub->at(0)->primaryText().richString());
+
+	QExplicitlySharedDataPointer<Subtitle> loaded(new Subtitle());
+	QVERIFY(ProjectReader().readProject(*loaded, project));
+	QCOMPARE(loaded->count(), 3);
+	QCOMPARE(loaded->framesPerSecond(), 25.);
+	QCOMPARE(loaded->meta("comment.intro.0"), QStringLiteral("intro"));
+	QCOMPARE(loaded->stylesheet()->unformattedCSS(), sub->stylesheet()->unformattedCSS());
+	for(int i = 0; i < 3; i++) {
+		QCOMPARE(loaded->at(i)->showTime().toMillis(), sub->at(i)->showTime().toMillis());
+		QCOMPARE(loaded->at(i)->hideTime().toMillis(), sub->at(i)->hideTime().toMillis());
+		QCOMPARE(loaded->at(i)->primaryText().richString(), sub->at(i)->primaryText().richString());
+		QCOMPARE(loaded->at(i)->errorFlags(), sub->at(i)->errorFlags());
+		QVERIFY(loaded->at(i)->pos() == sub->at(i)->pos());
+		QCOMPARE(loaded->isLineAnchored(i), sub->isLineAnchored(i));
+	}
+	QCOMPARE(loaded->at(1)->meta("id"), QStringLiteral("cue-1"));
+	QCOMPARE(loaded->at(2)->primaryText().styleVoiceAt(0), QStringLiteral("Bob"));
+	QVERIFY(loaded->at(2)->primaryText().styleClassesAt(6).contains(QStringLiteral("yellow")));
+	QVERIFY(loaded->at(2)->primaryText().styleFlagsAt(12) & RichString::Color);
+	QCOMPARE(loaded->at(2)->primaryText().styleColorAt(12), sub->at(2)->primaryText().styleColorAt(12));
+}
+
+void
+ProjectFileTest::testCorruptText()
+{
+	QExplicitlySharedDataPointer<Subtitle> sub(new Subtitle());
+	SubtitleLine *line = new SubtitleLine(Time(0.), Time(1000.));
+	line->setPrimaryText(RichString::fromRichString(QStringLiteral("<v Bob>hi</v>")));
+	sub->insertLines(QList<SubtitleLine *>() << line);
+	QCOMPARE(line->primaryText().styleVoiceAt(0), QStringLiteral("Bob"));
+
+	QByteArray data = writeProject(*sub);
+	QVERIFY(ProjectFile(data).isValid());
+	bool ok = false;
+	ProjectFile(data).lineText(0, &ok);
+	QVERIFY(ok);
+
+	// text ends with the only style run, whose last field is little endian voice index
+	const QByteArray text = ProjectFile(data).section(ProjectFile::SectionText);
+	QVERIFY(!text.isEmpty());
+	const int voiceOffset = text.constData() - data.constData() + text.size() - 4;
+	QCOMPARE(data.mid(voiceOffset, 4), QByteArray("\0\0\0\0", 4));
+
+	// voice index outside of voice list is refused
+	data[voiceOffset] = 1;
+	const ProjectFile corrupt(data);
+	QVERIFY(corrupt.isValid());
+	QVERIFY(corrupt.lineText(0, &ok).isEmpty());
+	QVERIFY(!ok);
+	QExplicitlySharedDataPointer<Subtitle> loaded(new Subtitle());
+	QVERIFY(!ProjectReader().readProject(*loaded, corrupt));
+	QCOMPARE(loaded->count(), 0);
+}
+
+void
+ProjectFileTest::testInvalid()
+{
+	QExplicitlySharedDataPointer<Subtitle> sub(new Subtitle());
+	sub->insertLines(QList<SubtitleLine *>() << new SubtitleLine(Time(0.), Time(1000.)));
+	const QByteArray data = writeProject(*sub);
+	QVERIFY(ProjectFile(data).isValid());
+
+	QVERIFY(!ProjectFile(QByteArray("1\n00:00:01,000 --> 00:00:02,000\ntext\n")).isValid());
+	QVERIFY(!ProjectFile(data.left(20)).isValid());
+
+	// sections pointing outside of the data are refused
+	QByteArray truncated = data.left(data.size() - 8);
+	QVERIFY(!ProjectFile(truncated).isValid());
+
+	// newer versions are refused
+	QByteArray newer = data;
+	newer[8] = char(ProjectFile::Version + 1);
+	QVERIFY(!ProjectFile(newer).isValid());
+}
+
+QTEST_GUILESS_MAIN(ProjectFileTest);
@@ -0,0 +1,22 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef PROJECTFILETEST_H
+#define PROJECTFILETEST_H
+
+#include <QObject>
+
+class ProjectFileTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void testRoundTrip();
+	void testInvalid();
+	void testCorruptText();
+};
+
+#endif
@@ -79,4 +79,63 @@ RangeListTest::testJoinAndTrim()
 	QVERIFY(ranges.rangesCount() == 1 && ranges.indexesCount() == 5);
 }
 
+void
+RangeListTest::testContains()
+{
+	RangeList ranges;
+	ranges << Range(20, 25);
+	ranges << Range(1, 2);
+	ranges << Range(10, 12);
+	QVERIFY(ranges.rangesCount() == 3 && ranges.firstIndex() == 1 && ranges.lastIndex() == 25);
+
+	QVERIFY(!ranges.contains(0));
+	QVERIFY(ranges.contains(1) && ranges.contains(2));
+	QVERIFY(!ranges.contains(3) && !ranges.contains(9));
+	QVERIFY(ranges.contains(10) && ranges.contains(12));
+	QVERIFY(ranges.contains(25) && !ranges.contains(26));
+
+	// scattered selection
+	RangeList scattered;
+	for(int i = 1000; i >= 0; i -= 3)
+		scattered << Range(i);
+	QVERIFY(scattered.rangesCount() == 334);
+	for(int i = 0; i < 1010; i++)
+		QVERIFY(scattered.contains(i) == (i <= 1000 && (1000 - i) % 3 == 0));
+
+	// lookups must follow modifications
+	scattered << Range(2000, Range::MaxIndex);
+	QVERIFY(scattered.contains(1 << 30));
+	QVERIFY(!scattered.contains(1001));
+	scattered.trimToIndex(500);
+	QVERIFY(!scattered.contains(502) && scattered.contains(499));
+}
+
+void
+RangeListTest::testUniteAndIntersect()
+{
+	RangeList a;
+	a << Range(0, 4);
+	a << Range(10, 14);
+	a << Range(20, 24);
+
+	RangeList b;
+	b << Range(3, 11);
+	b << Range(15, 16);
+	b << Range(30, 31);
+
+	RangeList u = a.united(b);
+	QVERIFY(u.rangesCount() == 3);
+	QVERIFY(u.range(0) == Range(0, 16));
+	QVERIFY(u.range(1) == Range(20, 24));
+	QVERIFY(u.range(2) == Range(30, 31));
+
+	RangeList i = a.intersected(b);
+	QVERIFY(i.rangesCount() == 2);
+	QVERIFY(i.range(0) == Range(3, 4));
+	QVERIFY(i.range(1) == Range(10, 11));
+
+	QVERIFY(a.intersected(a.complement()).isEmpty());
+	QVERIFY(a.united(a.complement()).isFullRange());
+}
+
 QTEST_GUILESS_MAIN(RangeListTest);
@@ -16,6 +16,8 @@ class RangeListTest : public QObject
 private slots:
 	void testConstructors();
 	void testJoinAndTrim();
+	void testContains();
+	void testUniteAndIntersect();
 };
 
 #endif
@@ -0,0 +1,41 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "subripbench.h"
+
+#include "subriptestdata.h"
+
+#include <QTest>
+
+using namespace SubtitleComposer;
+
+void
+SubRipBench::benchmarkParse_data()
+{
+	QTest::addColumn<bool>("regex");
+
+	QTest::newRow("regex") << true;
+	QTest::newRow("tokenizer") << false;
+}
+
+void
+SubRipBench::benchmarkParse()
+{
+	QFETCH(bool, regex);
+
+	const int cues = 100000;
+	const QString data = generateSubRip(cues);
+	SubRipParser parser;
+
+	QBENCHMARK {
+		QExplicitlySharedDataPointer<Subtitle> sub(new Subtitle());
+		const bool res = regex ? parseSubtitlesRegEx(*sub, data) : parser.parseSubtitles(*sub, data);
+		QVERIFY(res);
+		QCOMPARE(sub->count(), cues);
+	}
+}
+
+QTEST_MAIN(SubRipBench);
@@ -0,0 +1,21 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SUBRIPBENCH_H
+#define SUBRIPBENCH_H
+
+#include <QObject>
+
+class SubRipBench : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void benchmarkParse_data();
+	void benchmarkParse();
+};
+
+#endif
@@ -0,0 +1,116 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "subripinputtest.h"
+
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+#include "subriptestdata.h"
+
+#include <QScopedPointer>
+#include <QTest>
+
+using namespace SubtitleComposer;
+
+void
+SubRipInputTest::testParse()
+{
+	const QString data = QStringLiteral(
+		"1\n00:00:01,000 --> 00:00:02,500\n<b>Bold</b> text\n\n"
+		"2\n00:01:02.5 --> 00:01:03,250\n  first\nsecond  \n\n\n"
+		"3\n01:00:00,000 --> 01:00:01,000\nends with 42\n"
+		"01:00:02,000 --> 01:00:03,000\n");
+
+	SubRipParser parser;
+	QExplicitlySharedDataPointer<Subtitle> tokenized(new Subtitle());
+	QExplicitlySharedDataPointer<Subtitle> reference(new Subtitle());
+	QVERIFY(parser.parseSubtitles(*tokenized, data));
+	QVERIFY(parseSubtitlesRegEx(*reference, data));
+
+	QCOMPARE(tokenized->count(), 4);
+	QCOMPARE(tokenized->at(0)->showTime().toMillis(), 1000.);
+	QCOMPARE(tokenized->at(0)->hideTime().toMillis(), 2500.);
+	QCOMPARE(tokenized->at(0)->primaryText().richString(), QStringLiteral("<b>Bold</b> text"));
+	QCOMPARE(tokenized->at(1)->showTime().toMillis(), 62005.);
+	QCOMPARE(QString(tokenized->at(1)->primaryText()), QStringLiteral("first\nsecond"));
+	QCOMPARE(QString(tokenized->at(2)->primaryText()), QStringLiteral("ends with"));
+	QCOMPARE(QString(tokenized->at(3)->primaryText()), QString());
+
+	QCOMPARE(tokenized->count(), reference->count());
+	for(int i = 0; i < reference->count(); i++) {
+		QCOMPARE(tokenized->at(i)->showTime().toMillis(), reference->at(i)->showTime().toMillis());
+		QCOMPARE(tokenized->at(i)->hideTime().toMillis(), reference->at(i)->hideTime().toMillis());
+		QCOMPARE(tokenized->at(i)->primaryText().richString(), reference->at(i)->primaryText().richString());
+	}
+}
+
+void
+SubRipInputTest::testInvalid()
+{
+	SubRipParser parser;
+	QExplicitlySharedDataPointer<Subtitle> sub(new Subtitle());
+	QVERIFY(!parser.parseSubtitles(*sub, QString()));
+	QVERIFY(!parser.parseSubtitles(*sub, QStringLiteral("WEBVTT\n\n00:00:01.000 --> 00:00:02.000\ntext\n")));
+	QVERIFY(!parser.parseSubtitles(*sub, QStringLiteral("1\n00:00:01,000 -> 00:00:02,000\ntext\n")));
+	QVERIFY(!parser.parseSubtitles(*sub, QStringLiteral("1\n00:00:01,000 --> 00:00:02,000")));
+	QCOMPARE(sub->count(), 0);
+}
+
+void
+SubRipInputTest::testParallel()
+{
+	// big enough to be split between several workers
+	const int cues = 40000;
+	const QString data = generateSubRip(cues);
+
+	SubRipParser parser;
+	QExplicitlySharedDataPointer<Subtitle> parallel(new Subtitle());
+	QExplicitlySharedDataPointer<Subtitle> reference(new Subtitle());
+	QVERIFY(parser.parseSubtitles(*parallel, data));
+	QVERIFY(parseSubtitlesRegEx(*reference, data));
+
+	QCOMPARE(parallel->count(), cues);
+	for(int i = 0; i < cues; i++) {
+		QCOMPARE(parallel->at(i)->showTime().toMillis(), reference->at(i)->showTime().toMillis());
+		QCOMPARE(parallel->at(i)->hideTime().toMillis(), reference->at(i)->hideTime().toMillis());
+		QCOMPARE(parallel->at(i)->primaryText().richString(), reference->at(i)->primaryText().richString());
+	}
+}
+
+void
+SubRipInputTest::testReader()
+{
+	// fed in chunks that split cues at arbitrary places, big enough to be handed to workers
+	const int cues = 40000;
+	const QString data = generateSubRip(cues);
+
+	SubRipParser parser;
+	QScopedPointer<InputFormat::Reader> reader(parser.createReader());
+	QVERIFY(reader);
+	for(int off = 0; off < data.size(); off += 7919)
+		reader->feed(data.mid(off, 7919));
+	QExplicitlySharedDataPointer<Subtitle> chunked(new Subtitle());
+	QVERIFY(reader->finish(*chunked));
+
+	QExplicitlySharedDataPointer<Subtitle> reference(new Subtitle());
+	QVERIFY(parser.parseSubtitles(*reference, data));
+
+	QCOMPARE(chunked->count(), cues);
+	for(int i = 0; i < cues; i++) {
+		QCOMPARE(chunked->at(i)->showTime().toMillis(), reference->at(i)->showTime().toMillis());
+		QCOMPARE(chunked->at(i)->hideTime().toMillis(), reference->at(i)->hideTime().toMillis());
+		QCOMPARE(chunked->at(i)->primaryText().richString(), reference->at(i)->primaryText().richString());
+	}
+
+	QScopedPointer<InputFormat::Reader> invalid(parser.createReader());
+	invalid->feed(QStringLiteral("WEBVTT\n\n00:00:01.000 --> "));
+	invalid->feed(QStringLiteral("00:00:02.000\ntext\n"));
+	QExplicitlySharedDataPointer<Subtitle> sub(new Subtitle());
+	QVERIFY(!invalid->finish(*sub));
+	QCOMPARE(sub->count(), 0);
+}
+
+QTEST_MAIN(SubRipInputTest);
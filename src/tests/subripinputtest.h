@@ -0,0 +1,23 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SUBRIPINPUTTEST_H
+#define SUBRIPINPUTTEST_H
+
+#include <QObject>
+
+class SubRipInputTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void testParse();
+	void testInvalid();
+	void testParallel();
+	void testReader();
+};
+
+#endif
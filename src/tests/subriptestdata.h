@@ -0,0 +1,74 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SUBRIPTESTDATA_H
+#define SUBRIPTESTDATA_H
+
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+#include "formats/subrip/subripinputformat.h"
+
+#include <QRegularExpression>
+#include <QString>
+
+namespace SubtitleComposer {
+class SubRipParser : public SubRipInputFormat
+{
+public:
+	using SubRipInputFormat::parseSubtitles;
+	using SubRipInputFormat::createReader;
+};
+
+// regular expression based parser that was used before the tokenizer, kept for comparison
+inline bool
+parseSubtitlesRegEx(Subtitle &subtitle, const QString &data)
+{
+	staticRE$(reTime, "[\\d]+\n([0-2][0-9]):([0-5][0-9]):([0-5][0-9])[,\\.]([0-9]+) --> ([0-2][0-9]):([0-5][0-9]):([0-5][0-9])[,\\.]([0-9]+)\n", REu);
+
+	QRegularExpressionMatchIterator itTime = reTime.globalMatch(data);
+	if(!itTime.hasNext())
+		return false;
+
+	QList<SubtitleLine *> lines;
+	do {
+		QRegularExpressionMatch mTime = itTime.next();
+
+		Time showTime(mTime.captured(1).toInt(), mTime.captured(2).toInt(), mTime.captured(3).toInt(), mTime.captured(4).toInt());
+		Time hideTime(mTime.captured(5).toInt(), mTime.captured(6).toInt(), mTime.captured(7).toInt(), mTime.captured(8).toInt());
+
+		const int off = mTime.capturedEnd();
+		const QString text = data.mid(off, itTime.hasNext() ? itTime.peekNext().capturedStart() - off : -1).trimmed();
+
+		RichString stext;
+		stext.setRichString(text);
+
+		SubtitleLine *line = new SubtitleLine(showTime, hideTime);
+		line->setPrimaryText(stext);
+		lines.append(line);
+	} while(itTime.hasNext());
+	subtitle.insertLines(lines);
+
+	return true;
+}
+
+inline QString
+generateSubRip(int cues)
+{
+	QString data;
+	data.reserve(cues * 64);
+	for(int i = 0; i < cues; i++) {
+		const Time showTime(i * 500.);
+		const Time hideTime(i * 500. + 400.);
+		data += QString::number(i + 1) + QChar::LineFeed
+			+ showTime.toString(true).replace(QChar('.'), QChar(',')) + QStringLiteral(" --> ")
+			+ hideTime.toString(true).replace(QChar('.'), QChar(',')) + QChar::LineFeed
+			+ QStringLiteral("Line <i>number</i> ") + QString::number(i) + QStringLiteral("\nsecond row\n\n");
+	}
+	return data;
+}
+}
+
+#endif
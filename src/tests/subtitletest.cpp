@@ -9,6 +9,9 @@
 #include <QTest>
 
 #include "core/richtext/richdocument.h"
+#include "core/subtitlesnapshot.h"
+#include "core/undo/subtitleactions.h"
+#include "core/undo/subtitlelineactions.h"
 
 #include <klocalizedstring.h>
 
@@ -50,7 +53,7 @@ SubtitleTest::testSort()
 
 	for(int n: lines) {
 		SubtitleLine *l = new SubtitleLine(n * 1000, n * 1000 + 500);
-		l->primaryDoc()->setPlainText(QString::number(n));
+		l->setPrimaryText(RichString(QString::number(n)));
 		sub->insertLine(l);
 	}
 
@@ -59,4 +62,386 @@ SubtitleTest::testSort()
 		QVERIFY(qRound(sub->at(i)->showTime().toSeconds()) == i + 1);
 }
 
+void
+SubtitleTest::testSortLines()
+{
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+
+	QList<SubtitleLine *> lines;
+	for(int n = 0; n < 5; n++) {
+		SubtitleLine *l = new SubtitleLine(n * 1000, n * 1000 + 500);
+		l->setPrimaryText(RichString(QString::number(n)));
+		lines.append(l);
+	}
+	sub->insertLines(lines);
+
+	// set times without sorting, equal times must keep their order
+	QVector<Time> showTimes, hideTimes;
+	for(int t: {4, 1, 3, 1, 0}) {
+		showTimes.append(t * 1000);
+		hideTimes.append(t * 1000 + 500);
+	}
+	UndoAction *action = new SetLinesTimesAction(sub.data(), QVector<int>({0, 1, 2, 3, 4}), showTimes, hideTimes, QString());
+	action->redo();
+	delete action;
+	sub->sortLines(Range::full());
+
+	QCOMPARE(sub->count(), 5);
+	for(int i = 0; i < sub->count(); i++) {
+		QCOMPARE(sub->at(i)->index(), i);
+		if(i)
+			QVERIFY(sub->at(i - 1)->showTime() <= sub->at(i)->showTime());
+	}
+	QCOMPARE(QString(sub->at(0)->primaryText()), QStringLiteral("4"));
+	QCOMPARE(QString(sub->at(1)->primaryText()), QStringLiteral("1"));
+	QCOMPARE(QString(sub->at(2)->primaryText()), QStringLiteral("3"));
+	QCOMPARE(QString(sub->at(3)->primaryText()), QStringLiteral("2"));
+	QCOMPARE(QString(sub->at(4)->primaryText()), QStringLiteral("0"));
+
+	// undo restores original order
+	action = new PermuteLinesAction(sub.data(), 1, QVector<int>({3, 0, 2, 1}));
+	action->redo();
+	QCOMPARE(QString(sub->at(1)->primaryText()), QStringLiteral("0"));
+	QCOMPARE(QString(sub->at(2)->primaryText()), QStringLiteral("1"));
+	QCOMPARE(QString(sub->at(3)->primaryText()), QStringLiteral("2"));
+	QCOMPARE(QString(sub->at(4)->primaryText()), QStringLiteral("3"));
+	QCOMPARE(sub->at(4)->index(), 4);
+	action->undo();
+	QCOMPARE(QString(sub->at(1)->primaryText()), QStringLiteral("1"));
+	QCOMPARE(QString(sub->at(3)->primaryText()), QStringLiteral("2"));
+	QCOMPARE(QString(sub->at(4)->primaryText()), QStringLiteral("0"));
+	delete action;
+}
+
+void
+SubtitleTest::testInsertLines()
+{
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+
+	// appending to empty subtitle
+	QList<SubtitleLine *> lines;
+	for(int n: {2, 4, 6, 8})
+		lines.append(new SubtitleLine(n * 1000, n * 1000 + 500));
+	sub->insertLines(lines);
+	QCOMPARE(sub->count(), 4);
+
+	// unsorted lines, interleaved with existing ones and with duplicate show time
+	lines.clear();
+	for(int n: {9, 1, 5, 3, 7, 4, 10})
+		lines.append(new SubtitleLine(n * 1000, n * 1000 + 500));
+	SubtitleLine *dup = lines.at(5);
+	sub->insertLines(lines);
+
+	QCOMPARE(sub->count(), 11);
+	const int expected[] = {1, 2, 3, 4, 4, 5, 6, 7, 8, 9, 10};
+	for(int i = 0; i < sub->count(); i++) {
+		QCOMPARE(qRound(sub->at(i)->showTime().toSeconds()), expected[i]);
+		QCOMPARE(sub->at(i)->index(), i);
+	}
+	// line with same show time goes after the existing one
+	QCOMPARE(sub->at(4), dup);
+}
+
+void
+SubtitleTest::testLineIndexes()
+{
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+
+	// enough lines to span several chunks of the line list
+	QList<SubtitleLine *> lines;
+	for(int i = 0; i < 3000; i++)
+		lines.append(new SubtitleLine(i * 1000, i * 1000 + 500));
+	sub->insertLines(lines);
+	QCOMPARE(sub->count(), 3000);
+
+	SubtitleLine *first = sub->insertNewLine(0, false, SubtitleTarget::Both);
+	SubtitleLine *middle = sub->insertNewLine(1500, true, SubtitleTarget::Both);
+	SubtitleLine *last = sub->insertNewLine(sub->count(), true, SubtitleTarget::Both);
+	QCOMPARE(sub->count(), 3003);
+	QCOMPARE(first->index(), 0);
+	QCOMPARE(middle->index(), 1500);
+	QCOMPARE(last->index(), 3002);
+
+	RangeList ranges;
+	ranges << Range(10, 700) << Range(1400, 1499) << Range(2900, 2950);
+	sub->removeLines(ranges, SubtitleTarget::Both);
+	QCOMPARE(sub->count(), 3003 - 691 - 100 - 51);
+	QCOMPARE(middle->index(), 1500 - 691 - 100);
+
+	for(int i = 0; i < sub->count(); i++)
+		QCOMPARE(sub->at(i)->index(), i);
+	for(int i = sub->count() - 1; i >= 0; i -= 7)
+		QCOMPARE(sub->at(i)->index(), i);
+}
+
+void
+SubtitleTest::testLinesInRange()
+{
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+
+	QList<SubtitleLine *> lines;
+	lines.append(new SubtitleLine(0, 10000)); // overlaps everything below
+	lines.append(new SubtitleLine(1000, 2000));
+	lines.append(new SubtitleLine(3000, 4000));
+	lines.append(new SubtitleLine(3500, 5000));
+	lines.append(new SubtitleLine(12000, 13000));
+	sub->insertLines(lines);
+
+	QVector<SubtitleLine *> res = sub->linesAt(3700);
+	QCOMPARE(res.size(), 3);
+	QCOMPARE(res.at(0)->index(), 0);
+	QCOMPARE(res.at(1)->index(), 2);
+	QCOMPARE(res.at(2)->index(), 3);
+
+	res = sub->linesInRange(4500, 12000);
+	QCOMPARE(res.size(), 3);
+	QCOMPARE(res.at(0)->index(), 0);
+	QCOMPARE(res.at(1)->index(), 3);
+	QCOMPARE(res.at(2)->index(), 4);
+
+	QVERIFY(sub->linesAt(11000).isEmpty());
+	QVERIFY(sub->linesInRange(2000, 1000).isEmpty());
+
+	// index must follow hide time changes
+	sub->at(0)->setHideTime(500);
+	res = sub->linesAt(3700);
+	QCOMPARE(res.size(), 2);
+	QCOMPARE(res.at(0)->index(), 2);
+	sub->at(4)->setHideTime(20000);
+	QCOMPARE(sub->linesAt(15000).size(), 1);
+}
+
+void
+SubtitleTest::testRetimeLines()
+{
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+
+	QList<SubtitleLine *> lines;
+	lines.append(new SubtitleLine(100, 900));
+	lines.append(new SubtitleLine(1000, 2000));
+	lines.append(new SubtitleLine(3000, 4000));
+	sub->insertLines(lines);
+
+	sub->shiftLines(RangeList(Range(1, 2)), 500);
+	QCOMPARE(sub->at(0)->showTime().toMillis(), 100.);
+	QCOMPARE(sub->at(1)->showTime().toMillis(), 1500.);
+	QCOMPARE(sub->at(2)->hideTime().toMillis(), 4500.);
+
+	sub->adjustLines(Range::full(), 0, 6800);
+	QCOMPARE(sub->at(0)->showTime().toMillis(), 0.);
+	QCOMPARE(sub->at(1)->showTime().toMillis(), 2800.);
+	QCOMPARE(sub->at(2)->showTime().toMillis(), 6800.);
+
+	// undo must restore times that were clamped at zero
+	UndoAction *action = new AdjustLinesTimesAction(sub.data(), RangeList(Range::full()), -1000., 1., QString());
+	action->redo();
+	QCOMPARE(sub->at(0)->showTime().toMillis(), 0.);
+	QCOMPARE(sub->at(0)->hideTime().toMillis(), 600.);
+	QCOMPARE(sub->at(1)->showTime().toMillis(), 1800.);
+	action->undo();
+	QCOMPARE(sub->at(0)->showTime().toMillis(), 0.);
+	QCOMPARE(sub->at(0)->hideTime().toMillis(), 1600.);
+	QCOMPARE(sub->at(1)->showTime().toMillis(), 2800.);
+	action->redo();
+	QCOMPARE(sub->at(0)->hideTime().toMillis(), 600.);
+	action->undo();
+	QCOMPARE(sub->at(0)->hideTime().toMillis(), 1600.);
+	delete action;
+
+	// non-unit scale must restore whole and fractional times exactly
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+	lines.clear();
+	for(int i = 0; i < 1000; i++)
+		lines.append(new SubtitleLine(i * 1337, i * 1337 + (i % 3 ? 800 : 800.3)));
+	sub->insertLines(lines);
+	action = new AdjustLinesTimesAction(sub.data(), RangeList(Range::full()), 12.5, 1.001, QString());
+	action->redo();
+	QCOMPARE(sub->at(1)->showTime().toMillis(), 1337 * 1.001 + 12.5);
+	action->undo();
+	for(int i = 0; i < 1000; i++) {
+		QCOMPARE(sub->at(i)->showTime().toMillis(), double(i * 1337));
+		QCOMPARE(sub->at(i)->hideTime().toMillis(), i * 1337 + (i % 3 ? 800 : 800.3));
+	}
+	delete action;
+}
+
+void
+SubtitleTest::testCompositeSignals()
+{
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+
+	QList<SubtitleLine *> lines;
+	for(int i = 0; i < 6; i++)
+		lines.append(new SubtitleLine(i * 1000, i * 1000 + 500));
+	sub->insertLines(lines);
+
+	int lineSignals = 0;
+	QList<RangeList> rangeSignals;
+	QMetaObject::Connection c1 = connect(sub.data(), &Subtitle::linePrimaryTextChanged, [&](){ lineSignals++; });
+	QMetaObject::Connection c2 = connect(sub.data(), &Subtitle::linesPrimaryTextChanged, [&](const RangeList &r){ rangeSignals.append(r); });
+
+	sub->at(1)->setPrimaryText(RichString(QStringLiteral("single")));
+	QCOMPARE(lineSignals, 1);
+	QVERIFY(rangeSignals.isEmpty());
+
+	{
+		SubtitleCompositeActionExecutor executor(sub.data(), QString());
+		sub->at(4)->setPrimaryText(RichString(QStringLiteral("d")));
+		sub->at(2)->setPrimaryText(RichString(QStringLiteral("b")));
+		sub->at(0)->setPrimaryText(RichString(QStringLiteral("a")));
+		sub->at(3)->setPrimaryText(RichString(QStringLiteral("c")));
+		// lines that are removed inside of composite action are not reported
+		sub->at(5)->setPrimaryText(RichString(QStringLiteral("e")));
+		sub->removeLines(RangeList(Range(5)), SubtitleTarget::Both);
+		QCOMPARE(lineSignals, 1);
+		QVERIFY(rangeSignals.isEmpty());
+	}
+
+	QCOMPARE(lineSignals, 1);
+	QCOMPARE(rangeSignals.size(), 1);
+	QCOMPARE(rangeSignals.first().rangesCount(), 2);
+	QCOMPARE(rangeSignals.first().range(0), Range(0));
+	QCOMPARE(rangeSignals.first().range(1), Range(2, 4));
+
+	disconnect(c1);
+	disconnect(c2);
+
+	// show and hide time changes are reported together once
+	QList<RangeList> timesSignals;
+	QMetaObject::Connection c3 = connect(sub.data(), &Subtitle::linesTimesChanged, [&](const RangeList &r){ timesSignals.append(r); });
+	sub->shiftLines(RangeList(Range(1, 3)), 100);
+	QCOMPARE(timesSignals.size(), 1);
+	QCOMPARE(timesSignals.first().rangesCount(), 1);
+	QCOMPARE(timesSignals.first().range(0), Range(1, 3));
+	disconnect(c3);
+}
+
+void
+SubtitleTest::testLineText()
+{
+	const int cacheSize = SubtitleLine::documentCacheSize();
+	SubtitleLine::setDocumentCacheSize(1);
+
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+
+	RichString text(QStringLiteral("bold"), RichString::Bold);
+	text.append(RichString(QStringLiteral(" plain")));
+
+	SubtitleLine *l1 = new SubtitleLine(1000, 1500);
+	l1->setPrimaryText(text);
+	l1->setSecondaryText(RichString(QStringLiteral("second")));
+	sub->insertLine(l1);
+	SubtitleLine *l2 = new SubtitleLine(2000, 2500);
+	sub->insertLine(l2);
+
+	QCOMPARE(l1->primaryText().richString(), text.richString());
+	QCOMPARE(l1->primaryCharacters(), 10);
+	QCOMPARE(QString(l1->secondaryText()), QStringLiteral("second"));
+
+	// edit through document, then push it out of the cache
+	l1->primaryDoc()->setPlainText(QStringLiteral("edited\ntext"));
+	QCOMPARE(QString(l1->primaryText()), QStringLiteral("edited\ntext"));
+	l2->primaryDoc()->setPlainText(QStringLiteral("other"));
+	QCOMPARE(QString(l1->primaryText()), QStringLiteral("edited\ntext"));
+	QCOMPARE(l1->primaryLines(), 2);
+	QCOMPARE(l1->primaryDoc()->toPlainText(), QStringLiteral("edited\ntext"));
+
+	// cached text statistics must follow text changes
+	QCOMPARE(l1->primaryWords(), 2);
+	l1->setPrimaryText(RichString(QStringLiteral("  one  two three ")));
+	QCOMPARE(l1->primaryWords(), 3);
+	QCOMPARE(l1->primaryCharacters(), 13);
+	QCOMPARE(l1->primaryLines(), 1);
+	QCOMPARE(l1->autoDuration(10, 0, 0, Primary).toMillis(), 130.);
+
+	SubtitleLine::setDocumentCacheSize(cacheSize);
+}
+
+void
+SubtitleTest::testLineTextUndo()
+{
+	const int cacheSize = SubtitleLine::documentCacheSize();
+	SubtitleLine::setDocumentCacheSize(1);
+
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+
+	SubtitleLine *l1 = new SubtitleLine(1000, 1500);
+	l1->setPrimaryText(RichString(QStringLiteral("before")));
+	sub->insertLine(l1);
+	SubtitleLine *l2 = new SubtitleLine(2000, 2500);
+	sub->insertLine(l2);
+
+	// text action without document
+	UndoAction *textAction = new SetLinePrimaryTextAction(l1, l1->primaryText(), RichString(QStringLiteral("after")), nullptr);
+	textAction->redo();
+	QCOMPARE(QString(l1->primaryText()), QStringLiteral("after"));
+
+	// document action uses document history
+	RichDocument *doc = l1->primaryDoc();
+	doc->setPlainText(QStringLiteral("typed"));
+	UndoAction *docAction = new SetLinePrimaryTextAction(l1, RichString(QStringLiteral("after")), l1->primaryText(), doc);
+	docAction->undo();
+	QCOMPARE(QString(l1->primaryText()), QStringLiteral("after"));
+	QCOMPARE(doc->toPlainText(), QStringLiteral("after"));
+
+	// document created after the action has no history of it
+	textAction->undo();
+	QCOMPARE(QString(l1->primaryText()), QStringLiteral("before"));
+	QCOMPARE(l1->primaryDoc()->toPlainText(), QStringLiteral("before"));
+	textAction->redo();
+	QCOMPARE(QString(l1->primaryText()), QStringLiteral("after"));
+
+	// document is released although an action used it
+	l2->primaryDoc();
+	docAction->redo();
+	QCOMPARE(QString(l1->primaryText()), QStringLiteral("typed"));
+	docAction->undo();
+	QCOMPARE(QString(l1->primaryText()), QStringLiteral("after"));
+
+	delete docAction;
+	delete textAction;
+
+	SubtitleLine::setDocumentCacheSize(cacheSize);
+}
+
+void
+SubtitleTest::testSnapshot()
+{
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+
+	QList<SubtitleLine *> lines;
+	for(int i = 0; i < 3; i++) {
+		SubtitleLine *line = new SubtitleLine(i * 1000, i * 1000 + 500);
+		line->setPrimaryText(RichString(QStringLiteral("line %1").arg(i)));
+		lines.append(line);
+	}
+	sub->insertLines(lines);
+
+	const SubtitleSnapshot first = sub->snapshot();
+	QCOMPARE(first.count(), 3);
+	QCOMPARE(QString(first.at(1).primaryText()), QStringLiteral("line 1"));
+	QCOMPARE(first.at(1).showTime().toMillis(), 1000.);
+
+	// edits don't touch existing snapshot
+	lines.at(1)->setPrimaryText(RichString(QStringLiteral("changed")));
+	lines.at(2)->setHideTime(2800);
+	sub->removeLines(RangeList(Range(0)), SubtitleTarget::Both);
+
+	QCOMPARE(first.count(), 3);
+	QCOMPARE(QString(first.at(1).primaryText()), QStringLiteral("line 1"));
+	QCOMPARE(first.at(2).hideTime().toMillis(), 2500.);
+
+	// unchanged lines are shared between snapshots
+	const SubtitleSnapshot second = sub->snapshot();
+	QCOMPARE(second.count(), 2);
+	QCOMPARE(QString(second.at(0).primaryText()), QStringLiteral("changed"));
+	QCOMPARE(second.at(1).hideTime().toMillis(), 2800.);
+	QVERIFY(!second.at(0).isSharedWith(first.at(1)));
+	QVERIFY(!second.at(1).isSharedWith(first.at(2)));
+
+	const SubtitleSnapshot third = sub->snapshot();
+	QVERIFY(third.at(0).isSharedWith(second.at(0)));
+	QVERIFY(third.at(1).isSharedWith(second.at(1)));
+}
+
 QTEST_MAIN(SubtitleTest);
@@ -22,6 +22,15 @@ public:
 private slots:
 	void testSort_data();
 	void testSort();
+	void testSortLines();
+	void testInsertLines();
+	void testLineIndexes();
+	void testLinesInRange();
+	void testRetimeLines();
+	void testCompositeSignals();
+	void testLineText();
+	void testLineTextUndo();
+	void testSnapshot();
 
 private:
 	QExplicitlySharedDataPointer<SubtitleComposer::Subtitle> sub;
@@ -0,0 +1,90 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "textwritertest.h"
+#include "formats/textwriter.h"
+
+#include <QBuffer>
+#include <QTest>                               // krazy:exclude=c++/includes
+#include <QTextCodec>
+
+using namespace SubtitleComposer;
+
+void
+TextWriterTest::testString()
+{
+	QString str;
+	{
+		TextWriter out(&str);
+		out << "abc" << QChar::LineFeed << QStringLiteral("def") << '\n' << QLatin1String("x") << 42;
+	}
+	QCOMPARE(str, QStringLiteral("abc\ndef\nx42"));
+}
+
+void
+TextWriterTest::testNumber()
+{
+	QString str;
+	TextWriter out(&str);
+	out.number(5, 2) << ' ';
+	out.number(123, 2) << ' ';
+	out.number(7, 3) << ' ';
+	out.number(0) << ' ';
+	out.number(-42, 4) << ' ';
+	out.number(Q_INT64_C(9876543210));
+	QCOMPARE(str, QStringLiteral("05 123 007 0 -0042 9876543210"));
+}
+
+static QByteArray
+writeText(const QString &text, const char *codecName, TextWriter::LineBreak lineBreak, bool byteOrderMark = false)
+{
+	QBuffer buf;
+	buf.open(QIODevice::WriteOnly);
+	TextWriter out(&buf, QTextCodec::codecForName(codecName), lineBreak, byteOrderMark);
+	out << text;
+	if(!out.flush())
+		return QByteArray();
+	return buf.data();
+}
+
+void
+TextWriterTest::testLineBreaks()
+{
+	const QString text = QStringLiteral("one\ntwo\n\nthree\n");
+	QCOMPARE(writeText(text, "UTF-8", TextWriter::LF), QByteArray("one\ntwo\n\nthree\n"));
+	QCOMPARE(writeText(text, "UTF-8", TextWriter::CRLF), QByteArray("one\r\ntwo\r\n\r\nthree\r\n"));
+	QCOMPARE(writeText(text, "UTF-8", TextWriter::CR), QByteArray("one\rtwo\r\rthree\r"));
+}
+
+void
+TextWriterTest::testByteOrderMark()
+{
+	QCOMPARE(writeText(QStringLiteral("a"), "UTF-8", TextWriter::LF, true), QByteArray("\xef\xbb\xbf" "a"));
+	// codec must not add another BOM in front of ours
+	QCOMPARE(writeText(QStringLiteral("a"), "UTF-16LE", TextWriter::LF, true), QByteArray("\xff\xfe" "a\0", 4));
+	QCOMPARE(writeText(QStringLiteral("a"), "UTF-8", TextWriter::LF, false), QByteArray("a"));
+}
+
+void
+TextWriterTest::testChunks()
+{
+	// output must not depend on where buffer gets flushed
+	QString text;
+	for(int i = 0; i < 50000; i++)
+		text += QStringLiteral("line %1 č\U0001F600\n").arg(i);
+
+	QTextCodec *codec = QTextCodec::codecForName("UTF-8");
+	QBuffer buf;
+	buf.open(QIODevice::WriteOnly);
+	{
+		TextWriter out(&buf, codec, TextWriter::CRLF, false);
+		for(int i = 0; i < text.size(); i += 7)
+			out << text.mid(i, 7);
+	}
+	QCOMPARE(buf.data(), codec->fromUnicode(QString(text).replace(QChar::LineFeed, QLatin1String("\r\n"))));
+}
+
+QTEST_GUILESS_MAIN(TextWriterTest);
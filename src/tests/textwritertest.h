@@ -0,0 +1,24 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef TEXTWRITERTEST_H
+#define TEXTWRITERTEST_H
+
+#include <QObject>
+
+class TextWriterTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void testString();
+	void testNumber();
+	void testLineBreaks();
+	void testByteOrderMark();
+	void testChunks();
+};
+
+#endif
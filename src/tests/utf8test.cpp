@@ -0,0 +1,84 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "utf8test.h"
+#include "helpers/utf8.h"
+
+#include <QTest>                               // krazy:exclude=c++/includes
+
+void
+Utf8Test::testValid_data()
+{
+	QTest::addColumn<QByteArray>("data");
+	QTest::addColumn<bool>("valid");
+	QTest::addColumn<bool>("ascii");
+
+	QTest::newRow("empty") << QByteArray() << true << true;
+	QTest::newRow("ascii") << QByteArray("1\n00:00:01,000 --> 00:00:02,000\nplain ascii text that is longer than a vector\n") << true << true;
+	QTest::newRow("two byte") << QByteArray("\xc4\x8d\xc5\xa1\xc5\xbe") << true << false;
+	QTest::newRow("three byte") << QByteArray("ascii prefix of sixteen+ \xe2\x82\xac") << true << false;
+	QTest::newRow("four byte") << QByteArray("\xf0\x9f\x98\x80") << true << false;
+	QTest::newRow("bom") << QByteArray("\xef\xbb\xbftext") << true << false;
+	QTest::newRow("max") << QByteArray("\xf4\x8f\xbf\xbf") << true << false;
+	QTest::newRow("latin1") << QByteArray("caf\xe9 au lait") << false << false;
+	QTest::newRow("lone continuation") << QByteArray("a\x80") << false << false;
+	QTest::newRow("overlong two byte") << QByteArray("\xc0\xaf") << false << false;
+	QTest::newRow("overlong three byte") << QByteArray("\xe0\x80\xaf") << false << false;
+	QTest::newRow("overlong four byte") << QByteArray("\xf0\x80\x80\xaf") << false << false;
+	QTest::newRow("surrogate") << QByteArray("\xed\xa0\x80") << false << false;
+	QTest::newRow("above max") << QByteArray("\xf4\x90\x80\x80") << false << false;
+	QTest::newRow("truncated") << QByteArray("text \xe2\x82") << false << false;
+	QTest::newRow("bad continuation") << QByteArray("\xe2\x28\xa1") << false << false;
+	QTest::newRow("utf16 bom") << QByteArray("\xff\xfe" "a\0", 4) << false << false;
+}
+
+void
+Utf8Test::testValid()
+{
+	QFETCH(QByteArray, data);
+	QFETCH(bool, valid);
+	QFETCH(bool, ascii);
+
+	bool isAscii = !ascii;
+	QCOMPARE(Utf8::isValid(data.constData(), data.size(), &isAscii), valid);
+	QCOMPARE(isAscii, ascii);
+}
+
+void
+Utf8Test::testDecode()
+{
+	const QString text = QStringLiteral("Line 1: ascii only, long enough for vector path\n"
+		"Line 2: čšž € \U0001F600 中文 end\n");
+	const QByteArray data = text.toUtf8();
+
+	QString out = QStringLiteral("prefix ");
+	QCOMPARE(Utf8::decode(&out, data.constData(), data.size()), data.size());
+	QCOMPARE(out, QStringLiteral("prefix ") + text);
+}
+
+void
+Utf8Test::testDecodeChunks()
+{
+	QString text;
+	for(int i = 0; i < 2000; i++)
+		text += QStringLiteral("%1 text čšž \U0001F600\n").arg(i);
+	const QByteArray data = text.toUtf8();
+
+	// sequences split between chunks must be left for the next call
+	for(int chunkSize : {1, 2, 3, 5, 17, 4096}) {
+		QString out;
+		int off = 0;
+		while(off < data.size()) {
+			const int n = Utf8::decode(&out, data.constData() + off, qMin(chunkSize + 3, data.size() - off));
+			QVERIFY(n > 0);
+			off += n;
+		}
+		QCOMPARE(off, data.size());
+		QCOMPARE(out, text);
+	}
+}
+
+QTEST_GUILESS_MAIN(Utf8Test);
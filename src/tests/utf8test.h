@@ -0,0 +1,23 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef UTF8TEST_H
+#define UTF8TEST_H
+
+#include <QObject>
+
+class Utf8Test : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void testValid_data();
+	void testValid();
+	void testDecode();
+	void testDecodeChunks();
+};
+
+#endif
@@ -0,0 +1,158 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "wavecachetest.h"
+#include "gui/waveform/wavecache.h"
+
+#include "scconfig.h"
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTest>                               // krazy:exclude=c++/includes
+
+using namespace SubtitleComposer;
+
+namespace {
+const quint16 channels = 2;
+// spans more than two pages of PagedArray, last one partially
+const quint32 channelSize = 150000;
+
+quint8
+peakLevelCount()
+{
+	quint8 peakLevels = 0;
+	while(channelSize >> (WaveBuffer::PEAK_BASE_SHIFT + peakLevels))
+		peakLevels++;
+	return peakLevels;
+}
+
+SAMPLE_TYPE
+sample(int seed, quint16 ch, quint32 i)
+{
+	return SAMPLE_TYPE(i * 7 + ch * 13 + seed);
+}
+
+WavePeak
+peak(int seed, quint16 ch, quint8 level, quint32 i)
+{
+	return WavePeak{quint16(i + level + seed), quint16(i * 3 + ch)};
+}
+
+QSharedPointer<WaveData>
+createWaveform(int seed)
+{
+	QSharedPointer<WaveData> data(new WaveData(channels, peakLevelCount()));
+	for(quint16 ch = 0; ch < channels; ch++) {
+		PagedArray<SAMPLE_TYPE> *samples = data->samples[ch] = new PagedArray<SAMPLE_TYPE>(channelSize);
+		samples->reserve(0, channelSize);
+		for(quint32 i = 0; i < channelSize; i++)
+			(*samples)[i] = sample(seed, ch, i);
+	}
+	for(quint8 level = 0; level < data->peakLevels; level++) {
+		const quint32 size = channelSize >> (WaveBuffer::PEAK_BASE_SHIFT + level);
+		for(quint16 ch = 0; ch < channels; ch++) {
+			PagedArray<WavePeak> *peaks = data->peaks[ch * data->peakLevels + level] = new PagedArray<WavePeak>(size);
+			peaks->reserve(0, size);
+			for(quint32 i = 0; i < size; i++)
+				(*peaks)[i] = peak(seed, ch, level, i);
+		}
+	}
+	return data;
+}
+
+bool
+store(const QString &key, const QSharedPointer<WaveData> &data)
+{
+	return WaveCache::store(key, 8000, channelSize / 8000, channelSize, data);
+}
+
+QString
+cachePath(const QString &key)
+{
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/waveform/") + key + QStringLiteral(".wave");
+}
+}
+
+void
+WaveCacheTest::initTestCase()
+{
+	QStandardPaths::setTestModeEnabled(true);
+	QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/waveform")).removeRecursively();
+	// room for one entry only
+	SCConfig::setWfCacheSize(1);
+}
+
+void
+WaveCacheTest::cleanupTestCase()
+{
+	QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/waveform")).removeRecursively();
+}
+
+void
+WaveCacheTest::testStore()
+{
+	const int seed = 1;
+	{
+		// writer keeps data after its owner is gone
+		QSharedPointer<WaveData> data = createWaveform(seed);
+		QVERIFY(store(QStringLiteral("store"), data));
+	}
+	WaveCache::waitForStored();
+
+	WaveCache cache;
+	QVERIFY(cache.open(QStringLiteral("store")));
+	QCOMPARE(cache.channels(), channels);
+	QCOMPARE(cache.channelSize(), channelSize);
+	QCOMPARE(cache.sampleRate(), 8000u);
+	QCOMPARE(cache.duration(), channelSize / 8000);
+
+	const quint8 peakLevels = peakLevelCount();
+	QCOMPARE(cache.peakLevels(), peakLevels);
+
+	for(quint16 ch = 0; ch < channels; ch++) {
+		const SAMPLE_TYPE *samples = cache.samples(ch);
+		for(quint32 i = 0; i < channelSize; i++) {
+			if(samples[i] != sample(seed, ch, i))
+				QFAIL(qPrintable(QStringLiteral("channel %1 sample %2 differs").arg(ch).arg(i)));
+		}
+		for(quint8 level = 0; level < peakLevels; level++) {
+			const WavePeak *peaks = cache.peaks(ch, level);
+			for(quint32 i = 0, n = channelSize >> (WaveBuffer::PEAK_BASE_SHIFT + level); i < n; i++) {
+				const WavePeak expected = peak(seed, ch, level, i);
+				if(peaks[i].mean != expected.mean || peaks[i].peak != expected.peak)
+					QFAIL(qPrintable(QStringLiteral("channel %1 level %2 peak %3 differs").arg(ch).arg(level).arg(i)));
+			}
+		}
+	}
+	cache.close();
+
+	// truncated entry is rejected
+	QFile file(cachePath(QStringLiteral("store")));
+	QVERIFY(file.resize(file.size() - 8));
+	QVERIFY(!cache.open(QStringLiteral("store")));
+}
+
+void
+WaveCacheTest::testEvict()
+{
+	const QSharedPointer<WaveData> data = createWaveform(2);
+	QVERIFY(store(QStringLiteral("old"), data));
+	WaveCache::waitForStored();
+	QVERIFY(QFile::exists(cachePath(QStringLiteral("old"))));
+
+	// newest entry stays, least recently used doesn't fit anymore
+	QTest::qWait(10);
+	QVERIFY(store(QStringLiteral("new"), data));
+	WaveCache::waitForStored();
+	QVERIFY(!QFile::exists(cachePath(QStringLiteral("old"))));
+
+	WaveCache cache;
+	QVERIFY(cache.open(QStringLiteral("new")));
+	QCOMPARE(cache.channelSize(), channelSize);
+}
+
+QTEST_GUILESS_MAIN(WaveCacheTest);
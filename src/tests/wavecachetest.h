@@ -0,0 +1,23 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef WAVECACHETEST_H
+#define WAVECACHETEST_H
+
+#include <QObject>
+
+class WaveCacheTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void initTestCase();
+	void cleanupTestCase();
+	void testStore();
+	void testEvict();
+};
+
+#endif
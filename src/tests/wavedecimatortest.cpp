@@ -0,0 +1,144 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "wavedecimatortest.h"
+#include "gui/waveform/wavedecimator.h"
+
+#include <QTest>                               // krazy:exclude=c++/includes
+
+using namespace SubtitleComposer;
+
+namespace {
+// straightforward decimation of the whole signal in one pass
+QVector<SAMPLE_TYPE>
+decimate(const QVector<SAMPLE_TYPE> &samples, quint8 shift, quint16 channels)
+{
+	const int bucketSize = channels << shift;
+	QVector<SAMPLE_TYPE> res;
+	for(int b = 0; b + bucketSize <= samples.size(); b += bucketSize) {
+		for(int c = 0; c < channels; c++) {
+			SAMPLE_TYPE val = samples[b + c];
+			for(int i = b + c + channels; i < b + bucketSize; i += channels) {
+				if(WaveBuffer::sampleLevel(samples[i]) > WaveBuffer::sampleLevel(val))
+					val = samples[i];
+			}
+			res.append(val);
+		}
+	}
+	return res;
+}
+
+// feeds samples in chunks of repeating sizes
+QVector<SAMPLE_TYPE>
+feed(WaveDecimator *decimator, const QVector<SAMPLE_TYPE> &samples, quint16 channels, const QVector<int> &chunks)
+{
+	QVector<SAMPLE_TYPE> res;
+	int pos = 0;
+	for(int i = 0; pos < samples.size(); i++) {
+		const int len = qMin(qMax(1, chunks[i % chunks.size()]), samples.size() - pos);
+		decimator->feed(samples.constData() + pos, len, [&res, channels](const SAMPLE_TYPE *val) {
+			for(int c = 0; c < channels; c++)
+				res.append(val[c]);
+		});
+		pos += len;
+	}
+	return res;
+}
+}
+
+void
+WaveDecimatorTest::initTestCase()
+{
+	quint32 seed = 1;
+	m_samples.resize(10000);
+	for(SAMPLE_TYPE &sample : m_samples) {
+		seed = seed * 1103515245 + 12345;
+		sample = SAMPLE_TYPE(seed >> 16);
+	}
+	m_samples[5] = SAMPLE_MIN;
+	m_samples[70] = SAMPLE_MAX;
+}
+
+void
+WaveDecimatorTest::testSplit_data()
+{
+	QTest::addColumn<int>("shift");
+	QTest::addColumn<int>("channels");
+
+	QTest::newRow("mono 1:1") << 0 << 1;
+	QTest::newRow("mono 1:8") << 3 << 1;
+	QTest::newRow("stereo 1:1") << 0 << 2;
+	QTest::newRow("stereo 1:16") << 4 << 2;
+	QTest::newRow("5.1 1:32") << 5 << 6;
+}
+
+void
+WaveDecimatorTest::testSplit()
+{
+	QFETCH(int, shift);
+	QFETCH(int, channels);
+
+	const int bucketSize = channels << shift;
+	const QVector<SAMPLE_TYPE> expected = decimate(m_samples, shift, channels);
+	QVERIFY(!expected.isEmpty());
+
+	const QVector<QVector<int>> splits = {
+		{ m_samples.size() },
+		{ 1 },
+		{ 7, 3, 13 },
+		{ bucketSize },
+		{ bucketSize * 3 },
+		{ bucketSize - 1 },
+		{ bucketSize + 1 },
+		{ channels, bucketSize - channels },
+		{ bucketSize / 2 + 1, 1, bucketSize * 2 - 1 },
+	};
+	for(const QVector<int> &chunks : splits) {
+		WaveDecimator decimator(shift, channels);
+		QCOMPARE(decimator.bucketSize(), quint32(bucketSize));
+		QCOMPARE(feed(&decimator, m_samples, channels, chunks), expected);
+	}
+}
+
+void
+WaveDecimatorTest::testPeak()
+{
+	// short transient in the middle of a quiet bucket must survive
+	QVector<SAMPLE_TYPE> samples(64, 10);
+	samples[37] = -20000;
+	samples[38] = 15000;
+	samples[40] = 12;
+
+	WaveDecimator decimator(3, 2);
+	const QVector<SAMPLE_TYPE> res = feed(&decimator, samples, 2, { 5 });
+	QCOMPARE(res.size(), 4 * 2);
+	QCOMPARE(res[0], SAMPLE_TYPE(10));
+	QCOMPARE(res[1], SAMPLE_TYPE(10));
+	QCOMPARE(res[4], SAMPLE_TYPE(15000));
+	QCOMPARE(res[5], SAMPLE_TYPE(-20000));
+	QCOMPARE(res[6], SAMPLE_TYPE(10));
+}
+
+void
+WaveDecimatorTest::testReset()
+{
+	QVector<SAMPLE_TYPE> samples(16, 0);
+	samples[1] = 1000;
+
+	WaveDecimator decimator(2, 2);
+	QVector<SAMPLE_TYPE> res = feed(&decimator, samples.mid(0, 6), 2, { 6 });
+	QVERIFY(res.isEmpty());
+
+	// partial bucket with the peak is dropped
+	decimator.reset();
+	res = feed(&decimator, samples.mid(8), 2, { 8 });
+	QCOMPARE(res, QVector<SAMPLE_TYPE>({ 0, 0 }));
+
+	res = feed(&decimator, samples, 2, { 3 });
+	QCOMPARE(res, QVector<SAMPLE_TYPE>({ 0, 1000, 0, 0 }));
+}
+
+QTEST_GUILESS_MAIN(WaveDecimatorTest)
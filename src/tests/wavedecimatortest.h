@@ -0,0 +1,30 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef WAVEDECIMATORTEST_H
+#define WAVEDECIMATORTEST_H
+
+#include <QObject>
+#include <QVector>
+
+#include "gui/waveform/wavebuffer.h"
+
+class WaveDecimatorTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void initTestCase();
+	void testSplit_data();
+	void testSplit();
+	void testPeak();
+	void testReset();
+
+private:
+	QVector<SAMPLE_TYPE> m_samples;
+};
+
+#endif
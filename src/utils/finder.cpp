@@ -216,13 +216,13 @@ Finder::advance()
 			if(m_dataLine) {
 				if(!m_translationMode || m_targetRadioButtons[Primary]->isChecked()) {
 					m_feedingPrimary = true;
-					m_find->setData(m_dataLine->primaryDoc()->toPlainText());
+					m_find->setData(m_dataLine->primaryText());
 				} else if(m_targetRadioButtons[Secondary]->isChecked()) {
 					m_feedingPrimary = false;
-					m_find->setData(m_dataLine->secondaryDoc()->toPlainText());
+					m_find->setData(m_dataLine->secondaryText());
 				} else {                // m_translationMode && m_targetRadioButtons[SubtitleLine::Both]->isChecked()
 					m_feedingPrimary = !m_feedingPrimary;   // we alternate the source of data
-					m_find->setData((m_feedingPrimary ? m_dataLine->primaryDoc() : m_dataLine->secondaryDoc())->toPlainText());
+					m_find->setData(m_dataLine->text(m_feedingPrimary));
 				}
 
 				connect(m_dataLine, &SubtitleLine::primaryTextChanged, this, &Finder::onLinePrimaryTextChanged);
@@ -277,14 +277,14 @@ void
 Finder::onLinePrimaryTextChanged()
 {
 	if(m_feedingPrimary)
-		m_find->setData(m_dataLine->primaryDoc()->toPlainText());
+		m_find->setData(m_dataLine->primaryText());
 }
 
 void
 Finder::onLineSecondaryTextChanged()
 {
 	if(!m_feedingPrimary)
-		m_find->setData(m_dataLine->secondaryDoc()->toPlainText());
+		m_find->setData(m_dataLine->secondaryText());
 }
 
 void
@@ -179,13 +179,13 @@ Replacer::onFindNext()
 			if(dataLine) {
 				if(!m_translationMode || m_targetRadioButtons[Primary]->isChecked()) {
 					m_feedingPrimary = true;
-					m_replace->setData(dataLine->primaryDoc()->toPlainText());
+					m_replace->setData(dataLine->primaryText());
 				} else if(m_targetRadioButtons[Secondary]->isChecked()) {
 					m_feedingPrimary = false;
-					m_replace->setData(dataLine->secondaryDoc()->toPlainText());
+					m_replace->setData(dataLine->secondaryText());
 				} else { // m_translationMode && m_targetRadioButtons[SubtitleLine::Both]->isChecked()
 					m_feedingPrimary = !m_feedingPrimary;   // alternate the data source
-					m_replace->setData((m_feedingPrimary ? dataLine->primaryDoc() : dataLine->secondaryDoc())->toPlainText());
+					m_replace->setData(dataLine->text(m_feedingPrimary));
 				}
 			}
 		}
@@ -80,7 +80,7 @@ void
 Speller::updateBuffer()
 {
 	if(m_iterator)
-		m_sonnetDialog->setBuffer((m_useTranslation ? m_iterator->current()->secondaryDoc() : m_iterator->current()->primaryDoc())->toPlainText());
+		m_sonnetDialog->setBuffer(m_iterator->current()->text(!m_useTranslation));
 }
 
 void
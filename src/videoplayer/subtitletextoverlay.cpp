@@ -221,9 +221,11 @@ SubtitleTextOverlay::setDoc(const RichDocument *doc)
 	if(m_doc) {
 		disconnect(m_doc, nullptr, this, nullptr);
 		disconnect(m_doc->stylesheet(), nullptr, this, nullptr);
+		m_doc->detachView();
 	}
 	m_doc = doc;
 	if(m_doc) {
+		m_doc->attachView();
 		connect(m_doc, &RichDocument::contentsChanged, this, &SubtitleTextOverlay::setDirty);
 		connect(m_doc->stylesheet(), &RichCSS::changed, this, &SubtitleTextOverlay::setDirty);
 	}
@@ -99,13 +99,7 @@ allClasses(RichDocument *doc)
 	QSet<QString> vs = doc->stylesheet()->classes();
 	const Subtitle *s = appSubtitle();
 	for(int i = 0, n = s->count(); i < n; i++) {
-		const RichDocument *d = s->line(i)->primaryDoc();
-		const QVector<QTextFormat> vf = d->allFormats();
-		for(const QTextFormat &f: vf) {
-			if(!f.hasProperty(RichDocument::Class))
-				continue;
-			vs.unite(f.property(RichDocument::Class).value<QSet<QString>>());
-		}
+		vs.unite(s->line(i)->primaryText().cummulativeClasses());
 	}
 	return vs.values();
 }
@@ -139,13 +133,7 @@ allVoices()
 	QSet<QString> vs;
 	const Subtitle *s = appSubtitle();
 	for(int i = 0, n = s->count(); i < n; i++) {
-		const RichDocument *d = s->line(i)->primaryDoc();
-		const QVector<QTextFormat> vf = d->allFormats();
-		for(const QTextFormat &f: vf) {
-			if(!f.hasProperty(RichDocument::Voice))
-				continue;
-			vs.insert(f.property(RichDocument::Voice).toString());
-		}
+		vs.unite(s->line(i)->primaryText().cummulativeVoices());
 	}
 	return vs.values();
 }